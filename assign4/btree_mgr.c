@@ -286,8 +286,8 @@ int InsertAtArr(dynamicArr *dynamicArray, int element, int insertIndex) {
         return -1; // No more space
     }
 
-    // Using memcpy function to shift elements
-    memcpy(&(dynamicArray->elements[insertIndex + 1]), &(dynamicArray->elements[insertIndex]), (dynamicArray->fill - insertIndex) * sizeof(int));
+    // Shift the elements up by one, the ranges overlap
+    memmove(&(dynamicArray->elements[insertIndex + 1]), &(dynamicArray->elements[insertIndex]), (dynamicArray->fill - insertIndex) * sizeof(int));
 
     // Insert the new element
     dynamicArray->elements[insertIndex] = element;
@@ -1014,6 +1014,10 @@ RC propogateParentNode(BTreeHandle *tree, BT_Node *left, BT_Node *right, int key
     y++;
     memcpy(rightParent->childNode, overflowed->childNode + parent->childPages->fill,
            sizeof(BT_Node *) * rightParent->childPages->fill);
+    // the moved children have to propagate their own splits into rightParent
+    for (int c = 0; c < rightParent->childPages->fill; c++) {
+      rightParent->childNode[c]->parent = rightParent;
+    }
 
     destroyBTNode(overflowed);
      if(y==NULL){
@@ -1521,24 +1525,25 @@ int y=x+1;
   key: Pointer to the value to be deleted.
   Returns:
   RC_OK if the key is successfully deleted.
+  RC_IM_KEY_NOT_FOUND if the tree does not have the key.
   Notes:
   The function locates the node containing the key to be deleted.
-  If the key is not found, the function returns without making any changes.
+  If the key is not found, the function returns RC_IM_KEY_NOT_FOUND without making any changes.
   If the key is found, it is removed from the node's value array, along with associated leaf page and slot information.
   The B-tree header and the node containing the modified data are updated.
 */
 RC deleteKey(BTreeHandle *tree, Value *key) {
     BT_Node *targetNode = findNodeByKey(tree, key->v.intV);
     int target = 0;
+    // an empty tree has no node for the key
     if (!targetNode) {
-        return RC_OK;
+        return RC_IM_KEY_NOT_FOUND;
     }
     
     int i = dynamicArrSearch(targetNode->value, key->v.intV, &target);
-    i = (i >= 0) ? i : 0; // Ternary operator to handle negative index
-    
+    // a missing key leaves the leaf alone
     if (i < 0) {
-        return RC_OK;
+        return RC_IM_KEY_NOT_FOUND;
     }
 
     int *pagesPtr = &(targetNode->leafRIDPages->elements[i]);
@@ -1555,6 +1560,9 @@ RC deleteKey(BTreeHandle *tree, Value *key) {
     }
 
     targetNode->value->fill--;
+    // the RID arrays shrink with the keys, inserts and scans rely on equal fills
+    targetNode->leafRIDPages->fill--;
+    targetNode->leafRIDSlots->fill--;
     tree->numEntries--;
     writeBtreeHeader(tree);
     writeNode(targetNode, tree);
@@ -1574,7 +1582,8 @@ RC openTreeScan(BTreeHandle *tree, BT_ScanHandle **handle) {
     ScanMgmtInfo *scanMgmtInfo = (ScanMgmtInfo *)malloc(sizeof(ScanMgmtInfo));
     BT_ScanHandle *btScanHandle = (BT_ScanHandle *)malloc(sizeof(BT_ScanHandle));
     scanMgmtInfo->currentNode = tree->root;
-    for (int i = 0; !scanMgmtInfo->currentNode->isLeaf; i++) {
+    // an empty tree has no root, nextEntry then ends the scan right away
+    for (int i = 0; scanMgmtInfo->currentNode != NULL && !scanMgmtInfo->currentNode->isLeaf; i++) {
         scanMgmtInfo->currentNode = scanMgmtInfo->currentNode->childNode[0];
     }
     btScanHandle->tree = tree;
@@ -1597,20 +1606,17 @@ RC openTreeScan(BTreeHandle *tree, BT_ScanHandle **handle) {
 RC nextEntry (BT_ScanHandle *handle, RID *result){
   ScanMgmtInfo *scanMgmtInfo;
   scanMgmtInfo = handle->mgmtData;
-  if((*scanMgmtInfo).elementIndex >= (*scanMgmtInfo).currentNode->leafRIDPages->fill) { // finding the left most leaf
-    if((*scanMgmtInfo).elementIndex != (*scanMgmtInfo).currentNode->value->fill){
-      (*scanMgmtInfo).currentNode = (*scanMgmtInfo).currentNode->right;
-      (*scanMgmtInfo).elementIndex = 0;
-    } else {
-      if((*scanMgmtInfo).currentNode->right!=NULL) {
-        (*scanMgmtInfo).currentNode = (*scanMgmtInfo).currentNode->right;
-        (*scanMgmtInfo).elementIndex = 0;
-      }
-      else {
-        return RC_IM_NO_MORE_ENTRIES;
-      }
-      
+  // scan of an empty tree
+  if((*scanMgmtInfo).currentNode == NULL) {
+    return RC_IM_NO_MORE_ENTRIES;
+  }
+  // move on to the next leaf with entries, deletes can empty a leaf
+  while((*scanMgmtInfo).elementIndex >= (*scanMgmtInfo).currentNode->leafRIDPages->fill) {
+    if((*scanMgmtInfo).currentNode->right==NULL) {
+      return RC_IM_NO_MORE_ENTRIES;
     }
+    (*scanMgmtInfo).currentNode = (*scanMgmtInfo).currentNode->right;
+    (*scanMgmtInfo).elementIndex = 0;
   }
   (*result).slot = (*scanMgmtInfo).currentNode->leafRIDSlots->elements[(*scanMgmtInfo).elementIndex];
   (*result).page = (*scanMgmtInfo).currentNode->leafRIDPages->elements[(*scanMgmtInfo).elementIndex];
@@ -1619,4 +1625,49 @@ RC nextEntry (BT_ScanHandle *handle, RID *result){
   return RC_OK;
 }
 
+/*
+  Description: Opens a B-tree scan positioned on the first entry whose key is not smaller than the given one.
+  Parameters:
+  tree - The B-tree handle.
+  key - The key to start from.
+  handle - Receives the scan handle.
+  Returns:
+  RC_OK if the scan is opened; nextEntry returns RC_IM_NO_MORE_ENTRIES right away if no key is large enough.
+*/
+RC openTreeScanFrom(BTreeHandle *tree, Value *key, BT_ScanHandle **handle) {
+    ScanMgmtInfo *scanMgmtInfo = (ScanMgmtInfo *)malloc(sizeof(ScanMgmtInfo));
+    BT_ScanHandle *btScanHandle = (BT_ScanHandle *)malloc(sizeof(BT_ScanHandle));
+    if (scanMgmtInfo == NULL || btScanHandle == NULL) {
+        free(scanMgmtInfo);
+        free(btScanHandle);
+        return RC_MEM_ALLOC_FAILED;
+    }
+    // nextEntry moves on to the right sibling when the position is past the last key of the leaf
+    scanMgmtInfo->currentNode = findNodeByKey(tree, key->v.intV);
+    scanMgmtInfo->elementIndex = 0;
+    if (scanMgmtInfo->currentNode != NULL) {
+        dynamicArrSearch(scanMgmtInfo->currentNode->value, key->v.intV, &scanMgmtInfo->elementIndex);
+    }
+    btScanHandle->tree = tree;
+    btScanHandle->mgmtData = scanMgmtInfo;
+    *handle = btScanHandle;
+    return RC_OK;
+}
 
+/*
+  Description: Retrieves the key of the entry the last call of nextEntry returned.
+  Parameters:
+  handle - The scan handle.
+  key - Receives the key.
+  Returns:
+  RC_OK if successful, RC_IM_NO_MORE_ENTRIES before the first entry.
+*/
+RC getScanKey(BT_ScanHandle *handle, Value *key) {
+    ScanMgmtInfo *scanMgmtInfo = handle->mgmtData;
+    if (scanMgmtInfo->currentNode == NULL || scanMgmtInfo->elementIndex == 0) {
+        return RC_IM_NO_MORE_ENTRIES;
+    }
+    key->dt = handle->tree->keyType;
+    key->v.intV = scanMgmtInfo->currentNode->value->elements[scanMgmtInfo->elementIndex - 1];
+    return RC_OK;
+}
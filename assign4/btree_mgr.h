@@ -100,6 +100,8 @@ extern RC insertKey (BTreeHandle *tree, Value *key, RID rid);
 extern RC deleteKey (BTreeHandle *tree, Value *key);
 extern RC openTreeScan (BTreeHandle *tree, BT_ScanHandle **handle);
 extern RC nextEntry (BT_ScanHandle *handle, RID *result);
+extern RC openTreeScanFrom (BTreeHandle *tree, Value *key, BT_ScanHandle **handle);
+extern RC getScanKey (BT_ScanHandle *handle, Value *key);
 extern RC closeTreeScan (BT_ScanHandle *handle);
 
 // debug and test functions
@@ -1,390 +1,837 @@
 #include<stdio.h>
 #include<stdlib.h>
+#include<string.h>
 #include "buffer_mgr.h"
 #include "storage_mgr.h"
 #include <math.h>
+#include <limits.h>
 #include "const.h"
 
-// "bufferSize" represents the size of the buffer pool i.e. maximum number of page frames that can be kept into the buffer pool
-int bufferSize = 0;
 
-// "rearIndex" basically stores the count of number of pages read from the disk.
-// "rearIndex" is also used by FIFO function to calculate the frontIndex i.e.
-int rearIndex = 0;
+/*
+ * Function: FIFO hooks
+ * --------------------
+ * Implements the First-In-First-Out (FIFO) page replacement strategy.
+ * hitNum of a frame is stamped with the pool clock when its page is read from
+ * disk and never touched on hits, so the unpinned frame with the smallest
+ * stamp holds the page that entered the pool first.
+ */
+void fifoOnLoad(BM_BufferPool *const bm, int frame)
+{
+	bm->mgmtData->hitNums[frame] = ++bm->tick;
+}
 
-// "writeCount" counts the number of I/O write to the disk i.e. number of pages writen to the disk
-int writeCount = 0;
+int oldestStampVictim(BM_BufferPool *const bm)
+{
+	int *hitNums = bm->mgmtData->hitNums;
+	int victim = -1;
+	// Find the oldest page frame with fixCount = 0
+	for (int i = nextEvictableFrame(bm, 0, false); i >= 0; i = nextEvictableFrame(bm, i + 1, false)) {
+		if (victim < 0 || hitNums[i] < hitNums[victim]) {
+			victim = i;
+		}
+	}
+	return victim;
+}
 
-// "hit" a general count which is incremented whenever a page frame is added into the buffer pool.
-// "hit" is used by LRU to determine least recently added page into the buffer pool.
-int hit = 0;
+BM_ReplacementPolicy fifoPolicy = { NULL, fifoOnLoad, oldestStampVictim, NULL, NULL, NULL };
 
-// "clockPointer" is used by CLOCK algorithm to point to the last added page in the buffer pool.
-int clockPointer = 0;
 
-// "lfuPointer" is used by LFU algorithm to store the least frequently used page frame's position. It speeds up operation  from 2nd replacement onwards.
-int lfuPointer = 0;
+/*
+ * Function: LRU hooks
+ * -------------------
+ * Implements the Least Recently Used (LRU) page replacement strategy.
+ * hitNum is stamped with the pool clock on every load and every hit, the
+ * unpinned frame with the smallest stamp is the least recently used one.
+ * RS_LRU_K is served by the same hooks.
+ */
+void lruOnAccess(BM_BufferPool *const bm, int frame)
+{
+	bm->mgmtData->hitNums[frame] = ++bm->tick;
+}
+
+BM_ReplacementPolicy lruPolicy = { lruOnAccess, lruOnAccess, oldestStampVictim, NULL, NULL, NULL };
 
 
 /*
-	- description : Creates and initializes a buffer pool with page frames (numPages).
-	- param :
-		1. b_mgr - pointer to the buffer pool
-		2. pageFN -  stores the no of page files which are cached in memory.
-		3. numPages - no. of the page frames
-		4. strategy -  the page replacement strategy (FIFO, LRU, LFU, CLOCK)
-		5. stratData -  parameters to the page replacement strategy
-	- return : RC code
-*/
-extern RC initBufferPool(BM_BufferPool *const b_mgr, const char *const pageFN, 
-		  const int numPages, ReplacementStrategy strategy, 
-		  void *stratData)
+ * Function: CLOCK hooks
+ * ---------------------
+ * Implements the CLOCK page replacement strategy.
+ * refBits holds the reference bit of each frame. The clock hand sweeps the circular
+ * buffer clearing reference bits and stops at the first unpinned frame whose
+ * bit is already clear.
+ */
+void clockOnAccess(BM_BufferPool *const bm, int frame)
 {
-	b_mgr->pageFile = (char *)pageFN;
-	b_mgr->numPages = numPages;
-	b_mgr->strategy = strategy;
-	
-	// Allocate memory for page frames
-	PageFrame *mypage = malloc(sizeof(PageFrame) * numPages);
-
-	bufferSize = numPages;	
-	int k = bufferSize;
-
-	// Initialize each page frame with default values
-	while(k > 0)
-	{
-		k--;
-		mypage[k].refNum = 0;
-		mypage[k].dirtyBit = 0;
-		mypage[k].data = NULL;
-		mypage[k].hitNum = 0;	
-		mypage[k].pageNum = -1;
-		mypage[k].fixCount = 0;
-	}
-	// Set the management data of the buffer pool to the allocated page frames
-	b_mgr->mgmtData = mypage;
-	// Initialize variables related to the replacement strategy
-	lfuPointer = writeCount = clockPointer = 0;
-	// Return success code
-	return RC_OK;		
+	BM_SET_BIT(bm->mgmtData->refBits, frame);
 }
 
+int clockChooseVictim(BM_BufferPool *const bm)
+{
+	BM_FrameTable *frames = bm->mgmtData;
+	// Two full sweeps are enough: the first one clears every reference bit
+	for (int i = 0; i < 2 * bm->numPages; i++) {
+		int frame = bm->hand;
+		bm->hand = (bm->hand + 1) % bm->numPages;
+		if (BM_TEST_BIT(frames->pinnedBits, frame)) {
+			continue;
+		}
+		if (BM_TEST_BIT(frames->refBits, frame)) {
+			// Give the page a second chance
+			BM_CLEAR_BIT(frames->refBits, frame);
+			continue;
+		}
+		return frame;
+	}
+	return -1;
+}
+
+BM_ReplacementPolicy clockPolicy = { clockOnAccess, clockOnAccess, clockChooseVictim, NULL, NULL, NULL };
+
 
 /*
- * Function: FIFO
- * --------------
- * Implements the First-In-First-Out (FIFO) page replacement strategy.
- * Finds the next available page frame using the circular buffer and
- * replaces its content with the incoming page. If the replaced page
- * is dirty, persists it before the replacement.
+ * Function: LFU hooks
+ * -------------------
+ * Implements the Least Frequently Used (LFU) page replacement strategy.
+ * refNum counts the hits of the resident page. The search starts behind the
+ * previous victim so ties rotate through the pool instead of always hitting
+ * the first frame.
+ */
+void lfuOnLoad(BM_BufferPool *const bm, int frame)
+{
+	bm->mgmtData->refNums[frame] = 0;
+}
+
+void lfuOnHit(BM_BufferPool *const bm, int frame)
+{
+	bm->mgmtData->refNums[frame]++;
+}
+
+int lfuChooseVictim(BM_BufferPool *const bm)
+{
+	int *refNums = bm->mgmtData->refNums;
+	int victim = -1;
+	// Walk the unpinned frames from the LFU pointer to the end, then wrap around
+	for (int pass = 0; pass < 2; pass++) {
+		int from = pass == 0 ? bm->hand : 0;
+		int to = pass == 0 ? bm->numPages : bm->hand;
+		for (int i = nextEvictableFrame(bm, from, false); i >= 0 && i < to; i = nextEvictableFrame(bm, i + 1, false)) {
+			if (victim < 0 || refNums[i] < refNums[victim]) {
+				victim = i;
+			}
+		}
+	}
+	// Update the LFU pointer
+	if (victim >= 0) {
+		bm->hand = (victim + 1) % bm->numPages;
+	}
+	return victim;
+}
+
+BM_ReplacementPolicy lfuPolicy = { lfuOnHit, lfuOnLoad, lfuChooseVictim, NULL, NULL, NULL };
+
+
+/*
+ * Function: shadowAccess
+ * ----------------------
+ * Replays one page access against a shadow cache. Shadow caches only keep page
+ * numbers, so a "load" is free; they do not model pins.
  *
  * Parameters:
- * - bm: A pointer to the buffer pool structure.
- * - page: A pointer to the page frame to be inserted/replaced in the buffer pool.
+ * - shadow: The shadow cache simulating one strategy.
+ * - pageNum: The page being accessed.
  */
-void FIFO(BM_BufferPool *const bm, PageFrame *page)
-{
-    PageFrame *pageFrame = (PageFrame *) bm->mgmtData;
-	// Find the front index of the circular buffer
-    int frontIndex = rearIndex % bufferSize;
-    // Move to the next available page frame with fixCount = 0
-    while (pageFrame[frontIndex].fixCount > 0)
-    {
-        frontIndex = (frontIndex + 1) % bufferSize;
-    }
-	// If the page being replaced is dirty, persist it before replacement
-    if (pageFrame[frontIndex].dirtyBit == 1) {
-    	persistPage(bm, &pageFrame[frontIndex]);
+void shadowAccess(BM_ShadowCache *shadow, PageNumber pageNum)
+{
+	int frame = -1;
+	int i;
+	shadow->tick++;
+	for (i = 0; i < shadow->numFrames; i++) {
+		if (shadow->pageNums[i] == pageNum) {
+			frame = i;
+			break;
+		}
 	}
-	// Update the page frame with the incoming page
-	updatePageFrame(&pageFrame[frontIndex], page);
-    // Replace the content of the selected page frame with the incoming page
-    pageFrame[frontIndex] = *page;
+	if (frame >= 0) {
+		shadow->hits++;
+		if (shadow->strategy == RS_LRU) {
+			shadow->stamps[frame] = shadow->tick;
+		}
+		shadow->counts[frame]++;
+		shadow->refBits[frame] = 1;
+		return;
+	}
+
+	// Miss: use an empty slot or pick a victim the way the strategy would
+	for (i = 0; i < shadow->numFrames && frame < 0; i++) {
+		if (shadow->pageNums[i] == NO_PAGE) {
+			frame = i;
+		}
+	}
+	if (frame < 0) {
+		switch (shadow->strategy) {
+			case RS_CLOCK:
+				while (shadow->refBits[shadow->hand]) {
+					shadow->refBits[shadow->hand] = 0;
+					shadow->hand = (shadow->hand + 1) % shadow->numFrames;
+				}
+				frame = shadow->hand;
+				shadow->hand = (shadow->hand + 1) % shadow->numFrames;
+				break;
+			case RS_LFU:
+				// Ties go to the first frame from the hand, as in lfuChooseVictim
+				frame = shadow->hand;
+				for (i = 1; i < shadow->numFrames; i++) {
+					int k = (shadow->hand + i) % shadow->numFrames;
+					if (shadow->counts[k] < shadow->counts[frame]) {
+						frame = k;
+					}
+				}
+				shadow->hand = (frame + 1) % shadow->numFrames;
+				break;
+			default:
+				// FIFO and LRU both evict the smallest stamp
+				frame = 0;
+				for (i = 1; i < shadow->numFrames; i++) {
+					if (shadow->stamps[i] < shadow->stamps[frame]) {
+						frame = i;
+					}
+				}
+				break;
+		}
+	}
+	shadow->pageNums[frame] = pageNum;
+	shadow->stamps[frame] = shadow->tick;
+	shadow->counts[frame] = 0;
+	shadow->refBits[frame] = 1;
 }
 
 
 /*
- * Function: updatePageFrame
+ * Function: builtinPolicy
+ * -----------------------
+ * Maps a built-in strategy to its hook table.
+ */
+BM_ReplacementPolicy *builtinPolicy(ReplacementStrategy strategy)
+{
+	switch (strategy) {
+		case RS_FIFO:
+			return &fifoPolicy;
+		case RS_LRU:
+		case RS_LRU_K:
+			return &lruPolicy;
+		case RS_CLOCK:
+			return &clockPolicy;
+		case RS_LFU:
+			return &lfuPolicy;
+		default:
+			return NULL;
+	}
+}
+
+
+/*
+ * Function: adaptiveObserve
  * -------------------------
- * Updates the content of a destination page frame with the data from a source page frame.
+ * Feeds a sampled access to every shadow cache. At the end of each window the
+ * live strategy is switched to the shadow with the most hits, the current one
+ * winning ties so the pool does not flap between equally good strategies.
  *
  * Parameters:
- * - destination: A pointer to the destination page frame to be updated.
- * - source: A pointer to the source page frame containing the data to be copied.
+ * - state: The adaptive state of the pool.
+ * - pageNum: The page being accessed.
  */
-void updatePageFrame(PageFrame *destination, const PageFrame *source) {
-    // Copy the content of the source page frame to the destination page frame
-	*destination = *source;
+void adaptiveObserve(BM_AdaptiveState *state, PageNumber pageNum)
+{
+	if ((((unsigned)pageNum * 2654435761u) >> 16) % state->sampleRate != 0) {
+		return;
+	}
+	for (int i = 0; i < ADAPTIVE_NUM_SHADOWS; i++) {
+		shadowAccess(&state->shadows[i], pageNum);
+	}
+	if (++state->windowAccesses < ADAPTIVE_WINDOW) {
+		return;
+	}
+
+	BM_ShadowCache *best = NULL;
+	for (int i = 0; i < ADAPTIVE_NUM_SHADOWS; i++) {
+		if (state->shadows[i].strategy == state->live) {
+			best = &state->shadows[i];
+		}
+	}
+	for (int i = 0; i < ADAPTIVE_NUM_SHADOWS; i++) {
+		if (best == NULL || state->shadows[i].hits > best->hits) {
+			best = &state->shadows[i];
+		}
+	}
+	state->live = best->strategy;
+	// Only reset once every shadow was compared against the winner
+	for (int i = 0; i < ADAPTIVE_NUM_SHADOWS; i++) {
+		state->shadows[i].hits = 0;
+	}
+	state->windowAccesses = 0;
 }
 
 
 /*
- * Function: persistPage
+ * Function: RS_ADAPTIVE hooks
+ * ---------------------------
+ * The real pool keeps the CLOCK reference bits and LFU counts up to date no
+ * matter which strategy is live, and stamps hitNum on hits unless FIFO is live,
+ * so switching strategies starts from meaningful bookkeeping. Victim selection
+ * is delegated to the live strategy.
+ */
+void adaptiveOnHit(BM_BufferPool *const bm, int frame)
+{
+	BM_AdaptiveState *state = bm->policy->data;
+	BM_SET_BIT(bm->mgmtData->refBits, frame);
+	bm->mgmtData->refNums[frame]++;
+	if (state->live != RS_FIFO) {
+		bm->mgmtData->hitNums[frame] = ++bm->tick;
+	}
+	adaptiveObserve(state, bm->mgmtData->pageNums[frame]);
+}
+
+void adaptiveOnLoad(BM_BufferPool *const bm, int frame)
+{
+	BM_AdaptiveState *state = bm->policy->data;
+	BM_SET_BIT(bm->mgmtData->refBits, frame);
+	bm->mgmtData->refNums[frame] = 0;
+	bm->mgmtData->hitNums[frame] = ++bm->tick;
+	adaptiveObserve(state, bm->mgmtData->pageNums[frame]);
+}
+
+int adaptiveChooseVictim(BM_BufferPool *const bm)
+{
+	BM_AdaptiveState *state = bm->policy->data;
+	return builtinPolicy(state->live)->chooseVictim(bm);
+}
+
+
+/*
+ * Function: sizeShadows
  * ---------------------
- * Persists the content of a dirty page frame to the page file.
+ * Sizes the shadow caches for a pool of numPages frames and empties them. A
+ * pool larger than ADAPTIVE_SHADOW_FRAMES is simulated on a sample of its
+ * pages with proportionally smaller shadow caches. The current window starts
+ * over, since its hits were counted for the old size.
+ */
+void sizeShadows(BM_AdaptiveState *state, int numPages)
+{
+	ReplacementStrategy candidates[ADAPTIVE_NUM_SHADOWS] = { RS_FIFO, RS_LRU, RS_CLOCK, RS_LFU };
+
+	state->sampleRate = (numPages + ADAPTIVE_SHADOW_FRAMES - 1) / ADAPTIVE_SHADOW_FRAMES;
+	if (state->sampleRate < 1) {
+		state->sampleRate = 1;
+	}
+	state->windowAccesses = 0;
+	for (int i = 0; i < ADAPTIVE_NUM_SHADOWS; i++) {
+		BM_ShadowCache *shadow = &state->shadows[i];
+		shadow->strategy = candidates[i];
+		shadow->numFrames = numPages / state->sampleRate;
+		if (shadow->numFrames < 1) {
+			shadow->numFrames = 1;
+		}
+		shadow->pageNums = malloc(sizeof(PageNumber) * shadow->numFrames);
+		shadow->stamps = calloc(shadow->numFrames, sizeof(int));
+		shadow->counts = calloc(shadow->numFrames, sizeof(int));
+		shadow->refBits = calloc(shadow->numFrames, sizeof(char));
+		for (int k = 0; k < shadow->numFrames; k++) {
+			shadow->pageNums[k] = NO_PAGE;
+		}
+		shadow->hand = shadow->tick = shadow->hits = 0;
+	}
+}
+
+void freeShadows(BM_AdaptiveState *state)
+{
+	for (int i = 0; i < ADAPTIVE_NUM_SHADOWS; i++) {
+		free(state->shadows[i].pageNums);
+		free(state->shadows[i].stamps);
+		free(state->shadows[i].counts);
+		free(state->shadows[i].refBits);
+	}
+}
+
+
+/*
+ * Function: createAdaptivePolicy
+ * ------------------------------
+ * Allocates the per pool hook table and shadow caches of an RS_ADAPTIVE pool.
+ * LRU is live initially.
  *
  * Parameters:
- * - bm: A pointer to the buffer pool structure.
- * - pageFrame: A pointer to the page frame containing the data to be persisted.
+ * - numPages: The number of frames of the pool.
+ *
+ * Returns:
+ * - The policy, to be released with destroyAdaptivePolicy.
  */
-void persistPage(BM_BufferPool *const bm, PageFrame *pageFrame) {
-    SM_FileHandle fh;
-	// Open the page file associated with the buffer pool
-    openPageFile(bm->pageFile, &fh);
-	// Write the data of the dirty page frame to the page file
-    writeBlock(pageFrame->pageNum, &fh, pageFrame->data);
-	// Increment the global write count
-    writeCount++;
+BM_ReplacementPolicy *createAdaptivePolicy(int numPages)
+{
+	BM_ReplacementPolicy *policy = malloc(sizeof(BM_ReplacementPolicy));
+	BM_AdaptiveState *state = malloc(sizeof(BM_AdaptiveState));
+
+	sizeShadows(state, numPages);
+	state->live = RS_LRU;
+
+	policy->onHit = adaptiveOnHit;
+	policy->onLoad = adaptiveOnLoad;
+	policy->chooseVictim = adaptiveChooseVictim;
+	policy->onEvict = NULL;
+	policy->onUnpin = NULL;
+	policy->data = state;
+	return policy;
 }
 
 
+/*
+ * Function: resizeAdaptivePolicy
+ * ------------------------------
+ * Rebuilds the shadow caches after the pool was resized to numPages frames,
+ * so they keep simulating a pool of the real size. The live strategy stays
+ * until the next window elects one.
+ */
+void resizeAdaptivePolicy(BM_ReplacementPolicy *policy, int numPages)
+{
+	BM_AdaptiveState *state = policy->data;
+	freeShadows(state);
+	sizeShadows(state, numPages);
+}
+
+void destroyAdaptivePolicy(BM_ReplacementPolicy *policy)
+{
+	freeShadows(policy->data);
+	free(policy->data);
+	free(policy);
+}
+
 
 /*
- * Function: LFU
- * ------------
- * Implements the Least Frequently Used (LFU) page replacement strategy.
- * Finds the page frame with the least reference count for replacement,
- * persisting it if necessary. Updates the chosen page frame with the
- * content of the incoming page.
+ * Function: getLiveStrategy
+ * -------------------------
+ * Returns the strategy currently choosing victims, which for an RS_ADAPTIVE
+ * pool is the one its shadow caches elected last.
+ */
+ReplacementStrategy getLiveStrategy(BM_BufferPool *const bm)
+{
+	if (bm->strategy == RS_ADAPTIVE) {
+		return ((BM_AdaptiveState *)bm->policy->data)->live;
+	}
+	return bm->strategy;
+}
+
+
+/*
+ * Memory governor state. Every initialized pool is linked into registeredPools
+ * through nextPool; memoryBudget is 0 while the frames are not capped.
+ */
+static BM_BufferPool *registeredPools = NULL;
+static int memoryBudget = 0;
+static int governorMisses = 0;
+
+
+/*
+ * Function: getBufferMemoryUsage
+ * ------------------------------
+ * Returns the number of frames held by all initialized buffer pools.
+ */
+int getBufferMemoryUsage(void)
+{
+	int used = 0;
+	for (BM_BufferPool *pool = registeredPools; pool != NULL; pool = pool->nextPool) {
+		used += pool->numPages;
+	}
+	return used;
+}
+
+
+/*
+ * Function: rememberGhost
+ * -----------------------
+ * Records a page leaving the pool. A later miss on it means a few more frames
+ * would have turned that miss into a hit.
+ */
+void rememberGhost(BM_BufferPool *const bm, PageNumber pageNum)
+{
+	bm->ghosts[bm->ghostHand] = pageNum;
+	bm->ghostHand = (bm->ghostHand + 1) % GOVERNOR_STEP;
+}
+
+
+/*
+ * Function: resizeBits
+ * --------------------
+ * Resizes a frame bitset, clearing the words added for new frames.
+ */
+uint64_t *resizeBits(uint64_t *bits, int oldPages, int newPages)
+{
+	int oldWords = BM_BIT_WORDS(oldPages);
+	int newWords = BM_BIT_WORDS(newPages);
+	bits = realloc(bits, sizeof(uint64_t) * newWords);
+	for (int w = oldWords; w < newWords; w++) {
+		bits[w] = 0;
+	}
+	return bits;
+}
+
+
+/*
+ * Function: resizeBufferPool
+ * --------------------------
+ * Grows or shrinks the pool to numPages frames. Shrinking gives up frames from
+ * the top, writing dirty pages back first, and stops at the first pinned frame.
  *
  * Parameters:
- * - b_mgr: A pointer to the buffer pool structure.
- * - page: A pointer to the page frame to be inserted/replaced in the buffer pool.
+ * - bm: A pointer to the buffer pool structure.
+ * - numPages: The new number of frames.
+ *
+ * Returns:
+ * - RC_OK: If the pool has numPages frames now.
+ * - RC_MEMORY_BUDGET_EXCEEDED: If growing would exceed the memory budget.
+ * - RC_PINNED_PAGES_IN_BUFFER: If a pinned frame kept the pool larger.
  */
-void LFU(BM_BufferPool *const b_mgr, PageFrame *page)
+RC resizeBufferPool(BM_BufferPool *const bm, int numPages)
 {
-	// Check if the buffer pool is NULL
-	if (b_mgr == NULL) {
-        
-        return ;
-    }
-	PageFrame *pageFrame = (PageFrame *) b_mgr->mgmtData;
-	
-	// Initialize variables for LFU replacement
-	int leastFreqRef;
-	// Return if the incoming page is NULL
-	if(page == NULL){
-		  return ; 
-	}
-	int leastFreqIndex = 0;
-	leastFreqIndex = lfuPointer;	
-	int i = 0;
-	int j = 0;
-    leastFreqRef = pageFrame[0].refNum;
-	// Find the least frequently used page frame with fixCount = 0
-	for(i=0;i<bufferSize;i++) {
-		if (pageFrame[leastFreqIndex].fixCount == 0) {
-			int x=leastFreqIndex+i;
-			leastFreqIndex = x % bufferSize;
-			leastFreqRef = pageFrame[leastFreqIndex].refNum;
-			break;
-		}
+	if (bm->mgmtData == NULL) {
+		return RC_BUFFER_POOL_NOT_INIT;
+	}
+	if (numPages < 1) {
+		return RC_INVALID_NUMBER_OF_PAGES;
 	}
-	int y = leastFreqIndex + 1;
-	i = y % bufferSize;
-	// Compare reference counts to find the least frequently used page frame
-	for(j=0;j<bufferSize;j++) {
-		if (pageFrame[i].refNum < leastFreqRef) {
-			leastFreqIndex = i;
-			leastFreqRef = pageFrame[i].refNum;
+	BM_FrameTable *frames = bm->mgmtData;
+	int oldPages = bm->numPages;
+	if (numPages > oldPages && memoryBudget > 0
+			&& getBufferMemoryUsage() + numPages - oldPages > memoryBudget) {
+		return RC_MEMORY_BUDGET_EXCEEDED;
+	}
+
+	// Give up the frames past the new end, top down, until a pinned one is found
+	int keep = oldPages;
+	while (keep > numPages && !BM_TEST_BIT(frames->pinnedBits, keep - 1)) {
+		int frame = --keep;
+		if (frames->pageNums[frame] != NO_PAGE) {
+			if (BM_TEST_BIT(frames->dirtyBits, frame)) {
+				persistPage(bm, frame);
+			}
+			if (bm->policy->onEvict != NULL) {
+				bm->policy->onEvict(bm, frame);
+			}
+			rememberGhost(bm, frames->pageNums[frame]);
 		}
-		i = (i + 1) % bufferSize;
+		free(frames->data[frame]);
+		BM_CLEAR_BIT(frames->refBits, frame);
 	}
-	// Persist the chosen page frame if it is not dirty
-	if (!(pageFrame[leastFreqIndex].dirtyBit)) {
-		SM_FileHandle fh;
-		openPageFile(b_mgr->pageFile, &fh);
-		writeBlock(pageFrame[leastFreqIndex].pageNum, &fh, pageFrame[leastFreqIndex].data);
-		// Increment the global write count
-		writeCount++;
+	RC rc = RC_OK;
+	if (keep > numPages) {
+		numPages = keep;
+		rc = RC_PINNED_PAGES_IN_BUFFER;
 	}
-	// Update the LFU pointer
-	lfuPointer = leastFreqIndex + 1;
-	// Update the chosen page frame with the content of the incoming page
-	pageFrame[leastFreqIndex].fixCount = page->fixCount;	
-	pageFrame[leastFreqIndex].data = page->data;
-	pageFrame[leastFreqIndex].dirtyBit = page->dirtyBit;
-	pageFrame[leastFreqIndex].pageNum = page->pageNum;
-	
+
+	frames->data = realloc(frames->data, sizeof(SM_PageHandle) * numPages);
+	frames->pageNums = realloc(frames->pageNums, sizeof(PageNumber) * numPages);
+	frames->fixCounts = realloc(frames->fixCounts, sizeof(int) * numPages);
+	frames->hitNums = realloc(frames->hitNums, sizeof(int) * numPages);
+	frames->refNums = realloc(frames->refNums, sizeof(int) * numPages);
+	frames->snapshotPins = realloc(frames->snapshotPins, sizeof(int) * numPages);
+	frames->pinnedBits = resizeBits(frames->pinnedBits, oldPages, numPages);
+	frames->dirtyBits = resizeBits(frames->dirtyBits, oldPages, numPages);
+	frames->refBits = resizeBits(frames->refBits, oldPages, numPages);
+	// New frames start empty
+	for (int k = oldPages; k < numPages; k++) {
+		frames->data[k] = NULL;
+		frames->pageNums[k] = NO_PAGE;
+		frames->fixCounts[k] = frames->hitNums[k] = frames->refNums[k] = frames->snapshotPins[k] = 0;
+	}
+	bm->numPages = numPages;
+	if (bm->hand >= numPages) {
+		bm->hand = 0;
+	}
+	// The shadow caches of RS_ADAPTIVE model the pool size
+	if (bm->strategy == RS_ADAPTIVE && numPages != oldPages) {
+		resizeAdaptivePolicy(bm->policy, numPages);
+	}
+	return rc;
 }
 
+
+int compareGhostHits(const void *a, const void *b)
+{
+	return (*(BM_BufferPool *const *)a)->ghostHits - (*(BM_BufferPool *const *)b)->ghostHits;
+}
+
+
 /*
- * Function: LRU
- * ------------
- * Implements the Least Recently Used (LRU) page replacement strategy.
- * Finds the page frame with the least recently used hit number for replacement.
- * Updates the chosen page frame with the content of the incoming page.
- * Persists the chosen page frame if it is dirty.
+ * Function: reclaimFrames
+ * -----------------------
+ * Shrinks the registered pools, fewest ghost hits first and none of them below
+ * GOVERNOR_MIN_FRAMES, until the requested number of frames is free.
  *
  * Parameters:
- * - b_mgr: A pointer to the buffer pool structure.
- * - page: A pointer to the page frame to be inserted/replaced in the buffer pool.
+ * - needed: The number of frames to free.
+ * - except: A pool to leave alone, may be NULL.
+ * - ghostLimit: Only pools with fewer ghost hits are shrunk.
+ *
+ * Returns:
+ * - The number of frames freed.
  */
-void LRU(BM_BufferPool *const b_mgr, PageFrame *page) {	
-	// Check if the buffer pool is NULL
-	if (b_mgr == NULL) {
-        
-        return;
-    }
-    // Check if the page file is NULL
-    if (b_mgr->pageFile == NULL) {
-        return;
-    }
-	
-	
-	PageFrame *pageFrame = (PageFrame *) b_mgr->mgmtData;
-	int leastHitIndex = 0, leastHitNum = 0;
-	// Return if the incoming page is NULL or has no data
-	if(page == NULL){
-		return;
+int reclaimFrames(int needed, BM_BufferPool *except, int ghostLimit)
+{
+	int count = 0;
+	int freed = 0;
+	for (BM_BufferPool *pool = registeredPools; pool != NULL; pool = pool->nextPool) {
+		count++;
 	}
-    if (page->data == NULL) {
-        return;
-    }
-	int i = 0;
-	// Find the page frame with the least recently used hit number and fixCount = 0
-	while (i < bufferSize) {
-    if (pageFrame[i].fixCount == 0) {
-        leastHitIndex = i;
-        leastHitNum = pageFrame[i].hitNum;
-        break;
-    }
-   	 i++;
-	}
-
-	 i = leastHitIndex + 1;
-	 leastHitIndex = 0;
-	 leastHitNum = pageFrame[0].hitNum;
-	 i = 1;
-	// Compare hit numbers to find the least recently used page frame
-	while (i < bufferSize) {
-		if (!(pageFrame[i].hitNum >= leastHitNum)) {
-			leastHitIndex = i;
-			leastHitNum = pageFrame[leastHitIndex].hitNum;
-		}
-		i=i+1;
-	}
-	// Update the chosen page frame with the content of the incoming page
-	pageFrame[leastHitIndex].dirtyBit = page->dirtyBit;
-	pageFrame[leastHitIndex].hitNum = page->hitNum;
-	pageFrame[leastHitIndex].data = page->data;
-	pageFrame[leastHitIndex].dirtyBit = page->dirtyBit;
-	pageFrame[leastHitIndex].pageNum = page->pageNum;
-	pageFrame[leastHitIndex].fixCount = page->fixCount;
-	// Persist the chosen page frame if it is dirty
-	if (!(pageFrame[leastHitIndex].dirtyBit != 1)){
-		SM_FileHandle fh;
-		openPageFile(b_mgr->pageFile, &fh); 
-		writeBlock(pageFrame[leastHitIndex].pageNum, &fh, pageFrame[leastHitIndex].data); // Write the data
-		// Write the data
-		writeCount++;
-	}
-}
-
-/*
- * Function: LRU_K
- * ---------------
- * Implements the Least Recently Used with K-second aging (LRU-K) page replacement strategy.
- * Finds the page frame with the least recently used hit number for replacement.
- * Updates the chosen page frame with the content of the incoming page.
- * Persists the chosen page frame if it is dirty.
+	BM_BufferPool **donors = malloc(sizeof(BM_BufferPool *) * (count + 1));
+	count = 0;
+	for (BM_BufferPool *pool = registeredPools; pool != NULL; pool = pool->nextPool) {
+		if (pool != except) {
+			donors[count++] = pool;
+		}
+	}
+	qsort(donors, count, sizeof(BM_BufferPool *), compareGhostHits);
+
+	for (int i = 0; i < count && freed < needed && donors[i]->ghostHits < ghostLimit; i++) {
+		int before = donors[i]->numPages;
+		int target = before - (needed - freed);
+		if (target < GOVERNOR_MIN_FRAMES) {
+			target = GOVERNOR_MIN_FRAMES;
+		}
+		if (target < before) {
+			resizeBufferPool(donors[i], target);
+			freed += before - donors[i]->numPages;
+		}
+	}
+	free(donors);
+	return freed;
+}
+
+
+/*
+ * Function: rebalancePools
+ * ------------------------
+ * One rebalancing step: the pool with the most ghost hits in the last interval
+ * gets up to GOVERNOR_STEP frames, taken from unused budget first and then
+ * from the pools with fewer ghost hits. Ghost hits approximate the marginal
+ * gain of GOVERNOR_STEP more frames; the pool with the fewest is assumed to
+ * lose the least by giving them up.
+ */
+void rebalancePools(void)
+{
+	BM_BufferPool *receiver = NULL;
+	for (BM_BufferPool *pool = registeredPools; pool != NULL; pool = pool->nextPool) {
+		if (pool->ghostHits > 0 && (receiver == NULL || pool->ghostHits > receiver->ghostHits)) {
+			receiver = pool;
+		}
+	}
+	if (receiver != NULL) {
+		int slack = memoryBudget - getBufferMemoryUsage();
+		if (slack < GOVERNOR_STEP) {
+			reclaimFrames(GOVERNOR_STEP - (slack > 0 ? slack : 0), receiver, receiver->ghostHits);
+			slack = memoryBudget - getBufferMemoryUsage();
+		}
+		if (slack > GOVERNOR_STEP) {
+			slack = GOVERNOR_STEP;
+		}
+		if (slack > 0) {
+			resizeBufferPool(receiver, receiver->numPages + slack);
+		}
+	}
+	for (BM_BufferPool *pool = registeredPools; pool != NULL; pool = pool->nextPool) {
+		pool->ghostHits = 0;
+	}
+}
+
+
+/*
+ * Function: governorOnMiss
+ * ------------------------
+ * Accounts a miss of the pool and runs a rebalancing step every
+ * GOVERNOR_INTERVAL misses while a budget is set.
+ */
+void governorOnMiss(BM_BufferPool *const bm, PageNumber pageNum)
+{
+	for (int i = 0; i < GOVERNOR_STEP; i++) {
+		if (bm->ghosts[i] == pageNum) {
+			bm->ghostHits++;
+			break;
+		}
+	}
+	if (memoryBudget > 0 && ++governorMisses >= GOVERNOR_INTERVAL) {
+		governorMisses = 0;
+		rebalancePools();
+	}
+}
+
+
+/*
+ * Function: setBufferMemoryBudget
+ * -------------------------------
+ * Caps the frames of all buffer pools together, shrinking the pools right away
+ * if they hold more. 0 removes the cap.
  *
  * Parameters:
- * - b_mgr: A pointer to the buffer pool structure.
- * - page: A pointer to the page frame to be inserted/replaced in the buffer pool.
+ * - numFrames: The maximum number of frames, or 0.
+ *
+ * Returns:
+ * - RC_OK: If the pools fit in the budget.
+ * - RC_MEMORY_BUDGET_EXCEEDED: If pinned pages or GOVERNOR_MIN_FRAMES keep
+ *   them above it; the budget is still set and no pool grows until they fit.
  */
-void LRU_K(BM_BufferPool *const b_mgr, PageFrame *page) {
-   // Check if the buffer pool is NULL
-   if (b_mgr == NULL) {
-        return;
-    }
-    // Check if the page file is NULL
-    if (b_mgr->pageFile == NULL) {
-        
-        return;
-    }
-    
-	
-	
-	PageFrame *pageFrame = (PageFrame *) b_mgr->mgmtData;
-	int leastHitIndex = 0, leastHitNum = 0;
-	// Return if the incoming page is NULL or has no data
-	if(page == NULL){
-		return;
+RC setBufferMemoryBudget(int numFrames)
+{
+	if (numFrames < 0) {
+		return RC_INVALID_NUMBER_OF_PAGES;
 	}
-    
-    if (page->data == NULL) {
-       
-        return;
-    }
-	
-	int i = 0;
-	// Find the page frame with the least recently used hit number and fixCount = 0
-	while (i < bufferSize) {
-    if (pageFrame[i].fixCount == 0) {
-        leastHitIndex = i;
-        leastHitNum = pageFrame[i].hitNum;
-        break;
-    }
-    i++;
+	memoryBudget = numFrames;
+	governorMisses = 0;
+	int excess = getBufferMemoryUsage() - numFrames;
+	if (numFrames > 0 && excess > 0 && reclaimFrames(excess, NULL, INT_MAX) < excess) {
+		return RC_MEMORY_BUDGET_EXCEEDED;
+	}
+	return RC_OK;
 }
-	// Compare hit numbers to find the least recently used page frame
-	for(i=leastHitIndex + 1; i<bufferSize; i++) {
-		if (!(pageFrame[i].hitNum >= leastHitNum)) {  
-			leastHitIndex  = i;
-			leastHitNum = pageFrame[i].hitNum;
+
+
+/*
+	- description : Creates and initializes a buffer pool with page frames (numPages).
+	- param :
+		1. b_mgr - pointer to the buffer pool
+		2. pageFN -  stores the no of page files which are cached in memory.
+		3. numPages - no. of the page frames
+		4. strategy -  the page replacement strategy (FIFO, LRU, LFU, CLOCK, CUSTOM, ADAPTIVE)
+		5. stratData -  the BM_ReplacementPolicy to use when strategy is RS_CUSTOM
+	- return : RC code, RC_MEMORY_BUDGET_EXCEEDED if a memory budget is set and no frame is left
+	- note : under a memory budget the pool may get fewer frames than numPages
+*/
+extern RC initBufferPool(BM_BufferPool *const b_mgr, const char *const pageFN,
+		  const int numPages, ReplacementStrategy strategy,
+		  void *stratData)
+{
+	// Under a memory budget take what is left, shrinking other pools if needed
+	int frameCount = numPages;
+	if (memoryBudget > 0) {
+		int slack = memoryBudget - getBufferMemoryUsage();
+		if (slack < numPages) {
+			slack += reclaimFrames(numPages - slack, NULL, INT_MAX);
+		}
+		if (slack < frameCount) {
+			frameCount = slack;
+		}
+		if (frameCount < 1) {
+			return RC_MEMORY_BUDGET_EXCEEDED;
 		}
 	}
-	// Update the chosen page frame with the content of the incoming page
-	pageFrame[leastHitIndex].hitNum = page->hitNum;
-	pageFrame[leastHitIndex].data = page->data;
-	pageFrame[leastHitIndex].pageNum = page->pageNum;
-	pageFrame[leastHitIndex].fixCount = page->fixCount;
-	pageFrame[leastHitIndex].dirtyBit = page->dirtyBit;
-	// Persist the chosen page frame if it is dirty
-	if (pageFrame[leastHitIndex].dirtyBit) {
-		SM_FileHandle fh;
-		openPageFile(b_mgr->pageFile, &fh);
-		writeBlock(pageFrame[leastHitIndex].pageNum, &fh, pageFrame[leastHitIndex].data); // Write the data
-		writeCount++;
+
+	// Pick the hooks driving the replacement strategy
+	switch (strategy) {
+		case RS_CUSTOM:
+			b_mgr->policy = (BM_ReplacementPolicy *)stratData;
+			break;
+		case RS_ADAPTIVE:
+			b_mgr->policy = createAdaptivePolicy(frameCount);
+			break;
+		default:
+			b_mgr->policy = builtinPolicy(strategy);
+			break;
+	}
+	if (b_mgr->policy == NULL || b_mgr->policy->chooseVictim == NULL) {
+		return RC_STRATEGY_NOT_SUPPORTED;
+	}
+
+	b_mgr->pageFile = (char *)pageFN;
+	b_mgr->numPages = frameCount;
+	b_mgr->strategy = strategy;
+
+	// Allocate the frame bookkeeping, one dense array per field
+	BM_FrameTable *frames = malloc(sizeof(BM_FrameTable));
+	int words = BM_BIT_WORDS(frameCount);
+	frames->data = calloc(frameCount, sizeof(SM_PageHandle));
+	frames->pageNums = malloc(sizeof(PageNumber) * frameCount);
+	frames->fixCounts = calloc(frameCount, sizeof(int));
+	frames->hitNums = calloc(frameCount, sizeof(int));
+	frames->refNums = calloc(frameCount, sizeof(int));
+	frames->snapshotPins = calloc(frameCount, sizeof(int));
+	frames->snapshots = NULL;
+	frames->pinnedBits = calloc(words, sizeof(uint64_t));
+	frames->dirtyBits = calloc(words, sizeof(uint64_t));
+	frames->refBits = calloc(words, sizeof(uint64_t));
+
+	// Initialize each page frame as empty
+	for (int k = 0; k < frameCount; k++) {
+		frames->pageNums[k] = NO_PAGE;
 	}
+	// Set the management data of the buffer pool to the frame table
+	b_mgr->mgmtData = frames;
+	// Initialize variables related to the replacement strategy
+	b_mgr->hand = b_mgr->tick = 0;
+	b_mgr->readIO = b_mgr->writeIO = 0;
+	// Register with the memory governor
+	b_mgr->ghosts = malloc(sizeof(PageNumber) * GOVERNOR_STEP);
+	for (int k = 0; k < GOVERNOR_STEP; k++) {
+		b_mgr->ghosts[k] = NO_PAGE;
+	}
+	b_mgr->ghostHand = b_mgr->ghostHits = 0;
+	b_mgr->nextPool = registeredPools;
+	registeredPools = b_mgr;
+	// Return success code
+	return RC_OK;
 }
 
 
 /*
- * Function: CLOCK
- * ---------------
- * Implements the CLOCK page replacement strategy.
- * Iterates through the circular buffer using a clock hand to find the next
- * available page frame. If a suitable page frame is found, updates it with
- * the content of the incoming page. Persists the replaced page if it is dirty.
+ * Function: nextEvictableFrame
+ * ----------------------------
+ * Finds the first frame at or after 'from' that is unpinned, and clean as well
+ * when cleanOnly is set. The pinned and dirty bitsets are combined a word at a
+ * time, so one step tests 64 frames.
  *
  * Parameters:
- * - b_mgr: A pointer to the buffer pool structure.
- * - page: A pointer to the page frame to be inserted/replaced in the buffer pool.
+ * - bm: A pointer to the buffer pool structure.
+ * - from: The first frame to consider.
+ * - cleanOnly: Skip frames holding a dirty page.
+ *
+ * Returns:
+ * - The frame number, or -1 if no such frame exists.
  */
-void CLOCK(BM_BufferPool *const b_mgr, PageFrame *page) {    
-    PageFrame *pageFrame = (PageFrame *) b_mgr->mgmtData;
-	 // Iterate through the circular buffer using a clock hand
-    for (; clockPointer % bufferSize != 0; clockPointer++) {
-        // If an available page frame is found
-		if (!(pageFrame[clockPointer].hitNum)) {
-			// If the found page frame is dirty, persist it
-            if (pageFrame[clockPointer].dirtyBit) {  
-                SM_FileHandle fh;
-                openPageFile(b_mgr->pageFile, &fh); 
-                writeBlock(pageFrame[clockPointer].pageNum, &fh, pageFrame[clockPointer].data); // and write the data
-            }
-            // Update the found page frame with the content of the incoming page
-            pageFrame[clockPointer] = *page;
-            break;
-        } else {
-            // Reset the hitNum of the examined page frame
-            pageFrame[clockPointer].hitNum = 0;
+int nextEvictableFrame(BM_BufferPool *const bm, int from, bool cleanOnly) {
+    BM_FrameTable *frames = bm->mgmtData;
+    int words = BM_BIT_WORDS(bm->numPages);
+    if (from < 0) {
+        from = 0;
+    }
+    for (int w = from >> 6; w < words; w++) {
+        uint64_t candidates = ~(frames->pinnedBits[w] | (cleanOnly ? frames->dirtyBits[w] : 0));
+        if (w == from >> 6) {
+            candidates &= ~0ULL << (from & 63);
+        }
+        if (candidates != 0) {
+            int frame = (w << 6) + __builtin_ctzll(candidates);
+            return frame < bm->numPages ? frame : -1;
         }
     }
-     // Move the clock hand to the next position in the circular buffer
-    clockPointer = (clockPointer + 1) % bufferSize;
+    return -1;
+}
+
+
+/*
+ * Function: persistPage
+ * ---------------------
+ * Persists the content of a dirty page frame to the page file.
+ *
+ * Parameters:
+ * - bm: A pointer to the buffer pool structure.
+ * - frame: The frame holding the data to be persisted.
+ */
+void persistPage(BM_BufferPool *const bm, int frame) {
+    BM_FrameTable *frames = bm->mgmtData;
+    SM_FileHandle fh;
+	// Open the page file associated with the buffer pool
+    openPageFile(bm->pageFile, &fh);
+	// Write the data of the dirty page frame to the page file
+    writeBlock(frames->pageNums[frame], &fh, frames->data[frame]);
+    BM_CLEAR_BIT(frames->dirtyBits, frame);
+	// Increment the write count of the pool
+    bm->writeIO++;
 }
 
 
@@ -410,19 +857,44 @@ RC shutdownBufferPool(BM_BufferPool *const b_mgr) {
         return RC_BUFFER_POOL_SHUTDOWN_ERROR;
     }
 
-    PageFrame *pageFrame;
-    pageFrame = (PageFrame *) b_mgr->mgmtData;
+    BM_FrameTable *frames = b_mgr->mgmtData;
 
-    // Check for pinned pages in the buffer pool
-    for (int i = 0; i < bufferSize; i++) {
-        if (pageFrame[i].fixCount != 0) {
+    // Check for pinned pages in the buffer pool, snapshot readers included
+    if (frames->snapshots != NULL) {
+        return RC_PINNED_PAGES_IN_BUFFER;
+    }
+    for (int w = 0; w < BM_BIT_WORDS(b_mgr->numPages); w++) {
+        if (frames->pinnedBits[w] != 0) {
             return RC_PINNED_PAGES_IN_BUFFER;
         }
     }
     // Force flush all dirty pages before freeing the allocated memory
     forceFlushPool(b_mgr);
-    // Free the allocated memory for page frames
-    free(pageFrame);
+    // Free the page data and the frame bookkeeping
+    for (int i = 0; i < b_mgr->numPages; i++) {
+        free(frames->data[i]);
+    }
+    free(frames->data);
+    free(frames->pageNums);
+    free(frames->fixCounts);
+    free(frames->hitNums);
+    free(frames->refNums);
+    free(frames->snapshotPins);
+    free(frames->pinnedBits);
+    free(frames->dirtyBits);
+    free(frames->refBits);
+    free(frames);
+    if (b_mgr->strategy == RS_ADAPTIVE) {
+        destroyAdaptivePolicy(b_mgr->policy);
+    }
+    // Leave the memory governor
+    for (BM_BufferPool **link = &registeredPools; *link != NULL; link = &(*link)->nextPool) {
+        if (*link == b_mgr) {
+            *link = b_mgr->nextPool;
+            break;
+        }
+    }
+    free(b_mgr->ghosts);
 	// Set the management data to NULL
     b_mgr->mgmtData = NULL;
     // Return success code
@@ -431,8 +903,6 @@ RC shutdownBufferPool(BM_BufferPool *const b_mgr) {
 
 
 
-
-
 /*
  * Function: forceFlushPool
  * ------------------------
@@ -450,34 +920,82 @@ RC forceFlushPool(BM_BufferPool* const bPool) {
     if (bPool->mgmtData == NULL) {
         return RC_ERROR;
     }
-    PageFrame *pFrames = (PageFrame*)bPool->mgmtData;
-    // Create a list to store pages that need to be written
-    int *pagesToWrite = malloc(sizeof(int) * bPool->numPages);
-    int numPagesToWrite = 0;
-    // Check if the page is dirty and if no one is touching it, add it to the list
-    for (int i = 0; i < bPool->numPages; i++) {
-        if (pFrames[i].fixCount == 0) {
-			if(pFrames[i].dirtyBit == 1){
-				pagesToWrite[numPagesToWrite++] = pFrames[i].pageNum;
-				pFrames[i].dirtyBit = 0;
-				writeCount++;
-			}
+    BM_FrameTable *frames = bPool->mgmtData;
+    // Write every dirty page that no one is touching, 64 frames per bitset word
+    for (int w = 0; w < BM_BIT_WORDS(bPool->numPages); w++) {
+        uint64_t toWrite = frames->dirtyBits[w] & ~frames->pinnedBits[w];
+        while (toWrite != 0) {
+            persistPage(bPool, (w << 6) + __builtin_ctzll(toWrite));
+            toWrite &= toWrite - 1;
         }
     }
-    // Open the disk file outside the loop
-    SM_FileHandle fileHandle;
-    openPageFile(bPool->pageFile, &fileHandle);
-    // Write the pages from the list
-    for (int i = 0; i < numPagesToWrite; i++) {
-        writeBlock(pagesToWrite[i], &fileHandle, pFrames[i].data);
-    }
-    // Free the allocated memory for the list
-    free(pagesToWrite);
 
     return RC_OK;
 }
 
 
+/*
+ * Function: discardPages
+ * ----------------------
+ * Drops the pages from fromPage on from the pool without writing them back,
+ * for a page file that was cut short. A pinned page stays in its frame.
+ *
+ * Parameters:
+ * - bm: A pointer to the buffer pool structure.
+ * - fromPage: The first page to drop.
+ *
+ * Returns:
+ * - RC_OK: If no frame holds such a page any more.
+ * - RC_PINNED_PAGES_IN_BUFFER: If one of them is pinned.
+ */
+RC discardPages(BM_BufferPool *const bm, PageNumber fromPage)
+{
+    if (bm->mgmtData == NULL) {
+        return RC_BUFFER_POOL_NOT_INIT;
+    }
+    BM_FrameTable *frames = bm->mgmtData;
+    RC rc = RC_OK;
+    for (int frame = 0; frame < bm->numPages; frame++) {
+        if (frames->pageNums[frame] < fromPage) {
+            continue;
+        }
+        if (BM_TEST_BIT(frames->pinnedBits, frame)) {
+            rc = RC_PINNED_PAGES_IN_BUFFER;
+            continue;
+        }
+        if (bm->policy->onEvict != NULL) {
+            bm->policy->onEvict(bm, frame);
+        }
+        frames->pageNums[frame] = NO_PAGE;
+        BM_CLEAR_BIT(frames->dirtyBits, frame);
+        BM_CLEAR_BIT(frames->refBits, frame);
+    }
+    return rc;
+}
+
+
+/*
+ * Function: findFrame
+ * -------------------
+ * Looks up the frame holding the given page.
+ *
+ * Parameters:
+ * - bm: A pointer to the buffer pool structure.
+ * - pageNum: The page to look for.
+ *
+ * Returns:
+ * - The frame number, or -1 if the page is not in the buffer pool.
+ */
+int findFrame(BM_BufferPool *const bm, PageNumber pageNum) {
+    PageNumber *pageNums = bm->mgmtData->pageNums;
+    for (int i = 0; i < bm->numPages; i++) {
+        if (pageNums[i] == pageNum) {
+            return i;
+        }
+    }
+    return -1;
+}
+
 
 /*
  * Function: markDirty
@@ -494,21 +1012,13 @@ RC forceFlushPool(BM_BufferPool* const bPool) {
  */
 RC markDirty(BM_BufferPool *const b_mgr, BM_PageHandle *const page)
 {
-	// Retrieve the page frames from the buffer pool
-    PageFrame *pageFrame = (PageFrame *)b_mgr->mgmtData;
-
-    // Iterate through the page frames to find the specified page
-    for (int i = 0; i < bufferSize; i++)
-    {
-        // If the page is found, mark it as dirty and return success
-        if (pageFrame[i].pageNum == page->pageNum)
-        {
-            pageFrame[i].dirtyBit = 1;
-            return RC_OK;
-        }
-    }
+    int frame = findFrame(b_mgr, page->pageNum);
 	// Return error code if the specified page is not found
-    return RC_ERROR;
+    if (frame < 0) {
+        return RC_ERROR;
+    }
+    BM_SET_BIT(b_mgr->mgmtData->dirtyBits, frame);
+    return RC_OK;
 }
 
 
@@ -525,30 +1035,37 @@ RC unpinPage(BM_BufferPool *const b_mgr, BM_PageHandle *const page)
      if (b_mgr->mgmtData == NULL) {
         return RC_POOL_NOT_OPEN;
     }
-	// Retrieve the page frames from the buffer pool
-    PageFrame *frameOfPage = (PageFrame *)b_mgr->mgmtData;
-    bool flag = false;
-   // Iterate through the page frames to find the specified page
-    for (int j = 0; j < b_mgr->numPages; j++)
-    {
-       // Check if the current page is the page to be unpinned
-        if (frameOfPage[j].pageNum == page->pageNum)
-        {
-            flag = true;
-             // Ensure fix count doesn't go below 0
-            if (frameOfPage[j].fixCount > 0) {
-                frameOfPage[j].fixCount--;
-            } else {
-                
-                return RC_PAGE_NOT_PINNED;
+    BM_FrameTable *frames = b_mgr->mgmtData;
+    // A snapshot reader of an image a writer has detached from its frame
+    for (BM_Snapshot **link = &frames->snapshots; *link != NULL; link = &(*link)->next) {
+        BM_Snapshot *snapshot = *link;
+        if (snapshot->data == page->data) {
+            if (--snapshot->pins == 0) {
+                *link = snapshot->next;
+                free(snapshot->data);
+                free(snapshot);
             }
-            break; 
+            return RC_OK;
         }
     }
-    if(flag == false){
+    int frame = findFrame(b_mgr, page->pageNum);
+    if (frame < 0) {
         return RC_PAGE_NOT_IN_FRAMELIST;
     }
-
+    // Ensure fix count doesn't go below 0
+    if (frames->fixCounts[frame] <= 0) {
+        return RC_PAGE_NOT_PINNED;
+    }
+    // While snapshot readers share the frame every pin on it is theirs
+    if (frames->snapshotPins[frame] > 0) {
+        frames->snapshotPins[frame]--;
+    }
+    if (--frames->fixCounts[frame] == 0) {
+        BM_CLEAR_BIT(frames->pinnedBits, frame);
+    }
+    if (b_mgr->policy->onUnpin != NULL) {
+        b_mgr->policy->onUnpin(b_mgr, frame);
+    }
     return RC_OK;
 }
 
@@ -561,43 +1078,116 @@ RC unpinPage(BM_BufferPool *const b_mgr, BM_PageHandle *const page)
 */
 RC forcePage(BM_BufferPool *const b_mgr, BM_PageHandle *const page)
 {
-    PageFrame *pageFrame = (PageFrame *)b_mgr->mgmtData;
-        // Iterating through all the pages in the buffer pool
-    for (int i = 0; i < bufferSize; i++)
-    {
-       // If the current page matches the page to be written to disk, write the page to the disk using the storage manager functions
-        if (!(pageFrame[i].pageNum != page->pageNum))
-
-        {
-            SM_FileHandle fh;
-            openPageFile(b_mgr->pageFile, &fh);
-            writeBlock(pageFrame[i].pageNum, &fh, pageFrame[i].data);
-           // Mark the page as undirty because the modified page has been written to disk
-            pageFrame[i].dirtyBit = 0;
-          // Increase the writeCount which records the number of writes done by the buffer manager.
-            writeCount++;
-            return RC_OK;
-        }
+    int frame = findFrame(b_mgr, page->pageNum);
+    if (frame < 0) {
+        return RC_PAGE_NOT_IN_FRAMELIST;
     }
-    return RC_PAGE_NOT_IN_FRAMELIST;
+    // Write the page to disk; it is clean afterwards
+    persistPage(b_mgr, frame);
+    return RC_OK;
+}
+
+/*
+ * Function: newSnapshot
+ * ---------------------
+ * Adds a detached page image to the snapshot list of the pool.
+ */
+BM_Snapshot *newSnapshot(BM_FrameTable *frames, PageNumber pageNum, char *data, int pins)
+{
+	BM_Snapshot *snapshot = malloc(sizeof(BM_Snapshot));
+	snapshot->pageNum = pageNum;
+	snapshot->data = data;
+	snapshot->pins = pins;
+	snapshot->next = frames->snapshots;
+	frames->snapshots = snapshot;
+	return snapshot;
 }
 
+
+/*
+ * Function: detachSnapshot
+ * ------------------------
+ * Hands the data of a frame shared by snapshot readers over to them and gives
+ * the frame a copy, so a writer can modify the page without the readers
+ * seeing it. The readers' pins move from the frame to the detached image.
+ *
+ * Parameters:
+ * - bm: A pointer to the buffer pool structure.
+ * - frame: The frame read by snapshot readers.
+ */
+void detachSnapshot(BM_BufferPool *const bm, int frame)
+{
+	BM_FrameTable *frames = bm->mgmtData;
+	char *copy = malloc(PAGE_SIZE);
+	memcpy(copy, frames->data[frame], PAGE_SIZE);
+	newSnapshot(frames, frames->pageNums[frame], frames->data[frame], frames->snapshotPins[frame]);
+	frames->data[frame] = copy;
+	frames->fixCounts[frame] -= frames->snapshotPins[frame];
+	frames->snapshotPins[frame] = 0;
+	if (frames->fixCounts[frame] == 0) {
+		BM_CLEAR_BIT(frames->pinnedBits, frame);
+	}
+}
+
+
 /*
-	- Description: Checks if the page frame is empty.
+	- Description: Pins a page for reading in snapshot mode. Snapshot readers share the frame's data
+	  until a writer pins the page, which then works on a copy while the readers keep the old image
+	  until they unpin. If the page is already pinned by a writer the reader gets a copy of its
+	  current image right away.
 	- Parameters:
-		1. frame - Pointer to the PageFrame structure.
-	- Return: Boolean value indicating whether the page frame is empty.
+		1. b_mgr - Pointer to the buffer pool structure.
+		2. page - Pointer to the BM_PageHandle structure for storing page information.
+		3. pageNum - Page number to be pinned.
+	- Return: RC_OK if successful, or the error codes of pinPage.
 */
-bool isPageFrameEmpty(const PageFrame *frame){
-		return frame->pageNum == -1;
+RC pinPageSnapshot(BM_BufferPool *const b_mgr, BM_PageHandle *const page, const PageNumber pageNum)
+{
+	if (b_mgr->mgmtData == NULL) {
+		return RC_PAGE_NOT_PINNED;
+	}
+	if (pageNum < 0) {
+		return RC_NEGATIVE_PAGE_NUM;
+	}
+	BM_FrameTable *frames = b_mgr->mgmtData;
+	int frame = findFrame(b_mgr, pageNum);
+
+	// Not in memory: load it with a regular pin and turn that into a snapshot pin
+	if (frame < 0) {
+		RC rc = pinPage(b_mgr, page, pageNum);
+		if (rc == RC_OK) {
+			frames->snapshotPins[findFrame(b_mgr, pageNum)]++;
+		}
+		return rc;
 	}
+
+	if (frames->fixCounts[frame] > frames->snapshotPins[frame]) {
+		// A writer holds the page, read a private copy of its current image
+		char *copy = malloc(PAGE_SIZE);
+		memcpy(copy, frames->data[frame], PAGE_SIZE);
+		page->data = newSnapshot(frames, pageNum, copy, 1)->data;
+	} else {
+		if (frames->fixCounts[frame]++ == 0) {
+			BM_SET_BIT(frames->pinnedBits, frame);
+		}
+		frames->snapshotPins[frame]++;
+		page->data = frames->data[frame];
+	}
+	if (b_mgr->policy->onHit != NULL) {
+		b_mgr->policy->onHit(b_mgr, frame);
+	}
+	page->pageNum = pageNum;
+	return RC_OK;
+}
+
 /*
 	- Description: Pins the page with the given page number in the buffer pool, replacing a page if necessary.
+	  The replacement decision is delegated to the chooseVictim hook of the pool's policy.
 	- Parameters:
 		1. b_mgr - Pointer to the buffer pool structure.
 		2. page - Pointer to the BM_PageHandle structure for storing page information.
 		3. pageNum - Page number to be pinned.
-	- Return: RC_OK if successful, or corresponding error codes.
+	- Return: RC_OK if successful, RC_NO_SPACE_IN_POOL if every frame is pinned, or corresponding error codes.
 */
 RC pinPage (BM_BufferPool *const b_mgr, BM_PageHandle *const page, const PageNumber pageNum)
 {
@@ -609,157 +1199,76 @@ RC pinPage (BM_BufferPool *const b_mgr, BM_PageHandle *const page, const PageNum
         return RC_NEGATIVE_PAGE_NUM;
     }
 
-	PageFrame *frameOfPage = (PageFrame *)b_mgr->mgmtData;
-
-	 // Check if the buffer pool is not empty
-	if(!isPageFrameEmpty(&frameOfPage[0]))
-	{	
-		bool bufferFull = true;
-		int j;
-		j = 0;
-		// Iterate through the buffer pool pages
-		while (j < bufferSize) {
-			// Check if the page frame is empty
-
-			if (frameOfPage[j].pageNum == -1) {
-				// Initialize a new page frame for the page to be pinned
+	BM_FrameTable *frames = b_mgr->mgmtData;
+	BM_ReplacementPolicy *policy = b_mgr->policy;
 
-    SM_FileHandle fileh;
-	frameOfPage[j].data = (SM_PageHandle)malloc(PAGE_SIZE);
-	openPageFile(b_mgr->pageFile, &fileh);
-	readBlock(pageNum, &fileh, frameOfPage[j].data);
-
-	rearIndex++;
-	hit++; // Increase the hit (LRU algorithm uses the hit to find the least recently used page)
-
-	page->pageNum = pageNum;
-	page->data = frameOfPage[j].data;
-
-	bufferFull = false;
-	// Set hitNum based on the page replacement strategy
-	if (b_mgr->strategy == RS_CLOCK)
-	// hitNum is set to 1 to signify that this was the final page frame checked before adding it to the buffer.
-		frameOfPage[j].hitNum = 1;
-	else if (b_mgr->strategy == RS_LRU)
-	// The least recently used page is determined by the LRU algorithm using the hit value.
-		frameOfPage[j].hitNum = hit;
-
-	frameOfPage[j].refNum = 0;
-	frameOfPage[j].pageNum = pageNum;
-	frameOfPage[j].fixCount = 1;
-
-		break;
-	} else {
-    // Verifying that the page is in memory
-    if (frameOfPage[j].pageNum == pageNum) {
-                          // Update fixCount as a new client has just accessed this page
-        bufferFull = false;
-        frameOfPage[j].fixCount++;
-        hit++; // Increasing the hit (the LRU method uses the hit to find the least recently used page).
-
-        switch (b_mgr->strategy) {
-            case RS_CLOCK:
-			// hitNum is set to 1 to signify that this was the final page frame checked before adding it to the buffer pool.
-                frameOfPage[j].hitNum = 1;
-                break;
-            case RS_LFU:
-             // Increase reference count, representing one more usage of the page (referenced).
-                frameOfPage[j].refNum++;
-                break;
-            case RS_LRU:
-            case RS_LRU_K:
-                // The least recently used page is determined by the LRU algorithm using the hit value.
-                frameOfPage[j].hitNum = hit;
-                break;
-            default:
-                // Handle the case where the strategy is not recognized
-                break;
-        }
-
-        clockPointer++;
-        page->data = frameOfPage[j].data;
-        page->pageNum = pageNum;
-
-        break;
-    }
-}
-			j++;
-		}
-        // Check if the buffer is full
-		bool bufferFullCondition = bufferFull == true;
-	if (bufferFullCondition) {
- 	// Create a new page frame to store data read from the file.
-    PageFrame *newPage = (PageFrame *)malloc(sizeof(PageFrame));
-    // Read a page from disk and start the buffer pool with the contents of the page frame
-    SM_FileHandle fileH;
-    openPageFile(b_mgr->pageFile, &fileH);
-    newPage->data = (SM_PageHandle)malloc(PAGE_SIZE);
-	newPage->refNum = 0;
-    newPage->fixCount = 1;
-    readBlock(pageNum, &fileH, newPage->data);
-    newPage->pageNum = pageNum;
-    newPage->dirtyBit = 0;
-    hit++;
-    rearIndex++;
-    // Set hitNum based on the page replacement strategy
-    if (b_mgr->strategy == RS_LRU_K || b_mgr->strategy == RS_LRU) {
-        newPage->hitNum = hit;
-    } else if (b_mgr->strategy == RS_CLOCK) {
-        newPage->hitNum = 1;
-    }
-    page->pageNum = pageNum;
-    page->data = newPage->data;
-	 // Depending on the chosen page replacement technique, call the relevant algorithm's function (provided through arguments).
-			switch (b_mgr->strategy) {
-				case RS_FIFO:
-					FIFO(b_mgr, newPage);
-					break;
-				case RS_LRU:
-					LRU(b_mgr, newPage);
-					break;
-				case RS_CLOCK:
-					CLOCK(b_mgr, newPage);
-					break;
-				case RS_LFU:
-					LFU(b_mgr, newPage);
-					break;
-				case RS_LRU_K:
-					LRU_K(b_mgr, newPage);
-					break;
-				default:
-					printf("\nNo algorithm has been used.\n");
-			}
-
-            free(newPage);
-
-		}		
+	// Verifying whether the page is in memory already
+	int frame = findFrame(b_mgr, pageNum);
+	if (frame >= 0) {
+		// Snapshot readers keep the current image, the writer gets a copy
+		if (frames->snapshotPins[frame] > 0) {
+			detachSnapshot(b_mgr, frame);
+		}
+		// Update fixCount as a new client has just accessed this page
+		if (frames->fixCounts[frame]++ == 0) {
+			BM_SET_BIT(frames->pinnedBits, frame);
+		}
+		if (policy->onHit != NULL) {
+			policy->onHit(b_mgr, frame);
+		}
+		page->pageNum = pageNum;
+		page->data = frames->data[frame];
 		return RC_OK;
-	}else{
-		// Buffer pool is empty, initialize the buffer pool with the first page
-		SM_FileHandle fh;
-		openPageFile(b_mgr->pageFile, &fh);
-
-		SM_PageHandle pageData = (SM_PageHandle)malloc(PAGE_SIZE);
-		frameOfPage[0].data = pageData;
-
-		frameOfPage[0].pageNum = pageNum;
-		rearIndex = 0;
+	}
 
-		ensureCapacity(pageNum, &fh);
-		readBlock(pageNum, &fh, frameOfPage[0].data);
+	// The memory governor may resize this or other pools here
+	governorOnMiss(b_mgr, pageNum);
 
-		// Reset some attributes
-		hit = 0;
-		frameOfPage[0].fixCount++;
-		frameOfPage[0].hitNum = hit;
-		frameOfPage[0].refNum = 0;
+	// Use an empty frame if there is one, otherwise ask the policy which frame to give up
+	frame = findFrame(b_mgr, NO_PAGE);
+	if (frame < 0) {
+		frame = policy->chooseVictim(b_mgr);
+		if (frame < 0 || frames->fixCounts[frame] > 0) {
+			return RC_NO_SPACE_IN_POOL;
+		}
+		// If the page being replaced is dirty, persist it before replacement
+		if (BM_TEST_BIT(frames->dirtyBits, frame)) {
+			persistPage(b_mgr, frame);
+		}
+		if (policy->onEvict != NULL) {
+			policy->onEvict(b_mgr, frame);
+		}
+		rememberGhost(b_mgr, frames->pageNums[frame]);
+	}
 
-		page->pageNum = pageNum;
-		page->data = frameOfPage[0].data;
-    	// Reset some attributes
-		return RC_OK;
+	// Read the page from disk into the chosen frame
+	SM_FileHandle fh;
+	RC rc = openPageFile(b_mgr->pageFile, &fh);
+	if (rc != RC_OK) {
+		return rc;
+	}
+	ensureCapacity(pageNum + 1, &fh);
+	if (frames->data[frame] == NULL) {
+		frames->data[frame] = (SM_PageHandle)malloc(PAGE_SIZE);
+	}
+	readBlock(pageNum, &fh, frames->data[frame]);
+	b_mgr->readIO++;
+
+	frames->pageNums[frame] = pageNum;
+	frames->fixCounts[frame] = 1;
+	frames->hitNums[frame] = 0;
+	frames->refNums[frame] = 0;
+	frames->snapshotPins[frame] = 0;
+	BM_SET_BIT(frames->pinnedBits, frame);
+	BM_CLEAR_BIT(frames->dirtyBits, frame);
+	BM_CLEAR_BIT(frames->refBits, frame);
+	if (policy->onLoad != NULL) {
+		policy->onLoad(b_mgr, frame);
+	}
 
-	}	
+	page->pageNum = pageNum;
+	page->data = frames->data[frame];
+	return RC_OK;
 }
 
 /*
@@ -771,18 +1280,9 @@ RC pinPage (BM_BufferPool *const b_mgr, BM_PageHandle *const page, const PageNum
 
 PageNumber *getFrameContents(BM_BufferPool *const b_mgr) {
 	// Allocate memory for an array to store page numbers of pages in the buffer pool
-    PageNumber *frameContents = malloc(sizeof(PageNumber) * bufferSize);
-	// Access the array of page frames from buffer pool management data
-    PageFrame *pageFrame = (PageFrame *)b_mgr->mgmtData;
-
-    int i = 0;
-
-   // Iterate through all pages in the buffer pool and retrieve their page numbers
-    while (i < bufferSize) {
-		// Set frameContents array with the page number of each page, treating -1 as NO_PAGE
-        frameContents[i] = (pageFrame[i].pageNum != -1) ? pageFrame[i].pageNum : NO_PAGE;
-        i++;
-    }
+    PageNumber *frameContents = malloc(sizeof(PageNumber) * b_mgr->numPages);
+	// The page numbers are already stored densely, empty frames hold NO_PAGE
+    memcpy(frameContents, b_mgr->mgmtData->pageNums, sizeof(PageNumber) * b_mgr->numPages);
  // Return the array of page numbers
     return frameContents;
 }
@@ -794,14 +1294,12 @@ PageNumber *getFrameContents(BM_BufferPool *const b_mgr) {
 	- return : boolean
 */
 bool *getDirtyFlags(BM_BufferPool *const b_mgr) {
-	    // Access the array of page frames from buffer pool management data
-    PageFrame *pageFrame = (PageFrame *)b_mgr->mgmtData;
+    uint64_t *dirtyBits = b_mgr->mgmtData->dirtyBits;
     // Allocate memory to store dirty flags for each page in the buffer pool
-    bool *dirtyFlags = malloc(sizeof(bool) * bufferSize);
- // Iterate through all pages in the buffer pool and retrieve their dirty flags
-    for (int i = 0; i < bufferSize; i++) {
-// Set dirtyFlags array with TRUE if page is dirty, else set it to FALSE
-        dirtyFlags[i] = (pageFrame[i].dirtyBit == 1) ? true : false;
+    bool *dirtyFlags = malloc(sizeof(bool) * b_mgr->numPages);
+ // Expand the dirty bitset into one flag per frame
+    for (int i = 0; i < b_mgr->numPages; i++) {
+        dirtyFlags[i] = BM_TEST_BIT(dirtyBits, i) ? true : false;
     }
     // Return the array of dirty flags
 
@@ -816,19 +1314,10 @@ bool *getDirtyFlags(BM_BufferPool *const b_mgr) {
               It is the caller's responsibility to free the allocated memory.
 */
 int *getFixCounts(BM_BufferPool *const b_mgr) {
-    // Access the PageFrame array from the buffer pool management data
-    PageFrame *pageFrame = (PageFrame *)b_mgr->mgmtData;
-
     // Allocate memory for an array of int to store fix counts for each page frame
-    int *fixCounts = malloc(sizeof(int) * bufferSize);
-
-    int i = 0;
-    // Iterate through all the pages in the buffer pool and set fixCounts' value to the page's fixCount
-    while (i < bufferSize) {
-        // Store fixCount, treating -1 as 0 (since -1 indicates an uninitialized fixCount)
-        fixCounts[i] = (pageFrame[i].fixCount != -1) ? pageFrame[i].fixCount : 0;
-        i++;
-    }
+    int *fixCounts = malloc(sizeof(int) * b_mgr->numPages);
+    // The fix counts are already stored densely
+    memcpy(fixCounts, b_mgr->mgmtData->fixCounts, sizeof(int) * b_mgr->numPages);
 
     // Return the array of fix counts
     return fixCounts;
@@ -839,18 +1328,16 @@ int *getFixCounts(BM_BufferPool *const b_mgr) {
     - Description: Retrieves the number of read I/O operations performed since the initialization of the buffer pool.
     - Param:
         1. b_mgr - Pointer to the buffer pool structure (BM_BufferPool).
-    - Return: An integer representing the count of read I/O operations. 
-              The count is calculated as the current rear index plus one.
+    - Return: An integer representing the count of pages read from disk by this pool.
 */
 int getNumReadIO(BM_BufferPool *const b_mgr)
 {
-    // The number of read I/O operations is equivalent to the current rear index plus one.
-    return (rearIndex + 1);
+    return b_mgr->readIO;
 }
 
 /*
 	 Function to retrieve the total number of write operations performed by the buffer manager.
-	 The count is maintained as a global variable and incremented each time a write operation is executed.
+	 The count is kept per pool and incremented each time a page is written back.
 	 Parameters:
 	   - b_mgr: Buffer pool structure pointer representing the buffer manager.
 	 Returns:
@@ -858,6 +1345,6 @@ int getNumReadIO(BM_BufferPool *const b_mgr)
 */
 int getNumWriteIO (BM_BufferPool *const b_mgr)
 {
-	// Return the global variable holding the count of write operations.
-	return writeCount;
+	// Return the write count of the pool.
+	return b_mgr->writeIO;
 }
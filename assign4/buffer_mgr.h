@@ -4,6 +4,7 @@
 #include "dberror.h"
 #include "dt.h"
 #include "storage_mgr.h"
+#include <stdint.h>
 #define HASH_LEN 1259
 
 typedef int PageNumber;
@@ -14,7 +15,9 @@ typedef enum ReplacementStrategy {
     RS_LRU = 1,
     RS_CLOCK = 2,
     RS_LFU = 3,
-    RS_LRU_K = 4
+    RS_LRU_K = 4,
+    RS_CUSTOM = 5, // policy supplied by the caller through stratData
+    RS_ADAPTIVE = 6 // switches between FIFO, LRU, CLOCK and LFU using shadow caches
 } ReplacementStrategy;
 
 // Data Types and Structures
@@ -31,27 +34,92 @@ typedef struct HM {
   Node *tbl[HASH_LEN]; // table of linked list to solve hashmap collision
 } HM;
 
-// This structure represents one page frame in the buffer pool (memory).
-typedef struct Page
+// Page image kept for snapshot readers after a writer pinned the page
+typedef struct BM_Snapshot {
+	PageNumber pageNum;
+	char *data;
+	int pins;                 // snapshot pins still reading this image
+	struct BM_Snapshot *next;
+} BM_Snapshot;
+
+// Bookkeeping of the page frames in the buffer pool (memory). Every field is a
+// dense array indexed by frame number so victim searches and dirty scans only
+// walk the cache lines of the fields they need; the flag fields are bitsets
+// that can be tested 64 frames at a time.
+typedef struct BM_FrameTable
 {
-	SM_PageHandle data; // Actual data of the page
-	PageNumber pageNum; // An identification integer given to each page
-	int dirtyBit; // Used to indicate whether the contents of the page has been modified by the client
-	int fixCount; // Used to indicate the number of clients using that page at a given instance
-	int hitNum;   // Used by LRU algorithm to get the least recently used page	
-	int refNum;   // Used by LFU algorithm to get the least frequently used page
-} PageFrame;
-
-
+	SM_PageHandle *data;    // Actual data of the page held by each frame
+	PageNumber *pageNums;   // Page held by each frame, NO_PAGE if the frame is empty
+	int *fixCounts;         // Number of clients using the page of each frame
+	int *hitNums;           // Load or access stamp used by FIFO and LRU
+	int *refNums;           // Use count used by LFU
+	int *snapshotPins;      // Part of the fix count held by snapshot readers sharing the frame's data
+	uint64_t *pinnedBits;   // Bit set while the frame's fix count is above 0
+	uint64_t *dirtyBits;    // Bit set while the frame's page is modified
+	uint64_t *refBits;      // Reference bit used by CLOCK
+	BM_Snapshot *snapshots; // Images detached from their frame, still read by snapshot readers
+} BM_FrameTable;
+
+// bitset helpers for the BM_FrameTable flag fields
+#define BM_BIT_WORDS(n) (((n) + 63) / 64)
+#define BM_TEST_BIT(bits, i) (((bits)[(i) >> 6] >> ((i) & 63)) & 1ULL)
+#define BM_SET_BIT(bits, i) ((bits)[(i) >> 6] |= (1ULL << ((i) & 63)))
+#define BM_CLEAR_BIT(bits, i) ((bits)[(i) >> 6] &= ~(1ULL << ((i) & 63)))
+
+struct BM_BufferPool;
+
+// Replacement policy hooks. The built-in strategies are implemented against
+// this table, a workload specific one can be handed to initBufferPool as
+// stratData together with RS_CUSTOM. Every hook except chooseVictim may be NULL.
+typedef struct BM_ReplacementPolicy {
+    void (*onHit)(struct BM_BufferPool *const bm, int frame);   // resident page pinned again
+    void (*onLoad)(struct BM_BufferPool *const bm, int frame);  // page read from disk into frame
+    int (*chooseVictim)(struct BM_BufferPool *const bm);        // unpinned frame to reuse, -1 if none
+    void (*onEvict)(struct BM_BufferPool *const bm, int frame); // frame is about to be reused
+    void (*onUnpin)(struct BM_BufferPool *const bm, int frame); // fix count of frame was decremented
+    void *data; // private state of the policy
+} BM_ReplacementPolicy;
 
 typedef struct BM_BufferPool {
     char *pageFile;
     int numPages;
     ReplacementStrategy strategy;
-    PageFrame *mgmtData; // use this one to store the bookkeeping info your buffer
-    // LRU_K_History *history;
+    BM_FrameTable *mgmtData; // use this one to store the bookkeeping info your buffer
+    BM_ReplacementPolicy *policy; // hooks driving page replacement
+    int hand;     // rotating frame position used by CLOCK and LFU
+    int tick;     // logical clock stamped into hitNum by FIFO and LRU
+    int readIO;   // pages read from disk since initBufferPool
+    int writeIO;  // pages written to disk since initBufferPool
+    PageNumber *ghosts; // last GOVERNOR_STEP pages evicted from the pool
+    int ghostHand;      // next ghosts entry to overwrite
+    int ghostHits;      // misses on a ghost since the last rebalancing step
+    struct BM_BufferPool *nextPool; // memory governor registry
 } BM_BufferPool;
 
+// Page-id-only simulation of one built-in strategy, fed with a sample of the
+// pool's accesses. RS_ADAPTIVE runs one per candidate strategy.
+typedef struct BM_ShadowCache {
+    ReplacementStrategy strategy;
+    int numFrames;
+    PageNumber *pageNums;
+    int *stamps;   // load stamp (FIFO) or access stamp (LRU)
+    int *counts;   // use counts (LFU)
+    char *refBits; // reference bits (CLOCK)
+    int hand;
+    int tick;
+    int hits;      // hits in the current window
+} BM_ShadowCache;
+
+#define ADAPTIVE_NUM_SHADOWS 4
+
+// Private state of an RS_ADAPTIVE pool
+typedef struct BM_AdaptiveState {
+    BM_ShadowCache shadows[ADAPTIVE_NUM_SHADOWS];
+    int sampleRate;      // only pages with hash % sampleRate == 0 reach the shadows
+    int windowAccesses;  // sampled accesses seen in the current window
+    ReplacementStrategy live; // strategy currently evicting in the real pool
+} BM_AdaptiveState;
+
 typedef struct BM_PageHandle {
     PageNumber pageNum;
     char *data;
@@ -69,9 +137,10 @@ RC initBufferPool(BM_BufferPool *const bm, const char *const pageFileName,
                   void *stratData);
 RC shutdownBufferPool(BM_BufferPool *const bm);
 RC forceFlushPool(BM_BufferPool *const bm);
+RC discardPages(BM_BufferPool *const bm, PageNumber fromPage);
 
-void persistPage(BM_BufferPool *const bm, PageFrame *pageFrame);
-void updatePageFrame(PageFrame *destination, const PageFrame *source);
+void persistPage(BM_BufferPool *const bm, int frame);
+int nextEvictableFrame(BM_BufferPool *const bm, int from, bool cleanOnly);
 
 // Buffer Manager Interface Access Pages
 RC markDirty(BM_BufferPool *const bm, BM_PageHandle *const page);
@@ -79,6 +148,10 @@ RC unpinPage(BM_BufferPool *const bm, BM_PageHandle *const page);
 RC forcePage(BM_BufferPool *const bm, BM_PageHandle *const page);
 RC pinPage(BM_BufferPool *const bm, BM_PageHandle *const page,
            const PageNumber pageNum);
+// Read-only pin that keeps seeing the page as it was pinned: a writer pinning
+// the page afterwards gets a private copy. Released with unpinPage.
+RC pinPageSnapshot(BM_BufferPool *const bm, BM_PageHandle *const page,
+           const PageNumber pageNum);
 
 // Statistics Interface
 PageNumber *getFrameContents(BM_BufferPool *const bm);
@@ -87,9 +160,23 @@ int *getFixCounts(BM_BufferPool *const bm);
 int getNumReadIO(BM_BufferPool *const bm);
 int getNumWriteIO(BM_BufferPool *const bm);
 
-// LRU_K functions
-// void updateLRU_K_History(LRU_K_History *history, PageNumber pageNum);
-// void freeLRU_K_History(LRU_K_History *history);
-// PageNumber getLRU_K_HistorySize(LRU_K_History *history);
+// Built-in replacement policies
+extern BM_ReplacementPolicy fifoPolicy;
+extern BM_ReplacementPolicy lruPolicy;
+extern BM_ReplacementPolicy clockPolicy;
+extern BM_ReplacementPolicy lfuPolicy;
+
+// Memory governor. Every pool registers with it in initBufferPool; once a
+// budget is set the frames of all pools together never exceed it and frames
+// move to the pools that would gain the most hits from them.
+RC setBufferMemoryBudget(int numFrames);
+int getBufferMemoryUsage(void);
+RC resizeBufferPool(BM_BufferPool *const bm, int numPages);
+
+// RS_ADAPTIVE
+BM_ReplacementPolicy *createAdaptivePolicy(int numPages);
+void resizeAdaptivePolicy(BM_ReplacementPolicy *policy, int numPages);
+void destroyAdaptivePolicy(BM_ReplacementPolicy *policy);
+ReplacementStrategy getLiveStrategy(BM_BufferPool *const bm);
 
 #endif
\ No newline at end of file
@@ -14,9 +14,45 @@
 /* Per table buffer size */
 #define PER_TBL_BUF_SIZE 10
 
+/* Page file of the record manager's table catalog */
+#define CATALOG_FILE "rm_catalog"
+
+/* Buffer size of the table catalog */
+#define CATALOG_BUF_SIZE 4
+
+/* Sidecar file of a table's zone map: the table file name followed by this suffix */
+#define ZONEMAP_SUFFIX ".zm"
+
+/* Buffer size of a table's zone map */
+#define ZONEMAP_BUF_SIZE 4
+
+/* Range tests on zone map attributes a scan derives from its condition at most */
+#define ZONEMAP_MAX_PREDS 8
+
+/* Sidecar file of a table's string dictionaries: the table file name followed by this suffix */
+#define DICT_SUFFIX ".dict"
+
+/* Buffer size of a table's string dictionaries */
+#define DICT_BUF_SIZE 4
+
 /* Per table index size */
 #define PER_IDX_BUF_SIZE 10
 
+/* Frames of each RS_ADAPTIVE shadow cache (at most) */
+#define ADAPTIVE_SHADOW_FRAMES 16
+
+/* Sampled accesses after which RS_ADAPTIVE re-evaluates its strategy */
+#define ADAPTIVE_WINDOW 256
+
+/* Frames moved between buffer pools by one rebalancing step of the memory governor */
+#define GOVERNOR_STEP 8
+
+/* Misses over all pools between two rebalancing steps of the memory governor */
+#define GOVERNOR_INTERVAL 64
+
+/* The memory governor never shrinks a pool below this number of frames */
+#define GOVERNOR_MIN_FRAMES 4
+
 /* Page header length */
 #define PAGE_HEADER_LEN 11
 
@@ -26,6 +62,27 @@
 /* Table header length */
 #define TABLE_HEADER_PAGES_LEN 2
 
+/* Pages added to a table file at once when records are appended */
+#define RM_EXTENT_PAGES 16
+
+/* Rows of a batch filled by nextBatch */
+#define RM_BATCH_SIZE 1024
+
+/* Pages of a table claimed at once by a parallel scan worker */
+#define RM_MORSEL_PAGES 64
+
+/* Workers of a parallel scan; each holds one pin of the table's buffer pool */
+#define RM_SCAN_MAX_THREADS 16
+
+/* B+ trees attached to one open table */
+#define RM_MAX_INDEXES 8
+
+/* RIDs an index scan reads from its tree and fetches with getRecords at once */
+#define RM_INDEX_FETCH 256
+
+/* Free-space map categories are free bytes >> FSM_CATEGORY_SHIFT */
+#define FSM_CATEGORY_SHIFT 5
+
 /* Number of bits in byte */
 #define NUM_BITS 8
 
@@ -40,6 +40,7 @@ typedef int RC;
 #define RC_STRATEGY_NOT_SUPPORTED 101
 #define RC_ERROR_NO_PAGE 102
 #define RC_ERROR_NOT_FREE_FRAME 103
+#define RC_MEMORY_BUDGET_EXCEEDED 104
 
 #define RC_RM_COMPARE_VALUE_OF_DIFFERENT_DATATYPE 200
 #define RC_RM_EXPR_RESULT_IS_NOT_BOOLEAN 201
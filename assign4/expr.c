@@ -3,6 +3,8 @@
 
 #include "dberror.h"
 #include "record_mgr.h"
+#include "rm_codec.h"
+#include "rm_dict.h"
 #include "expr.h"
 #include "tables.h"
 
@@ -74,6 +76,7 @@ boolAnd (Value *left, Value *right, Value *result)
 {
 	if (left->dt != DT_BOOL || right->dt != DT_BOOL)
 		THROW(RC_RM_BOOLEAN_EXPR_ARG_IS_NOT_BOOLEAN, "boolean AND requires boolean inputs");
+	result->dt = DT_BOOL;
 	result->v.boolV = (left->v.boolV && right->v.boolV);
 
 	return RC_OK;
@@ -84,6 +87,7 @@ boolOr (Value *left, Value *right, Value *result)
 {
 	if (left->dt != DT_BOOL || right->dt != DT_BOOL)
 		THROW(RC_RM_BOOLEAN_EXPR_ARG_IS_NOT_BOOLEAN, "boolean OR requires boolean inputs");
+	result->dt = DT_BOOL;
 	result->v.boolV = (left->v.boolV || right->v.boolV);
 
 	return RC_OK;
@@ -188,3 +192,284 @@ freeVal (Value *val)
 	free(val);
 }
 
+// Number of nodes of an expression, an upper bound of its instructions
+static int countNodes (Expr *expr)
+{
+	if (expr->type != EXPR_OP)
+		return 1;
+	if (expr->expr.op->type == OP_BOOL_NOT)
+		return 1 + countNodes(expr->expr.op->args[0]);
+	return 1 + countNodes(expr->expr.op->args[0]) + countNodes(expr->expr.op->args[1]);
+}
+
+// Resolves a comparison operand; only attributes and constants are compiled
+static RC compileOperand (Expr *expr, Schema *schema, ExprOperand *operand, DataType *dt)
+{
+	switch(expr->type)
+	{
+	case EXPR_ATTRREF:
+	{
+		int attrNum = expr->expr.attrRef;
+		operand->offset = getAttrOffset(schema, attrNum);
+		operand->length = getAttrSize(schema, attrNum);
+		*dt = schema->dataTypes[attrNum];
+		return RC_OK;
+	}
+	case EXPR_CONST:
+		operand->offset = -1;
+		operand->cons = expr->expr.cons->v;
+		*dt = expr->expr.cons->dt;
+		operand->length = (*dt == DT_STRING) ? strlen(operand->cons.stringV) : 0;
+		return RC_OK;
+	default:
+		return RC_ERROR;
+	}
+}
+
+static bool isDictAttr (Expr *expr, Schema *schema)
+{
+	return expr->type == EXPR_ATTRREF && schema->layout->codeBytes[expr->expr.attrRef] > 0;
+}
+
+// Turns an equality of a dictionary encoded attribute and a string constant into a comparison of
+// codes. Other comparisons of such an attribute are left to evalExpr, as codes are not ordered,
+// and so is a constant the dictionary does not have yet: a record may still be given its code.
+static RC compileCodeEqual (Operator *op, Schema *schema, ExprInstr *instr)
+{
+	bool attrLeft = isDictAttr(op->args[0], schema);
+	Expr *attr = attrLeft ? op->args[0] : op->args[1];
+	Expr *cons = attrLeft ? op->args[1] : op->args[0];
+	RM_Dictionary *dict = schema->layout->codecs[attr->expr.attrRef].dict;
+	int code;
+
+	if (op->type != OP_COMP_EQUAL || cons->type != EXPR_CONST || dict == NULL ||
+		(code = lookupDictCode(dict, cons->expr.cons->v.stringV)) < 0)
+		return RC_ERROR;
+	instr->opcode = PROG_EQUAL_CODE;
+	compileOperand(attr, schema, &instr->args[0], &instr->dt);
+	instr->args[1].offset = -1;
+	instr->args[1].length = 0;
+	instr->args[1].cons.intV = code;
+	return RC_OK;
+}
+
+// Appends the postfix instructions of expr, tracking the stack depth they need
+static RC emitExpr (Expr *expr, Schema *schema, ExprProgram *program, int depth)
+{
+	ExprInstr *instr;
+	RC rc;
+
+	if (depth >= EXPR_STACK_SIZE)
+		return RC_ERROR;
+
+	switch(expr->type)
+	{
+	case EXPR_CONST:
+		if (expr->expr.cons->dt != DT_BOOL)
+			THROW(RC_RM_EXPR_RESULT_IS_NOT_BOOLEAN, "condition is not boolean");
+		instr = &program->instrs[program->numInstrs++];
+		instr->opcode = PROG_PUSH_CONST;
+		instr->args[0].cons.boolV = expr->expr.cons->v.boolV;
+		return RC_OK;
+	case EXPR_ATTRREF:
+		instr = &program->instrs[program->numInstrs++];
+		if ((rc = compileOperand(expr, schema, &instr->args[0], &instr->dt)) != RC_OK)
+			return rc;
+		if (instr->dt != DT_BOOL)
+			THROW(RC_RM_EXPR_RESULT_IS_NOT_BOOLEAN, "condition is not boolean");
+		instr->opcode = PROG_PUSH_ATTR;
+		return RC_OK;
+	case EXPR_OP:
+		break;
+	}
+
+	Operator *op = expr->expr.op;
+	switch(op->type)
+	{
+	case OP_COMP_EQUAL:
+	case OP_COMP_SMALLER:
+	{
+		DataType rightDt;
+		instr = &program->instrs[program->numInstrs++];
+		instr->opcode = (op->type == OP_COMP_EQUAL) ? PROG_EQUAL : PROG_SMALLER;
+		if ((rc = compileOperand(op->args[0], schema, &instr->args[0], &instr->dt)) != RC_OK ||
+			(rc = compileOperand(op->args[1], schema, &instr->args[1], &rightDt)) != RC_OK)
+			return rc;
+		if (instr->dt != rightDt)
+			THROW(RC_RM_COMPARE_VALUE_OF_DIFFERENT_DATATYPE, "equality comparison only supported for values of the same datatype");
+		if (isDictAttr(op->args[0], schema) || isDictAttr(op->args[1], schema))
+			return compileCodeEqual(op, schema, instr);
+		return RC_OK;
+	}
+	case OP_BOOL_NOT:
+		if ((rc = emitExpr(op->args[0], schema, program, depth)) != RC_OK)
+			return rc;
+		program->instrs[program->numInstrs++].opcode = PROG_NOT;
+		return RC_OK;
+	default:
+		if ((rc = emitExpr(op->args[0], schema, program, depth)) != RC_OK ||
+			(rc = emitExpr(op->args[1], schema, program, depth + 1)) != RC_OK)
+			return rc;
+		program->instrs[program->numInstrs++].opcode = (op->type == OP_BOOL_AND) ? PROG_AND : PROG_OR;
+		return RC_OK;
+	}
+}
+
+/*
+	- Function: compileExpr
+	- Description: Compiles a condition into a program for runExprProgram, resolving attribute
+	  offsets and types against the schema once. Comparisons must be between attributes and
+	  constants; for other conditions an error is returned and evalExpr has to be used.
+	- Parameters:
+		- expr: The condition. It must outlive the program, which refers to its string constants.
+		- schema: The schema of the records the program will run on.
+		- program: Receives the program.
+	- Returns:
+		- RC_OK if the condition is compiled.
+*/
+RC
+compileExpr (Expr *expr, Schema *schema, ExprProgram **program)
+{
+	ExprProgram *prog = (ExprProgram *) malloc(sizeof(ExprProgram));
+	RC rc;
+
+	prog->numInstrs = 0;
+	prog->instrs = (ExprInstr *) calloc(countNodes(expr), sizeof(ExprInstr));
+	if ((rc = emitExpr(expr, schema, prog, 0)) != RC_OK)
+	{
+		freeExprProgram(prog);
+		return rc;
+	}
+	*program = prog;
+	return RC_OK;
+}
+
+static int intOperand (ExprOperand *operand, char *data)
+{
+	int value;
+	if (operand->offset < 0)
+		return operand->cons.intV;
+	memcpy(&value, data + operand->offset, sizeof(int));
+	return value;
+}
+
+static float floatOperand (ExprOperand *operand, char *data)
+{
+	float value;
+	if (operand->offset < 0)
+		return operand->cons.floatV;
+	memcpy(&value, data + operand->offset, sizeof(float));
+	return value;
+}
+
+static bool boolOperand (ExprOperand *operand, char *data)
+{
+	bool value;
+	if (operand->offset < 0)
+		return operand->cons.boolV;
+	memcpy(&value, data + operand->offset, sizeof(bool));
+	return value;
+}
+
+// strcmp of two strings that also end after length bytes, as getAttr cuts them
+static int compareStrings (ExprOperand *left, ExprOperand *right, char *data)
+{
+	unsigned char *l = (unsigned char *) (left->offset < 0 ? left->cons.stringV : data + left->offset);
+	unsigned char *r = (unsigned char *) (right->offset < 0 ? right->cons.stringV : data + right->offset);
+	for (int i = 0; ; i++)
+	{
+		int lc = (i < left->length) ? l[i] : 0;
+		int rc = (i < right->length) ? r[i] : 0;
+		if (lc != rc || lc == 0)
+			return lc - rc;
+	}
+}
+
+static bool compareOperands (ExprInstr *instr, char *data)
+{
+	bool smaller = (instr->opcode == PROG_SMALLER);
+
+	switch(instr->dt)
+	{
+	case DT_INT:
+	{
+		int l = intOperand(&instr->args[0], data);
+		int r = intOperand(&instr->args[1], data);
+		return smaller ? l < r : l == r;
+	}
+	case DT_FLOAT:
+	{
+		float l = floatOperand(&instr->args[0], data);
+		float r = floatOperand(&instr->args[1], data);
+		return smaller ? l < r : l == r;
+	}
+	case DT_BOOL:
+	{
+		bool l = boolOperand(&instr->args[0], data);
+		bool r = boolOperand(&instr->args[1], data);
+		return smaller ? l < r : l == r;
+	}
+	case DT_STRING:
+	{
+		int cmp = compareStrings(&instr->args[0], &instr->args[1], data);
+		return smaller ? cmp < 0 : cmp == 0;
+	}
+	}
+	return FALSE;
+}
+
+/*
+	- Function: runExprProgram
+	- Description: Evaluates a compiled condition on one record without allocating.
+	- Parameters:
+		- program: The program of compileExpr.
+		- data: The attributes of the record, Record->data without its marker byte.
+	- Returns:
+		- The value of the condition.
+*/
+bool
+runExprProgram (ExprProgram *program, char *data)
+{
+	bool stack[EXPR_STACK_SIZE + 1];
+	int top = 0;
+
+	for (int i = 0; i < program->numInstrs; i++)
+	{
+		ExprInstr *instr = &program->instrs[i];
+		switch(instr->opcode)
+		{
+		case PROG_PUSH_CONST:
+			stack[top++] = instr->args[0].cons.boolV;
+			break;
+		case PROG_PUSH_ATTR:
+			stack[top++] = boolOperand(&instr->args[0], data);
+			break;
+		case PROG_EQUAL:
+		case PROG_SMALLER:
+			stack[top++] = compareOperands(instr, data);
+			break;
+		case PROG_EQUAL_CODE:
+			stack[top++] = readDictCode(data + instr->args[0].offset, instr->args[0].length) == instr->args[1].cons.intV;
+			break;
+		case PROG_NOT:
+			stack[top - 1] = !stack[top - 1];
+			break;
+		case PROG_AND:
+			top--;
+			stack[top - 1] = stack[top - 1] && stack[top];
+			break;
+		case PROG_OR:
+			top--;
+			stack[top - 1] = stack[top - 1] || stack[top];
+			break;
+		}
+	}
+	return stack[0];
+}
+
+void
+freeExprProgram (ExprProgram *program)
+{
+	free(program->instrs);
+	free(program);
+}
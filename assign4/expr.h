@@ -34,6 +34,40 @@ typedef struct Operator {
   Expr **args;
 } Operator;
 
+// Compiled form of a boolean condition: a postfix program over a stack of
+// booleans. Comparisons read attribute bytes of the record directly at
+// offsets resolved from the schema when the program is compiled.
+typedef enum ExprOpcode {
+  PROG_PUSH_CONST,  // push args[0].cons.boolV
+  PROG_PUSH_ATTR,   // push the boolean attribute at args[0].offset
+  PROG_EQUAL,       // push args[0] == args[1]
+  PROG_SMALLER,     // push args[0] < args[1]
+  PROG_EQUAL_CODE,  // push the dictionary code at args[0].offset == args[1].cons.intV
+  PROG_NOT,
+  PROG_AND,
+  PROG_OR
+} ExprOpcode;
+
+// Comparison operand: an attribute of the record or a constant
+typedef struct ExprOperand {
+  int offset;    // byte offset of the attribute in the record's attributes, -1 for a constant
+  int length;    // bytes of the attribute, or of the constant string
+  union v cons;  // value of a constant, strings point into the Expr
+} ExprOperand;
+
+typedef struct ExprInstr {
+  ExprOpcode opcode;
+  DataType dt;           // type of the compared values
+  ExprOperand args[2];
+} ExprInstr;
+
+#define EXPR_STACK_SIZE 32
+
+typedef struct ExprProgram {
+  int numInstrs;
+  ExprInstr *instrs;
+} ExprProgram;
+
 // expression evaluation methods
 extern RC valueEquals (Value *left, Value *right, Value *result);
 extern RC valueSmaller (Value *left, Value *right, Value *result);
@@ -44,6 +78,11 @@ extern RC evalExpr (Record *record, Schema *schema, Expr *expr, Value **result);
 extern RC freeExpr (Expr *expr);
 extern void freeVal(Value *val);
 
+// compiled conditions
+extern RC compileExpr (Expr *expr, Schema *schema, ExprProgram **program);
+extern bool runExprProgram (ExprProgram *program, char *data);
+extern void freeExprProgram (ExprProgram *program);
+
 
 #define CPVAL(_result,_input)						\
   do {									\
@@ -1,17 +1,25 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <limits.h>
 #include "record_mgr.h"
 #include "buffer_mgr.h"
 #include "storage_mgr.h"
 #include "const.h"
+#include "rm_page.h"
+#include "rm_fsm.h"
+#include "rm_catalog.h"
+#include "rm_pax.h"
+#include "rm_simd.h"
+#include "rm_index.h"
+#include "rm_codec.h"
 
 const int maxNumberOfPages = 100;
 
 const int attributeSize = 15; 
 
-RecordManager *recordManager;
-
 /*
 	- Function: initRecordManager
 	- Description: Initializes the record manager.
@@ -24,8 +32,8 @@ extern RC initRecordManager (void *mgmtData)
 {
 	// Initialize the storage manager
 	initStorageManager();
-	// Return success status
-	return RC_OK;
+	// Load the table catalog
+	return openCatalog();
 }
 
 /*
@@ -33,45 +41,83 @@ extern RC initRecordManager (void *mgmtData)
 	- Description: Shuts down the record manager, freeing associated resources.
 	- Parameters: None.
 	- Returns:
-		- RC_OK if the record manager is successfully shut down.
+		- RC_OK if the record manager is successfully shut down, RC_ERROR while a table is still
+		  open; the record manager stays up then.
 */
 extern RC shutdownRecordManager ()
 {
-	// Clear the record manager pointer
-	recordManager = NULL;
-	// Free the memory associated with the record manager
-	free(recordManager);
-	// Return success status
-	return RC_OK;
+	// Write the catalog back and free it
+	return closeCatalog();
 }
 
 /*
-	- Function: getFreeSpace
-	- Description: Finds the index of the first available slot in a page for storing a record.
+	- Function: writeTableInfo
+	- Description: Writes the tuple count, the first page that may have free space and the number of
+	  pages of the table to its header page (page 0).
 	- Parameters:
-		- data: Pointer to the data of the page.
-		- sizeOfRecord: Size of the record to be stored.
+		- recordMngr: The record manager of the table.
 	- Returns:
-		- The index of the first available slot if found, otherwise returns -1.
+		- RC_OK if the header page is updated.
 */
-int getFreeSpace(char* data, int sizeOfRecord) {
-    int i = 0;
-    while (i < PAGE_SIZE / sizeOfRecord) {
-		// Check if the slot is available
-        if (!(data[i * sizeOfRecord] == '+')) {
-			// Return the index of the available slot
-            return i;
+RC writeTableInfo(RecordManager *recordMngr) {
+    BM_PageHandle header;
+    if (pinPage(&recordMngr->bufferPool, &header, 0) != RC_OK) {
+        return RC_PIN_PAGE_FAILED;
+    }
+    int *info = (int *)header.data;
+    info[0] = recordMngr->tuplesCount;
+    info[1] = recordMngr->freePage;
+    info[2] = recordMngr->numPages;
+    markDirty(&recordMngr->bufferPool, &header);
+    return unpinPage(&recordMngr->bufferPool, &header);
+}
+
+// Widens the zone map entry of a data page by the records it holds, record is scratch space for PAX
+static void summarizePage(RecordManager *recordMngr, Schema *schema, int pageNum, char *page, char *record) {
+    bool pax = recordMngr->layout == RM_LAYOUT_PAX;
+    int numSlots = pax ? getPaxSlots(page) : getNumSlots(page);
+    for (int slot = 0; slot < numSlots; slot++) {
+        char *data = pax ? (getPaxSlot(page, schema, slot, record, NULL) == RC_OK ? record : NULL)
+                         : getSlot(page, slot, NULL);
+        if (data != NULL) {
+            widenZoneMap(&recordMngr->zoneMap, pageNum, data);
+        }
+    }
+}
+
+// Summarizes the records already in the table in a new zone map
+static void rebuildZoneMap(RecordManager *recordMngr, Schema *schema) {
+    char *record = malloc(getRecordSize(schema));
+    BM_PageHandle page;
+
+    for (int pageNum = nextDataPage(FSM_FIRST_PAGE); pageNum < recordMngr->numPages; pageNum = nextDataPage(pageNum + 1)) {
+        if (pinPage(&recordMngr->bufferPool, &page, pageNum) != RC_OK) {
+            continue;
         }
-        i++;
+        summarizePage(recordMngr, schema, pageNum, page.data, record);
+        unpinPage(&recordMngr->bufferPool, &page);
+    }
+    free(record);
+}
+
+// Formats a data page appended to the table
+static void initDataPage(RecordManager *recordMngr, Schema *schema, char *page) {
+    if (recordMngr->layout == RM_LAYOUT_PAX) {
+        initPaxPage(page, schema);
+    } else {
+        initSlottedPage(page);
     }
-	// Return -1 if no available slot is found
-    return -1;
+}
+
+// Category of a data page in the free-space map: free slots of a PAX page, rounded free bytes otherwise
+static int dataPageCategory(RecordManager *recordMngr, char *page) {
+    return recordMngr->layout == RM_LAYOUT_PAX ? getPaxFreeSlots(page) : getFsmCategory(getPageFreeBytes(page));
 }
 
 
 /*
 	- Function: createTable
-	- Description: Creates a new table with the given name and schema.
+	- Description: Creates a new table with the given name and schema, storing its records in slotted pages.
 	- Parameters:
 		- tableName: Name of the table to be created.
 		- tableSchema: Schema of the table to be created.
@@ -79,20 +125,38 @@ int getFreeSpace(char* data, int sizeOfRecord) {
 		- RC_OK if the table is successfully created.
 */
 extern RC createTable(char *tableName, Schema *tableSchema) {
-    // Allocate memory for the record manager
-    recordManager = (RecordManager *)malloc(sizeof(RecordManager));
+    return createTableWithLayout(tableName, tableSchema, RM_LAYOUT_ROW);
+}
+
+// Creates the page file of a table with createFile, its sidecar files and its catalog entry
+static RC createTableFile(char *tableName, Schema *tableSchema, RM_PageLayout layout, RC (*createFile)(char *)) {
 	int i;
-    // Initialize buffer pool for the table
-    initBufferPool(&recordManager->bufferPool, tableName, maxNumberOfPages, RS_LRU, NULL);
+	RC result;
+
+    // An open table keeps using its file and schema, it can not be replaced
+    if ((result = openCatalog()) != RC_OK) {
+        return result;
+    }
+    RM_CatalogEntry *entry = findCatalogEntry(tableName);
+    if (entry != NULL && entry->handle != NULL) {
+        return RC_ERROR;
+    }
+
+    // Every PAX page must hold at least one record
+    if (layout == RM_LAYOUT_PAX && getPaxCapacity(tableSchema) < 1) {
+        return RC_RM_LIMIT_EXCEEDED;
+    }
 
     char pageData[PAGE_SIZE];
     char *ptrPage = pageData;
 	// Set number of tuples to 0
     *(int *)ptrPage = 0;
-	int result;
     ptrPage += sizeof(int);
-	// Set the first free page number to 1
-    *(int *)ptrPage = 1;
+	// Set the first free page number to the first data page
+    *(int *)ptrPage = nextDataPage(0);
+    ptrPage += sizeof(int);
+	// The table has only its header page and first free-space map page so far
+    *(int *)ptrPage = FSM_FIRST_PAGE + 1;
     ptrPage += sizeof(int);
 	// Store the number of attributes in the table schema
     *(int *)ptrPage = tableSchema->numAttr;
@@ -115,136 +179,123 @@ extern RC createTable(char *tableName, Schema *tableSchema) {
 
     SM_FileHandle fileHndl;
 	// Create page file if it doesn't exist
-    result = (createPageFile(tableName) != RC_OK) ? createPageFile(tableName) : RC_OK;
+    result = (createFile(tableName) != RC_OK) ? createFile(tableName) : RC_OK;
 	// Open page file
     result = (openPageFile(tableName, &fileHndl) != RC_OK) ? openPageFile(tableName, &fileHndl) : RC_OK;
 	// Write page data to the first page of the file
     result = (writeBlock(0, &fileHndl, pageData) != RC_OK) ? writeBlock(0, &fileHndl, pageData) : RC_OK;
 	// Close page file
     result = (closePageFile(&fileHndl) != RC_OK) ? closePageFile(&fileHndl) : RC_OK;
+    if (result != RC_OK || (result = createZoneMap(tableName)) != RC_OK ||
+        (result = createDictFile(tableName, tableSchema)) != RC_OK) {
+        return result;
+    }
 
-    return result;
+    // Register the table, its file is named after it
+    if ((result = openCatalog()) != RC_OK) {
+        return result;
+    }
+    return addCatalogEntry(tableName, tableName, tableSchema, layout);
+}
+
+/*
+	- Function: createTableWithLayout
+	- Description: Creates a new table with the given name, schema and data page layout. RM_LAYOUT_PAX
+	  groups the values of each attribute of a page together, which suits scans that read few attributes.
+	- Parameters:
+		- tableName: Name of the table to be created.
+		- tableSchema: Schema of the table to be created.
+		- layout: Layout of the data pages.
+	- Returns:
+		- RC_OK if the table is successfully created.
+*/
+extern RC createTableWithLayout(char *tableName, Schema *tableSchema, RM_PageLayout layout) {
+    return createTableFile(tableName, tableSchema, layout, createPageFile);
+}
+
+/*
+	- Function: createCompressedTable
+	- Description: Creates a new table like createTableWithLayout, but stores its pages LZ compressed
+	  (createCompressedPageFile). The buffer pool decompresses a page when it reads it into a frame
+	  and compresses it when it writes it back, so the table is used like any other.
+	- Parameters:
+		- tableName: Name of the table to be created.
+		- tableSchema: Schema of the table to be created.
+		- layout: Layout of the data pages.
+	- Returns:
+		- RC_OK if the table is successfully created.
+*/
+extern RC createCompressedTable(char *tableName, Schema *tableSchema, RM_PageLayout layout) {
+    return createTableFile(tableName, tableSchema, layout, createCompressedPageFile);
 }
 
 /*
 	- Function: openTable
-	- Description: Opens an existing table and initializes its metadata.
+	- Description: Opens a table of the catalog. The first openTable of a table starts its buffer pool
+	  and reads the tuple count and page counters from its header page, later calls share that handle.
 	- Parameters:
 		- rel: Pointer to RM_TableData structure where metadata of the table will be stored.
 		- name: Name of the table to be opened.
 	- Returns:
-		- RC_OK if the table is successfully opened and metadata is initialized.
+		- RC_OK if the table is successfully opened, RC_FILE_NOT_FOUND if it is not in the catalog.
 */
 extern RC openTable(RM_TableData *rel, char *name)
 {
-	
-	char *pageHandle = NULL;
-	// Set the record manager pointer in RM_TableData to the global record manager instance
-	rel->mgmtData = recordManager;
-	rel->name = name;
-	// Pin the first page of the table to read its metadata
-	if (pinPage(&recordManager->bufferPool, &recordManager->pageHandle, 0) != RC_OK)
-	{
-		return RC_ERROR;
-	}
-	pageHandle = (char *)recordManager->pageHandle.data;
-	// Check if page handle is NULL
-	if (pageHandle == NULL)
-	{
-		
-		return RC_ERROR;
-	}
-	// Read metadata from the first page
-	recordManager->tuplesCount = *(int *)pageHandle;
-
-	pageHandle += sizeof(int);
-
-	
-	recordManager->freePage = *(int *)pageHandle;
-	pageHandle += sizeof(int);
-
-	
-	int attrCount = *(int *)pageHandle;
-	pageHandle += sizeof(int);
-	// Allocate memory for schema
-	Schema *schema = (Schema *)malloc(sizeof(Schema));
-	if (schema == NULL)
-	{
-		
-		return RC_MEM_ALLOC_FAILED;
+	RC result;
+	if ((result = openCatalog()) != RC_OK) {
+		return result;
 	}
-	// Allocate memory for attribute names, data types, and type lengths
-	schema->numAttr = attrCount,
-	schema->typeLength = malloc(sizeof(int) * attrCount),
-	schema->attrNames = malloc(sizeof(char *) * attrCount),
-	schema->dataTypes = malloc(sizeof(DataType) * attrCount);
-
-	// Check memory allocation
-	if (schema->typeLength == NULL || schema->attrNames == NULL || schema->dataTypes == NULL)
-	{
-		
-		if (schema->typeLength != NULL)
-			free(schema->typeLength);
-		if (schema->attrNames != NULL)
-			free(schema->attrNames);
-		if (schema->dataTypes != NULL)
-			free(schema->dataTypes);
-		free(schema);
-		return RC_MEM_ALLOC_FAILED;
-	}
-
-	if (schema->typeLength == NULL || schema->attrNames == NULL || schema->dataTypes == NULL)
-	{
-		
-		free(schema->typeLength);
-		free(schema->attrNames);
-		free(schema->dataTypes);
-		free(schema);
+	RM_CatalogEntry *entry = findCatalogEntry(name);
+	if (entry == NULL) {
+		return RC_FILE_NOT_FOUND;
 	}
 
-	// Read attribute names, data types, and type lengths
-	for (int i = 0; i < attrCount; i++)
-	{
-		schema->attrNames[i] = (char *)malloc(attributeSize);
-		if (schema->attrNames[i] == NULL)
-		{
-			
-			for (int j = 0; j < i; j++)
-			{
-				free(schema->attrNames[j]);
-			}
-			free(schema->typeLength);
-			free(schema->attrNames);
-			free(schema->dataTypes);
-			free(schema);
+	if (entry->handle == NULL) {
+		RecordManager *recordManager = (RecordManager *)malloc(sizeof(RecordManager));
+		if (recordManager == NULL) {
+			return RC_MEM_ALLOC_FAILED;
 		}
-		strncpy(schema->attrNames[i], pageHandle, attributeSize);
-		pageHandle += attributeSize;
-
-		schema->dataTypes[i] = *(int *)pageHandle;
-		pageHandle += sizeof(int);
-
-		schema->typeLength[i] = *(int *)pageHandle;
-		pageHandle += sizeof(int);
-	}
-
-	// Check if schema is not NULL
-	if (schema != NULL)
-	{
-		rel->schema = schema;
-	}
-	else
-	{
-		
-		return RC_MEM_ALLOC_FAILED;
+		// Each table has its own buffer pool, registered with the memory governor
+		if ((result = initBufferPool(&recordManager->bufferPool, entry->fileName, maxNumberOfPages, RS_LRU, NULL)) != RC_OK) {
+			free(recordManager);
+			return result;
+		}
+		// Pin the first page of the table to read its counters
+		if (pinPage(&recordManager->bufferPool, &recordManager->pageHandle, 0) != RC_OK) {
+			shutdownBufferPool(&recordManager->bufferPool);
+			free(recordManager);
+			return RC_ERROR;
+		}
+		int *info = (int *)recordManager->pageHandle.data;
+		recordManager->tuplesCount = info[0];
+		recordManager->freePage = info[1];
+		recordManager->numPages = info[2];
+		recordManager->layout = entry->layout;
+		recordManager->numIndexes = 0;
+		unpinPage(&recordManager->bufferPool, &recordManager->pageHandle);
+		bool created;
+		if ((result = openZoneMap(&recordManager->zoneMap, entry->fileName, entry->schema, &created)) != RC_OK) {
+			shutdownBufferPool(&recordManager->bufferPool);
+			free(recordManager);
+			return result;
+		}
+		if (created) {
+			rebuildZoneMap(recordManager, entry->schema);
+		}
+		if ((result = openDictFile(&recordManager->dictFile, entry->fileName, entry->schema)) != RC_OK) {
+			closeZoneMap(&recordManager->zoneMap);
+			shutdownBufferPool(&recordManager->bufferPool);
+			free(recordManager);
+			return result;
+		}
+		entry->handle = recordManager;
 	}
+	entry->openCount++;
 
-	// Unpin the page after reading metadata
-	unpinPage(&recordManager->bufferPool, &recordManager->pageHandle);
-
-	// Force writing the page to disk
-	forcePage(&recordManager->bufferPool, &recordManager->pageHandle);
-
+	// The name and schema are owned by the catalog
+	rel->name = entry->name;
+	rel->schema = entry->schema;
+	rel->mgmtData = entry->handle;
 	return RC_OK;
 }
 
@@ -263,6 +314,96 @@ extern int getNumTuples (RM_TableData *rel)
 	return recordManager->tuplesCount;
 }
 
+// Inserts the keys of the records already in the table into a new index
+static RC loadIndex(RecordManager *recordMngr, Schema *schema, RM_TableIndex *index) {
+	char *record = malloc(getRecordSize(schema));
+	bool pax = recordMngr->layout == RM_LAYOUT_PAX;
+	BM_PageHandle page;
+	RC result = RC_OK;
+	Value key;
+	key.dt = DT_INT;
+
+	for (int pageNum = nextDataPage(FSM_FIRST_PAGE); pageNum < recordMngr->numPages && result == RC_OK; pageNum = nextDataPage(pageNum + 1)) {
+		if ((result = pinPage(&recordMngr->bufferPool, &page, pageNum)) != RC_OK) {
+			break;
+		}
+		int numSlots = pax ? getPaxSlots(page.data) : getNumSlots(page.data);
+		for (int slot = 0; slot < numSlots && result == RC_OK; slot++) {
+			char *data = pax ? (getPaxSlot(page.data, schema, slot, record, NULL) == RC_OK ? record : NULL)
+			                 : getSlot(page.data, slot, NULL);
+			if (data != NULL) {
+				RID id = {pageNum, slot};
+				key.v.intV = getIndexKey(index, data);
+				result = insertKey(index->tree, &key, id);
+			}
+		}
+		unpinPage(&recordMngr->bufferPool, &page);
+	}
+	free(record);
+	return result;
+}
+
+/*
+	- Function: attachIndex
+	- Description: Registers a B+ tree on a key attribute of an open table. From then on
+	  insertRecord(s), deleteRecord and updateRecord keep it up to date until detachIndex or the
+	  last closeTable. An empty tree is first filled with the records the table already has.
+	- Parameters:
+		- rel: Pointer to RM_TableData structure representing the table.
+		- attrNum: A DT_INT attribute listed in the keyAttrs of the schema.
+		- tree: An open B+ tree with DT_INT keys, owned by the caller.
+	- Returns:
+		- RC_OK if the index is attached.
+*/
+extern RC attachIndex (RM_TableData *rel, int attrNum, BTreeHandle *tree)
+{
+	RecordManager *recordManager = rel->mgmtData;
+	Schema *schema = rel->schema;
+	bool isKey = FALSE;
+	RC result;
+
+	for (int i = 0; i < schema->keySize; i++) {
+		isKey = isKey || schema->keyAttrs[i] == attrNum;
+	}
+	if (!isKey || schema->dataTypes[attrNum] != DT_INT || tree->keyType != DT_INT) {
+		return RC_RM_UNKOWN_DATATYPE;
+	}
+	for (int i = 0; i < recordManager->numIndexes; i++) {
+		if (recordManager->indexes[i].attrNum == attrNum) {
+			return RC_IM_KEY_ALREADY_EXISTS;
+		}
+	}
+	if (recordManager->numIndexes == RM_MAX_INDEXES) {
+		return RC_RM_LIMIT_EXCEEDED;
+	}
+
+	RM_TableIndex *index = &recordManager->indexes[recordManager->numIndexes];
+	index->attrNum = attrNum;
+	index->tree = tree;
+	index->offset = getAttrOffset(schema, attrNum);
+	if (tree->numEntries == 0 && (result = loadIndex(recordManager, schema, index)) != RC_OK) {
+		return result;
+	}
+	recordManager->numIndexes++;
+	return RC_OK;
+}
+
+/*
+	- Function: detachIndex
+	- Description: Stops maintaining the B+ tree attached to an attribute; the tree stays open.
+*/
+extern RC detachIndex (RM_TableData *rel, int attrNum)
+{
+	RecordManager *recordManager = rel->mgmtData;
+	for (int i = 0; i < recordManager->numIndexes; i++) {
+		if (recordManager->indexes[i].attrNum == attrNum) {
+			recordManager->indexes[i] = recordManager->indexes[--recordManager->numIndexes];
+			return RC_OK;
+		}
+	}
+	return RC_IM_KEY_NOT_FOUND;
+}
+
 /*
 	- Function: deleteTable
 	- Description: Deletes the table with the specified name from the database.
@@ -273,69 +414,226 @@ extern int getNumTuples (RM_TableData *rel)
 */
 extern RC deleteTable (char *name)
 {
-	// Delete the page file associated with the table
-	destroyPageFile(name);
-	// Return success status
-	return RC_OK;
+	RC result;
+	if ((result = openCatalog()) != RC_OK) {
+		return result;
+	}
+	RM_CatalogEntry *entry = findCatalogEntry(name);
+	if (entry == NULL) {
+		// Not in the catalog, only delete the page files
+		destroyZoneMap(name);
+		destroyDictFile(name);
+		destroyPageFile(name);
+		return RC_OK;
+	}
+	// A table that is still open can not be deleted
+	if (entry->handle != NULL) {
+		return RC_ERROR;
+	}
+	// Delete the page files associated with the table
+	destroyZoneMap(entry->fileName);
+	destroyDictFile(entry->fileName);
+	destroyPageFile(entry->fileName);
+	// Return the result of removing the table from the catalog
+	return removeCatalogEntry(name);
 }
 
 /*
-	- Function: insertRecord
-	- Description: Inserts a new record into the specified table.
+	- Function: extendTable
+	- Description: Makes sure the table file has the given page, growing it by RM_EXTENT_PAGES pages
+	  at a time so appending records does not extend the file page by page.
+	- Parameters:
+		- recordMngr: The record manager of the table.
+		- pageNum: The page about to be used.
+	- Returns:
+		- RC_OK if the page exists in the file.
+*/
+RC extendTable(RecordManager *recordMngr, int pageNum) {
+    SM_FileHandle fileHndl;
+    RC result = openPageFile(recordMngr->bufferPool.pageFile, &fileHndl);
+    if (result != RC_OK || pageNum < fileHndl.totalNumPages) {
+        return result;
+    }
+    return ensureCapacity(pageNum + RM_EXTENT_PAGES, &fileHndl);
+}
+
+// Turns the records an insert placed back into tombstones, when their keys could not be indexed
+static void unplaceRecords(RM_TableData *rel, Record **records, int n, RID *outIds) {
+    RecordManager *recordMngr = rel->mgmtData;
+    BM_PageHandle page;
+
+    for (int i = 0; i < n; i++) {
+        RID id = records[i]->id;
+        if (id.page < 0 || pinPage(&recordMngr->bufferPool, &page, id.page) != RC_OK) {
+            continue;
+        }
+        if ((recordMngr->layout == RM_LAYOUT_PAX ? deletePaxSlot(page.data, id.slot) : deleteSlot(page.data, id.slot)) == RC_OK) {
+            markDirty(&recordMngr->bufferPool, &page);
+            updateFreeSpace(&recordMngr->bufferPool, id.page, dataPageCategory(recordMngr, page.data));
+            recordMngr->tuplesCount--;
+            if (id.page < recordMngr->freePage) {
+                recordMngr->freePage = id.page;
+            }
+        }
+        unpinPage(&recordMngr->bufferPool, &page);
+        records[i]->id.page = records[i]->id.slot = -1;
+        if (outIds != NULL) {
+            outIds[i] = records[i]->id;
+        }
+    }
+}
+
+/*
+	- Function: insertRecords
+	- Description: Inserts a batch of records into the specified table. Each target page is pinned
+	  once and filled with as many of the records as fit, and the header page is written once.
 	- Parameters:
 		- rel: Pointer to RM_TableData structure representing the table.
-		- record: Pointer to the Record structure containing the data to be inserted.
+		- records: The records to insert; their ids are set to where they were stored, page and
+		  slot -1 for the records that were not stored.
+		- n: The number of records.
+		- outIds: Receives the RID of every record, may be NULL.
 	- Returns:
-		- RC_OK if the record is successfully inserted.
+		- RC_OK if all records are inserted. If the table can not be extended or a page can not be
+		  pinned, the records placed so far stay inserted and indexed, and the error is returned.
+		  If an index fails, the records of the statement are removed again.
 */
-extern RC insertRecord(RM_TableData* rel, Record* record) {
-	int rSize ;
-    
-    RID *rID = &record->id;
-	rSize = getRecordSize(rel->schema);
+extern RC insertRecords(RM_TableData* rel, Record** records, int n, RID* outIds) {
 	RecordManager *recordMngr = rel->mgmtData;
+	int rSize = getRecordSize(rel->schema);
+	bool pax = recordMngr->layout == RM_LAYOUT_PAX;
+	int i = 0;
+	RM_IndexEntry *indexKeys[RM_MAX_INDEXES];
+	RC result;
+
+    // A record must fit in an empty page together with its slot entry
+    if (!pax && rSize + SLOT_ENTRY_LEN > PAGE_SIZE - PAGE_HEADER_LEN) {
+        return RC_RM_LIMIT_EXCEEDED;
+    }
+    // Keys taken already fail the statement before any record is placed
+    if ((result = prepareIndexKeys(recordMngr->indexes, recordMngr->numIndexes, records, n, indexKeys)) != RC_OK) {
+        return result;
+    }
+    // Records keep this id until they are placed, the indexes skip the others
+    for (int j = 0; j < n; j++) {
+        records[j]->id.page = records[j]->id.slot = -1;
+        if (outIds != NULL) {
+            outIds[j] = records[j]->id;
+        }
+    }
 
-   
-    rID->page = recordMngr->freePage;
-    
-    pinPage(&recordMngr->bufferPool, &recordMngr->pageHandle, rID->page);
-
-    
-    char* auxPointer = recordMngr->pageHandle.data;
+    while (i < n && result == RC_OK) {
+        // The free-space map names a page with room, otherwise a page is appended
+        // A PAX page needs one free slot; the free bytes of a row page already count the slot entry
+        int pageNum = findFreePage(&recordMngr->bufferPool, recordMngr->freePage, recordMngr->numPages, pax ? 1 : getFsmCategory(rSize));
+        if (pageNum < 0) {
+            pageNum = nextDataPage(recordMngr->numPages);
+            if (extendTable(recordMngr, pageNum) != RC_OK) {
+                result = RC_WRITE_FAILED;
+                break;
+            }
+        }
+        if (pinPage(&recordMngr->bufferPool, &recordMngr->pageHandle, pageNum) != RC_OK) {
+            result = RC_PIN_PAGE_FAILED;
+            break;
+        }
+        char* auxPointer = recordMngr->pageHandle.data;
+        if (pageNum >= recordMngr->numPages) {
+            initDataPage(recordMngr, rel->schema, auxPointer);
+            recordMngr->numPages = pageNum + 1;
+        }
 
-    // Find a free slot in the page to insert the record
-    for (; (rID->slot = getFreeSpace(auxPointer, rSize)) == -1;) {
-		rID->page++;
-        
+        // Fill the page while it is pinned, the free slot list or bitmap gives the slots
+        int placed = 0;
+        int slot;
+        while (i < n && (slot = pax ? insertPaxSlot(auxPointer, rel->schema, records[i]->data + 1)
+                                    : insertSlot(auxPointer, records[i]->data + 1, rSize)) >= 0) {
+            records[i]->id.page = pageNum;
+            records[i]->id.slot = slot;
+            widenZoneMap(&recordMngr->zoneMap, pageNum, records[i]->data + 1);
+            if (outIds != NULL) {
+                outIds[i] = records[i]->id;
+            }
+            i++;
+            placed++;
+        }
+        if (placed > 0) {
+            markDirty(&recordMngr->bufferPool, &recordMngr->pageHandle);
+        }
+        // Also corrects a stale map entry that named a page without room
+        updateFreeSpace(&recordMngr->bufferPool, pageNum, dataPageCategory(recordMngr, auxPointer));
         unpinPage(&recordMngr->bufferPool, &recordMngr->pageHandle);
-        
-        pinPage(&recordMngr->bufferPool, &recordMngr->pageHandle, rID->page);
 
-       
-        auxPointer = recordMngr->pageHandle.data;
+        // A page the map named but that was a few bytes short is not tried again until a delete
+        recordMngr->freePage = placed > 0 ? pageNum : pageNum + 1;
+        recordMngr->tuplesCount += placed;
     }
-	  
-    auxPointer += (rID->slot * rSize);
 
-    
-    markDirty(&recordMngr->bufferPool, &recordMngr->pageHandle);
-
-    // Copy record data to the page
-    memcpy(auxPointer+1, record->data + 1, rSize - 1);
-
-    // Mark the slot as occupied
-    *auxPointer = '+';
+    // The indexes get the keys of the records placed at once, each in key order
+    RC indexResult = applyIndexKeys(recordMngr->indexes, recordMngr->numIndexes, n, indexKeys);
+    if (indexResult != RC_OK) {
+        // The trees are as they were, so the records go as well
+        unplaceRecords(rel, records, i, outIds);
+        result = indexResult;
+    }
+    // The header matches the pages even if the statement failed
+    RC headerResult = writeTableInfo(recordMngr);
+    return result != RC_OK ? result : headerResult;
+}
 
-    
-    unpinPage(&recordMngr->bufferPool, &recordMngr->pageHandle);
+/*
+	- Function: insertRecord
+	- Description: Inserts a new record into the specified table.
+	- Parameters:
+		- rel: Pointer to RM_TableData structure representing the table.
+		- record: Pointer to the Record structure containing the data to be inserted.
+	- Returns:
+		- RC_OK if the record is successfully inserted.
+*/
+extern RC insertRecord(RM_TableData* rel, Record* record) {
+    return insertRecords(rel, &record, 1, NULL);
+}
 
-    recordMngr->tuplesCount++;
+// Reads the keys a record has in the indexes of its table, nothing to do without indexes
+static RC readIndexKeys(RM_TableData *rel, RID id, int *keys) {
+    RecordManager *recordMngr = rel->mgmtData;
+    RecordRef ref;
+    AttrRef attr;
+    RC result;
 
-    pinPage(&recordMngr->bufferPool, &recordMngr->pageHandle, 0);
+    if (recordMngr->numIndexes == 0) {
+        return RC_OK;
+    }
+    if ((result = getRecordRef(rel, id, &ref)) != RC_OK) {
+        return result;
+    }
+    for (int i = 0; i < recordMngr->numIndexes; i++) {
+        getAttrRef(&ref, recordMngr->indexes[i].attrNum, &attr);
+        keys[i] = attr.v.intV;
+    }
+    return releaseRecordRef(&ref);
+}
 
-	recordManager->tuplesCount--;
-	
-    return RC_OK;
+// Moves the index entries of an updated record whose key changed, returning the first tree error
+static RC moveIndexKeys(RecordManager *recordMngr, Record *record, int *oldKeys) {
+    RC result = RC_OK;
+    for (int i = 0; i < recordMngr->numIndexes; i++) {
+        Value key;
+        RC treeResult;
+        key.dt = DT_INT;
+        key.v.intV = getIndexKey(&recordMngr->indexes[i], record->data + 1);
+        if (key.v.intV != oldKeys[i]) {
+            // The old entry only goes once the new one is in
+            if ((treeResult = insertKey(recordMngr->indexes[i].tree, &key, record->id)) == RC_OK) {
+                key.v.intV = oldKeys[i];
+                treeResult = deleteKey(recordMngr->indexes[i].tree, &key);
+            }
+            if (result == RC_OK) {
+                result = treeResult;
+            }
+        }
+    }
+    return result;
 }
 
 /*
@@ -350,37 +648,59 @@ extern RC insertRecord(RM_TableData* rel, Record* record) {
 extern RC deleteRecord(RM_TableData* table, RID id) {
     
     RecordManager *recordMgr = table->mgmtData;
-	int recordSize ;
 
+    if (id.page < 1 || id.page >= recordMgr->numPages || isFsmPage(id.page)) {
+        return RC_RM_NO_TUPLE_WITH_GIVEN_RID;
+    }
+    // Keys to remove from the indexes
+    int oldKeys[RM_MAX_INDEXES];
+    RC keysResult = readIndexKeys(table, id, oldKeys);
+    if (keysResult != RC_OK) {
+        return keysResult;
+    }
      // Pin the page containing the record
     RC pinPageResult = pinPage(&recordMgr->bufferPool, &recordMgr->pageHandle, id.page);
-    // Mark the page as dirty regardless of pinning result
-	markDirty(&recordMgr->bufferPool, &recordMgr->pageHandle); // Mark the page as dirty regardless of pinning result
+    if (pinPageResult != RC_OK) {
+		// Return pinning error code
+        return pinPageResult; 
+    }
 
-    if (pinPageResult == RC_OK) {
-        
-        recordSize = getRecordSize(table->schema);
-        char* recordDataPtr = recordMgr->pageHandle.data + (id.slot * recordSize);
-        // Mark the record as deleted
-		*recordDataPtr = '-'; 
+    // Turn the slot into a tombstone, its space is reclaimed when the page is compacted
+    RC result = recordMgr->layout == RM_LAYOUT_PAX ? deletePaxSlot(recordMgr->pageHandle.data, id.slot)
+                                                   : deleteSlot(recordMgr->pageHandle.data, id.slot);
+    if (result == RC_OK) {
+        markDirty(&recordMgr->bufferPool, &recordMgr->pageHandle);
+        updateFreeSpace(&recordMgr->bufferPool, id.page, dataPageCategory(recordMgr, recordMgr->pageHandle.data));
+    }
+    RC unpinPageResult = unpinPage(&recordMgr->bufferPool, &recordMgr->pageHandle);
+    if (result != RC_OK) {
+        return result;
+    }
+    if (unpinPageResult != RC_OK) {
+        // Return error code if unpinning fails
+		return unpinPageResult; 
+    }
 
-       
-        if (id.page > recordMgr->freePage) {
-            recordMgr->freePage = id.page;
+    // Every tree loses its entry, the first tree error is returned
+    RC indexResult = RC_OK;
+    for (int i = 0; i < recordMgr->numIndexes; i++) {
+        Value key;
+        key.dt = DT_INT;
+        key.v.intV = oldKeys[i];
+        RC treeResult = deleteKey(recordMgr->indexes[i].tree, &key);
+        if (indexResult == RC_OK) {
+            indexResult = treeResult;
         }
+    }
 
-        
-        RC unpinPageResult = unpinPage(&recordMgr->bufferPool, &recordMgr->pageHandle);
-        if (unpinPageResult != RC_OK) {
-            // Return error code if unpinning fails
-			return unpinPageResult; 
-        }
-		// Return success status
-        return RC_OK;
-    } else {
-		// Return pinning error code
-        return pinPageResult; 
+    // Inserts look the free-space map up from the lowest page with a hole
+    recordMgr->tuplesCount--;
+    if (id.page < recordMgr->freePage) {
+        recordMgr->freePage = id.page;
     }
+    RC headerResult = writeTableInfo(recordMgr);
+	// Return success status
+    return indexResult != RC_OK ? indexResult : headerResult;
 }
 
 
@@ -389,25 +709,44 @@ extern RC updateRecord(RM_TableData* rel, Record* record) {
     RecordManager *recordMngr = rel->mgmtData;
 	int rSize;
 
+    if (record->id.page < 1 || record->id.page >= recordMngr->numPages || isFsmPage(record->id.page)) {
+        return RC_RM_NO_TUPLE_WITH_GIVEN_RID;
+    }
+    // A changed key must still be free in its index
+    int oldKeys[RM_MAX_INDEXES];
+    RC keysResult = readIndexKeys(rel, record->id, oldKeys);
+    if (keysResult != RC_OK) {
+        return keysResult;
+    }
+    for (int i = 0; i < recordMngr->numIndexes; i++) {
+        Value key;
+        RID found;
+        key.dt = DT_INT;
+        key.v.intV = getIndexKey(&recordMngr->indexes[i], record->data + 1);
+        if (key.v.intV != oldKeys[i] && findKey(recordMngr->indexes[i].tree, &key, &found) == RC_OK) {
+            return RC_IM_KEY_ALREADY_EXISTS;
+        }
+    }
     // Pin the page containing the record
     if (pinPage(&recordMngr->bufferPool, &recordMngr->pageHandle, record->id.page) == RC_OK) {
-        // Mark the page as dirty
-		markDirty(&recordMngr->bufferPool, &recordMngr->pageHandle);
-
-        
         rSize = getRecordSize(rel->schema);
-        char* dataP = recordMngr->pageHandle.data + (record->id.slot * rSize);
 
-        // Mark the record as valid
-        *dataP = '+'; 
-
-        // Update the record data
-        memcpy(dataP + 1, record->data + 1, rSize - 1);
+        // Update the record data in its slot
+        RC result = recordMngr->layout == RM_LAYOUT_PAX
+                        ? updatePaxSlot(recordMngr->pageHandle.data, rel->schema, record->id.slot, record->data + 1)
+                        : updateSlot(recordMngr->pageHandle.data, record->id.slot, record->data + 1, rSize);
+        if (result == RC_OK) {
+            // Mark the page as dirty
+            markDirty(&recordMngr->bufferPool, &recordMngr->pageHandle);
+            updateFreeSpace(&recordMngr->bufferPool, record->id.page, dataPageCategory(recordMngr, recordMngr->pageHandle.data));
+            widenZoneMap(&recordMngr->zoneMap, record->id.page, record->data + 1);
+            result = moveIndexKeys(recordMngr, record, oldKeys);
+        }
 
         // Unpin the page
         if (unpinPage(&recordMngr->bufferPool, &recordMngr->pageHandle) == RC_OK) {
-            // Return success status
-			return RC_OK;
+            // Return the result of the update
+			return result;
         } else {
 			// Return error code if unpinning fails
             return RC_UNPIN_PAGE_FAILED; 
@@ -418,6 +757,75 @@ extern RC updateRecord(RM_TableData* rel, Record* record) {
     }
 }
 
+/*
+	- Function: vacuumTable
+	- Description: Reclaims the space of deleted records. Every data page is pinned in turn and
+	  compacted in place: its records are moved together and the tombstones at the end of its
+	  slot directory are dropped, so an empty page is like a new one. Records keep their slots, so
+	  RIDs and the entries of attached indexes stay valid, and readers holding a snapshot pin keep
+	  the old image. The free-space map and the zone map summary of each page are recomputed, and
+	  the empty pages at the end of the table are cut off the file.
+	- Parameters:
+		- rel: Pointer to RM_TableData structure representing the table.
+	- Returns:
+		- RC_OK if the table is vacuumed.
+*/
+extern RC vacuumTable(RM_TableData *rel) {
+    RecordManager *recordMngr = rel->mgmtData;
+    bool pax = recordMngr->layout == RM_LAYOUT_PAX;
+    char *record = malloc(getRecordSize(rel->schema));
+    BM_PageHandle page;
+    // The table keeps its header and first free-space map page
+    int numPages = FSM_FIRST_PAGE + 1;
+    RC result = RC_OK;
+
+    for (int pageNum = nextDataPage(FSM_FIRST_PAGE); pageNum < recordMngr->numPages; pageNum = nextDataPage(pageNum + 1)) {
+        if ((result = pinPage(&recordMngr->bufferPool, &page, pageNum)) != RC_OK) {
+            break;
+        }
+        if ((pax ? getPaxLiveSlots(page.data) : getLiveSlots(page.data)) > 0) {
+            numPages = pageNum + 1;
+        }
+        // PAX slots are fixed, there is nothing to move; an empty slotted page ends up without slots
+        if (!pax && vacuumSlottedPage(page.data)) {
+            markDirty(&recordMngr->bufferPool, &page);
+        }
+        updateFreeSpace(&recordMngr->bufferPool, pageNum, dataPageCategory(recordMngr, page.data));
+        // Deletes never narrowed the summary, so it is recomputed from the records left
+        clearZoneMap(&recordMngr->zoneMap, pageNum);
+        summarizePage(recordMngr, rel->schema, pageNum, page.data, record);
+        unpinPage(&recordMngr->bufferPool, &page);
+    }
+    free(record);
+    if (result != RC_OK) {
+        return result;
+    }
+
+    if (numPages < recordMngr->numPages) {
+        // The pages cut off must neither be written back past the new end of the file nor be
+        // found in the pool once the file grows again; a reader still pinning one keeps the file
+        if ((result = forceFlushPool(&recordMngr->bufferPool)) != RC_OK) {
+            return result;
+        }
+        if (discardPages(&recordMngr->bufferPool, numPages) != RC_OK) {
+            numPages = recordMngr->numPages;
+        }
+    }
+    if (numPages < recordMngr->numPages) {
+        SM_FileHandle fileHndl;
+        if ((result = openPageFile(recordMngr->bufferPool.pageFile, &fileHndl)) != RC_OK) {
+            return result;
+        }
+        if (fileHndl.totalNumPages > numPages && (result = truncatePageFile(numPages, &fileHndl)) != RC_OK) {
+            return result;
+        }
+        recordMngr->numPages = numPages;
+    }
+    // Inserts look the free-space map up again from the first data page
+    recordMngr->freePage = nextDataPage(0);
+    return writeTableInfo(recordMngr);
+}
+
 /*
 	- Function: getRecord
 	- Description: Retrieves the record specified by the given RID from the table.
@@ -432,18 +840,29 @@ extern RC getRecord(RM_TableData* rel, RID id, Record* record) {
     
     RecordManager* recordMngr = rel->mgmtData;
 	int rSize;
-    // Pin the page containing the record
-    if (pinPage(&recordMngr->bufferPool, &recordMngr->pageHandle, id.page) != RC_OK) {
+    if (id.page < 1 || id.page >= recordMngr->numPages || isFsmPage(id.page)) {
+        return RC_RM_NO_TUPLE_WITH_GIVEN_RID;
+    }
+    // Pin the page containing the record, a concurrent update works on its own copy
+    if (pinPageSnapshot(&recordMngr->bufferPool, &recordMngr->pageHandle, id.page) != RC_OK) {
         // Return error code if pinning fails
 		return RC_PIN_PAGE_FAILED; 
     }
 
     
     rSize = getRecordSize(rel->schema);
-    char* pageData = recordMngr->pageHandle.data + (id.slot * rSize);
+    char* pageData = NULL;
+    if (recordMngr->layout == RM_LAYOUT_PAX) {
+        // Gathered from the minipages straight into the record
+        if (getPaxSlot(recordMngr->pageHandle.data, rel->schema, id.slot, record->data + 1, NULL) == RC_OK) {
+            pageData = record->data + 1;
+        }
+    } else {
+        pageData = getSlot(recordMngr->pageHandle.data, id.slot, NULL);
+    }
 
     // Check if the record is valid
-    if (*pageData != '+') {
+    if (pageData == NULL) {
         // Unpin the page
         if (unpinPage(&recordMngr->bufferPool, &recordMngr->pageHandle) != RC_OK) {
             // Return error code if unpinning fails
@@ -457,7 +876,9 @@ extern RC getRecord(RM_TableData* rel, RID id, Record* record) {
     record->id = id;
     char* data = record->data;
     // Copy record data to the record structure
-	memcpy(++data, pageData + 1, rSize - 1);
+    if (pageData != data + 1) {
+	    memcpy(++data, pageData, rSize);
+    }
 
     // Unpin the page
     if (unpinPage(&recordMngr->bufferPool, &recordMngr->pageHandle) != RC_OK) {
@@ -468,44 +889,325 @@ extern RC getRecord(RM_TableData* rel, RID id, Record* record) {
     return RC_OK;
 }
 
+// RID of a getRecords request and the position of its record in the caller's order
+typedef struct RidPosition
+{
+    RID id;
+    int pos;
+} RidPosition;
 
+static int compareRidPositions(const void *a, const void *b)
+{
+    const RidPosition *left = a;
+    const RidPosition *right = b;
+    if (left->id.page != right->id.page) {
+        return (left->id.page > right->id.page) - (left->id.page < right->id.page);
+    }
+    return (left->id.slot > right->id.slot) - (left->id.slot < right->id.slot);
+}
 
 /*
-	- Function: startScan
-	- Description: Initializes a scan on the specified table with the given condition.
+	- Function: getRecords
+	- Description: Retrieves the records of a list of RIDs, as n calls of getRecord would. The RIDs
+	  are sorted by page, so every distinct page is pinned once and the pages are read in file
+	  order, and each record is copied into the output record of its RID.
 	- Parameters:
-		- rel: Pointer to RM_TableData structure representing the table to be scanned.
-		- scan: Pointer to RM_ScanHandle structure where the scan information will be stored.
-		- cond: Pointer to Expr structure representing the scan condition.
+		- rel: Pointer to RM_TableData structure representing the table.
+		- ids: The RIDs of the records.
+		- n: The number of RIDs.
+		- out: out[i] receives the record of ids[i]. A RID that holds no record leaves the data of
+		  out[i] alone and sets its id to page and slot -1.
 	- Returns:
-		- RC_OK if the scan is successfully initialized.
+		- RC_OK if every record is retrieved, RC_RM_NO_TUPLE_WITH_GIVEN_RID if some RID holds none.
 */
-extern RC startScan(RM_TableData *rel, RM_ScanHandle *scan, Expr *cond) {
-    // Check if a scan condition is provided
-    if (cond != NULL) {
-         // Allocate memory for scan manager
-        RecordManager *scanner = (RecordManager*)malloc(sizeof(RecordManager));
-        if (scanner == NULL) {
-            return RC_MEM_ALLOC_FAILED;
-        }
-        scanner->recordID.page = 1;
-        scanner->recordID.slot = 0;
-        scanner->scanCount = 0;
-        scanner->condition = cond;
-        scan->mgmtData = scanner;
-        scan->rel = rel;
+extern RC getRecords(RM_TableData *rel, RID *ids, int n, Record **out) {
+    RecordManager *recordMngr = rel->mgmtData;
+    int rSize = getRecordSize(rel->schema);
+    bool pax = recordMngr->layout == RM_LAYOUT_PAX;
+    BM_PageHandle page;
+    RC result = RC_OK;
+
+    RidPosition *order = malloc(sizeof(RidPosition) * (n > 0 ? n : 1));
+    if (order == NULL) {
+        return RC_MEM_ALLOC_FAILED;
+    }
+    for (int i = 0; i < n; i++) {
+        order[i].id = ids[i];
+        order[i].pos = i;
+    }
+    qsort(order, n, sizeof(RidPosition), compareRidPositions);
 
-          // Open a temporary table for the scan
-        if (openTable(rel, "ScanTable") != RC_OK) {
-            free(scanner);
-            return RC_FILE_NOT_FOUND;
+    for (int i = 0; i < n; ) {
+        int pageNum = order[i].id.page;
+        int end = i;
+        while (end < n && order[end].id.page == pageNum) {
+            end++;
         }
-        RecordManager *tableManager = rel->mgmtData;
-        tableManager->tuplesCount = attributeSize;
-        return RC_OK;
+        // Snapshot pin, as getRecord takes it
+        bool pinned = pageNum >= 1 && pageNum < recordMngr->numPages && !isFsmPage(pageNum) &&
+                      pinPageSnapshot(&recordMngr->bufferPool, &page, pageNum) == RC_OK;
+        for (; i < end; i++) {
+            Record *record = out[order[i].pos];
+            bool found = FALSE;
+            if (pinned && pax) {
+                found = getPaxSlot(page.data, rel->schema, order[i].id.slot, record->data + 1, NULL) == RC_OK;
+            } else if (pinned) {
+                char *data = getSlot(page.data, order[i].id.slot, NULL);
+                if (data != NULL) {
+                    memcpy(record->data + 1, data, rSize);
+                    found = TRUE;
+                }
+            }
+            if (found) {
+                record->id = order[i].id;
+            } else {
+                record->id.page = record->id.slot = -1;
+                result = RC_RM_NO_TUPLE_WITH_GIVEN_RID;
+            }
+        }
+        if (pinned && unpinPage(&recordMngr->bufferPool, &page) != RC_OK) {
+            result = RC_UNPIN_PAGE_FAILED;
+        }
+    }
+    free(order);
+    return result;
+}
+
+
+/*
+	- Function: getRecordRef
+	- Description: Looks up the record specified by the given RID without copying it: the page
+	  stays pinned and ref points into its frame until releaseRecordRef.
+	- Parameters:
+		- rel: Pointer to RM_TableData structure representing the table.
+		- id: RID (Record ID) of the record to be retrieved.
+		- ref: Receives the view of the record.
+	- Returns:
+		- RC_OK if the record is pinned, RC_RM_NO_TUPLE_WITH_GIVEN_RID if the slot holds none.
+*/
+extern RC getRecordRef(RM_TableData *rel, RID id, RecordRef *ref) {
+    RecordManager *recordMngr = rel->mgmtData;
+    if (id.page < 1 || id.page >= recordMngr->numPages || isFsmPage(id.page)) {
+        return RC_RM_NO_TUPLE_WITH_GIVEN_RID;
+    }
+    if (pinPageSnapshot(&recordMngr->bufferPool, &ref->pageHandle, id.page) != RC_OK) {
+        return RC_PIN_PAGE_FAILED;
+    }
+
+    char *page = ref->pageHandle.data;
+    bool found;
+    if (recordMngr->layout == RM_LAYOUT_PAX) {
+        found = isPaxSlotUsed(page, id.slot);
+        ref->data = NULL;
     } else {
+        ref->data = getSlot(page, id.slot, NULL);
+        found = ref->data != NULL;
+    }
+    if (!found) {
+        unpinPage(&recordMngr->bufferPool, &ref->pageHandle);
+        return RC_RM_NO_TUPLE_WITH_GIVEN_RID;
+    }
+    ref->id = id;
+    ref->rel = rel;
+    return RC_OK;
+}
+
+/*
+	- Function: releaseRecordRef
+	- Description: Unpins the page of a record looked up with getRecordRef. The views taken from
+	  it must not be used afterwards.
+*/
+extern RC releaseRecordRef(RecordRef *ref) {
+    RecordManager *recordMngr = ref->rel->mgmtData;
+    if (unpinPage(&recordMngr->bufferPool, &ref->pageHandle) != RC_OK) {
+        return RC_UNPIN_PAGE_FAILED;
+    }
+    ref->data = NULL;
+    return RC_OK;
+}
+
+
+// Marks the attributes an expression reads
+static void collectAttrRefs(Expr *expr, bool *attrs) {
+    if (expr->type == EXPR_ATTRREF) {
+        attrs[expr->expr.attrRef] = TRUE;
+    } else if (expr->type == EXPR_OP) {
+        int numArgs = expr->expr.op->type == OP_BOOL_NOT ? 1 : 2;
+        for (int i = 0; i < numArgs; i++) {
+            collectAttrRefs(expr->expr.op->args[i], attrs);
+        }
+    }
+}
+
+/*
+	- Function: startScan
+	- Description: Initializes a scan on the specified table with the given condition.
+	- Parameters:
+		- rel: Pointer to RM_TableData structure representing the table to be scanned.
+		- scan: Pointer to RM_ScanHandle structure where the scan information will be stored.
+		- cond: Pointer to Expr structure representing the scan condition.
+	- Returns:
+		- RC_OK if the scan is successfully initialized.
+*/
+extern RC startScan(RM_TableData *rel, RM_ScanHandle *scan, Expr *cond) {
+    return startProjectedScan(rel, scan, cond, 0, NULL);
+}
+
+// Schema of the attributes of a projection, in projection order
+static Schema *createProjectedSchema(Schema *schema, int numAttrs, int *attrNums) {
+    char **names = malloc(sizeof(char *) * numAttrs);
+    DataType *dataTypes = malloc(sizeof(DataType) * numAttrs);
+    int *typeLength = malloc(sizeof(int) * numAttrs);
+    for (int i = 0; i < numAttrs; i++) {
+        names[i] = schema->attrNames[attrNums[i]];
+        dataTypes[i] = schema->dataTypes[attrNums[i]];
+        typeLength[i] = schema->typeLength[attrNums[i]];
+    }
+    Schema *projected = createSchema(numAttrs, names, dataTypes, typeLength, 0, NULL);
+    free(names);
+    // Dictionary codes are copied as they are, decoded with the table's dictionaries
+    for (int i = 0; i < numAttrs; i++) {
+        if (schema->layout->codeBytes[attrNums[i]] > 0) {
+            setDictionaryEncoding(projected, i, schema->layout->codeBytes[attrNums[i]]);
+            projected->layout->codecs[i].dict = schema->layout->codecs[attrNums[i]].dict;
+        }
+    }
+    return projected;
+}
+
+static void freeProjectedSchema(Schema *schema) {
+    for (int i = 0; i < schema->numAttr; i++) {
+        free(schema->attrNames[i]);
+    }
+    free(schema->attrNames);
+    free(schema->dataTypes);
+    free(schema->typeLength);
+    freeSchema(schema);
+}
+
+/*
+	- Function: startProjectedScan
+	- Description: Initializes a scan that returns only some attributes of the matching records.
+	  next() copies the listed attributes one after the other into a compact record laid out by
+	  getScanSchema, instead of the whole record, and nextBatch() fills in only their vectors and
+	  those of the condition.
+	- Parameters:
+		- rel: Pointer to RM_TableData structure representing the table to be scanned.
+		- scan: Pointer to RM_ScanHandle structure where the scan information will be stored.
+		- cond: Pointer to Expr structure representing the scan condition.
+		- numAttrs: Number of attributes to return, 0 for the whole record.
+		- attrNums: The attribute numbers to return, in output order.
+	- Returns:
+		- RC_OK if the scan is successfully initialized.
+*/
+extern RC startProjectedScan(RM_TableData *rel, RM_ScanHandle *scan, Expr *cond, int numAttrs, int *attrNums) {
+    Schema *schema = rel->schema;
+    if (cond == NULL) {
         return RC_SCAN_CONDITION_NOT_FOUND;
     }
+    for (int i = 0; i < numAttrs; i++) {
+        if (attrNums[i] < 0 || attrNums[i] >= schema->numAttr) {
+            return RC_IMPOSSIBLE_VALUE;
+        }
+    }
+    // Allocate memory for scan manager
+    ScanManager *scanner = (ScanManager*)calloc(1, sizeof(ScanManager));
+    if (scanner == NULL) {
+        return RC_MEM_ALLOC_FAILED;
+    }
+    scanner->recordID.page = 1;
+    scanner->recordID.slot = 0;
+    scanner->scanCount = 0;
+    scanner->condition = cond;
+    scanner->condAttrs = (bool*)calloc(schema->numAttr, sizeof(bool));
+    if (scanner->condAttrs == NULL || createRecord(&scanner->condRecord, schema) != RC_OK) {
+        free(scanner->condAttrs);
+        free(scanner);
+        return RC_MEM_ALLOC_FAILED;
+    }
+    collectAttrRefs(cond, scanner->condAttrs);
+    scanner->numZonePreds = getZonePreds(&((RecordManager *)rel->mgmtData)->zoneMap, cond, scanner->zonePreds, ZONEMAP_MAX_PREDS);
+    // Compile the condition once; conditions the compiler rejects are interpreted by next()
+    if (compileExpr(cond, schema, &scanner->program) != RC_OK) {
+        scanner->program = NULL;
+    }
+
+    if (numAttrs > 0) {
+        scanner->numProj = numAttrs;
+        scanner->projAttrs = malloc(sizeof(int) * numAttrs);
+        scanner->projOffsets = malloc(sizeof(int) * numAttrs);
+        scanner->batchAttrs = malloc(sizeof(bool) * schema->numAttr);
+        memcpy(scanner->batchAttrs, scanner->condAttrs, sizeof(bool) * schema->numAttr);
+        for (int i = 0; i < numAttrs; i++) {
+            scanner->projAttrs[i] = attrNums[i];
+            scanner->projOffsets[i] = getAttrOffset(schema, attrNums[i]);
+            scanner->batchAttrs[attrNums[i]] = TRUE;
+        }
+        scanner->projSchema = createProjectedSchema(schema, numAttrs, attrNums);
+    }
+    scan->mgmtData = scanner;
+    scan->rel = rel;
+    return RC_OK;
+}
+
+/*
+	- Function: startIndexScan
+	- Description: Initializes a scan that reads the records of a key range through a B+ tree on
+	  an attribute of the table, in key order: next() walks the leaves from lowKey with nextEntry,
+	  fetches each record by its RID and applies cond to it. It reads O(log N + k) pages for k
+	  records in the range instead of the whole table.
+	- Parameters:
+		- rel: Pointer to RM_TableData structure representing the table to be scanned.
+		- scan: Pointer to RM_ScanHandle structure where the scan information will be stored.
+		- index: An open B+ tree whose keys are values of an attribute of the table.
+		- lowKey: Smallest key of the range, NULL for no lower bound.
+		- highKey: Largest key of the range, NULL for no upper bound.
+		- cond: Residual condition the records have to pass, NULL for none.
+	- Returns:
+		- RC_OK if the scan is successfully initialized.
+*/
+extern RC startIndexScan(RM_TableData *rel, RM_ScanHandle *scan, BTreeHandle *index, Value *lowKey, Value *highKey, Expr *cond) {
+    RC result;
+    if ((lowKey != NULL && lowKey->dt != index->keyType) || (highKey != NULL && highKey->dt != index->keyType)) {
+        return RC_RM_COMPARE_VALUE_OF_DIFFERENT_DATATYPE;
+    }
+    if (cond != NULL) {
+        if ((result = startScan(rel, scan, cond)) != RC_OK) {
+            return result;
+        }
+    } else {
+        if ((scan->mgmtData = calloc(1, sizeof(ScanManager))) == NULL) {
+            return RC_MEM_ALLOC_FAILED;
+        }
+        scan->rel = rel;
+    }
+
+    ScanManager *scanner = scan->mgmtData;
+    scanner->index = index;
+    scanner->lowKey.dt = scanner->highKey.dt = index->keyType;
+    scanner->lowKey.v.intV = lowKey != NULL ? lowKey->v.intV : INT_MIN;
+    scanner->highKey.v.intV = highKey != NULL ? highKey->v.intV : INT_MAX;
+    // Entries are fetched RM_INDEX_FETCH at a time
+    scanner->fetchIds = malloc(sizeof(RID) * RM_INDEX_FETCH);
+    scanner->fetched = malloc(sizeof(Record *) * RM_INDEX_FETCH);
+    for (int i = 0; i < RM_INDEX_FETCH; i++) {
+        createRecord(&scanner->fetched[i], rel->schema);
+    }
+    if ((result = openTreeScanFrom(index, &scanner->lowKey, &scanner->indexScan)) != RC_OK) {
+        scanner->indexScan = NULL;
+        closeScan(scan);
+    }
+    return result;
+}
+
+/*
+	- Function: getScanSchema
+	- Description: Returns the schema of the records next() returns: the table schema, or for a
+	  projected scan the schema of its compact records, owned by the scan.
+*/
+extern Schema *getScanSchema(RM_ScanHandle *scan) {
+    ScanManager *scanMgr = scan->mgmtData;
+    return scanMgr->projSchema != NULL ? scanMgr->projSchema : scan->rel->schema;
 }
 
 /*
@@ -518,88 +1220,490 @@ extern RC startScan(RM_TableData *rel, RM_ScanHandle *scan, Expr *cond) {
 */
 extern RC closeTable (RM_TableData *rel)
 {
-	RecordManager *recordManager = (*rel).mgmtData;
-	// Shutdown the buffer pool associated with the table
-	shutdownBufferPool(&recordManager->bufferPool);
+	RM_CatalogEntry *entry = findCatalogEntry(rel->name);
+	if (entry == NULL || entry->handle == NULL || entry->handle != rel->mgmtData) {
+		return RC_FILE_HANDLE_NOT_INIT;
+	}
+	rel->mgmtData = NULL;
+	// The last close shuts the buffer pool of the table down
+	if (--entry->openCount > 0) {
+		return RC_OK;
+	}
+	RecordManager *recordManager = entry->handle;
+	entry->handle = NULL;
+	closeZoneMap(&recordManager->zoneMap);
+	closeDictFile(&recordManager->dictFile, entry->schema);
+	RC result = shutdownBufferPool(&recordManager->bufferPool);
+	free(recordManager);
+	return result;
+}
 
-	return RC_OK;
+
+// Evaluates the scan condition on the attributes of a record, laid out as in Record->data after
+// its marker byte. Only the condition's attributes have to be there.
+static bool scanMatches(ScanManager *scanMgr, Schema *schema, char *attrs) {
+    if (scanMgr->program != NULL) {
+        return runExprProgram(scanMgr->program, attrs);
+    }
+    // evalExpr reads a Record: copy the attributes it decodes into the scan's own
+    char *data = scanMgr->condRecord->data + 1;
+    if (attrs != data) {
+        for (int i = 0; i < schema->numAttr; i++) {
+            if (scanMgr->condAttrs[i]) {
+                int offset = getAttrOffset(schema, i);
+                memcpy(data + offset, attrs + offset, getAttrSize(schema, i));
+            }
+        }
+    }
+    Value *result;
+    evalExpr(scanMgr->condRecord, schema, scanMgr->condition, &result);
+    bool match = result->v.boolV;
+    freeVal(result);
+    return match;
+}
+
+// Copies the projected attributes of a matching record into the output record
+static void projectRecord(ScanManager *scanMgr, Schema *schema, char *page, bool pax, int slot, char *attrs, char *out) {
+    if (scanMgr->projAttrs == NULL) {
+        if (pax) {
+            getPaxSlot(page, schema, slot, out, NULL);
+        } else {
+            memcpy(out, attrs, getRecordSize(schema));
+        }
+        return;
+    }
+    for (int i = 0; i < scanMgr->numProj; i++) {
+        int attrNum = scanMgr->projAttrs[i];
+        int size = getAttrSize(schema, attrNum);
+        char *value = pax ? getPaxColumn(page, schema, attrNum) + slot * size : attrs + scanMgr->projOffsets[i];
+        memcpy(out, value, size);
+        out += size;
+    }
 }
 
+// Reads the next RM_INDEX_FETCH entries of an index scan and fetches their records, page by page
+static int fetchIndexed(RM_ScanHandle *scan) {
+    ScanManager *scanMgr = scan->mgmtData;
+    Value key;
+    int n = 0;
+
+    while (!scanMgr->indexDone && n < RM_INDEX_FETCH) {
+        // The leaves are in key order, the first key past the range ends the scan
+        if (nextEntry(scanMgr->indexScan, &scanMgr->fetchIds[n]) != RC_OK ||
+            getScanKey(scanMgr->indexScan, &key) != RC_OK || key.v.intV > scanMgr->highKey.v.intV) {
+            scanMgr->indexDone = TRUE;
+            break;
+        }
+        n++;
+    }
+    if (n > 0) {
+        getRecords(scan->rel, scanMgr->fetchIds, n, scanMgr->fetched);
+    }
+    scanMgr->numFetched = n;
+    scanMgr->nextFetched = 0;
+    return n;
+}
+
+// next() of an index scan
+static RC nextIndexed(RM_ScanHandle *scan, Record *record) {
+    ScanManager *scanMgr = scan->mgmtData;
+    Schema *schema = scan->rel->schema;
+
+    while (scanMgr->nextFetched < scanMgr->numFetched || fetchIndexed(scan) > 0) {
+        Record *fetched = scanMgr->fetched[scanMgr->nextFetched++];
+        // Entries the table no longer has are skipped
+        if (fetched->id.page < 0) {
+            continue;
+        }
+        scanMgr->scanCount++;
+        if (scanMgr->condition == NULL || scanMatches(scanMgr, schema, fetched->data + 1)) {
+            record->id = fetched->id;
+            memcpy(record->data + 1, fetched->data + 1, getRecordSize(schema));
+            return RC_OK;
+        }
+    }
+
+    // Start over at lowKey, as a table scan starts over at its first page
+    scanMgr->indexDone = FALSE;
+    closeTreeScan(scanMgr->indexScan);
+    if (openTreeScanFrom(scanMgr->index, &scanMgr->lowKey, &scanMgr->indexScan) != RC_OK) {
+        scanMgr->indexScan = NULL;
+        scanMgr->index = NULL;
+    }
+    scanMgr->scanCount = 0;
+    return RC_RM_NO_MORE_TUPLES;
+}
 
 /*
 	- Function: next
-	- Description: Retrieves the next record in the scan result set.
+	- Description: Retrieves the next record in the scan result set. The condition is evaluated on
+	  the record in the page, and only a matching record is copied out.
 	- Parameters:
 		- scan: Pointer to RM_ScanHandle structure representing the scan.
-		- record: Pointer to Record structure where the retrieved record will be stored.
+		- record: Pointer to Record structure where the retrieved record will be stored, laid out
+		  by getScanSchema.
 	- Returns:
 		- RC_OK if the next record is successfully retrieved.
 */
 extern RC next(RM_ScanHandle *scan, Record *record) {
     RecordManager *tableManager = scan->rel->mgmtData;
-    RecordManager *scanMgr = scan->mgmtData;
+    ScanManager *scanMgr = scan->mgmtData;
+    if (scanMgr->index != NULL) {
+        return nextIndexed(scan, record);
+    }
 	if (!scanMgr->condition) {
         // Return error code if scan condition is not found
 		return RC_SCAN_CONDITION_NOT_FOUND;
     }
     Schema *schema = scan->rel->schema;
 
-    
+    char *data;
+    bool pax = tableManager->layout == RM_LAYOUT_PAX;
+
+    // Continue after the record returned last, one pinned page at a time
+    while ((scanMgr->recordID.page = nextDataPage(scanMgr->recordID.page)) < tableManager->numPages) {
+        // Skip pages whose zone map summary rules the condition out
+        if (scanMgr->recordID.slot == 0 &&
+            !zoneMayMatch(&tableManager->zoneMap, scanMgr->recordID.page, scanMgr->zonePreds, scanMgr->numZonePreds)) {
+            scanMgr->recordID.page++;
+            continue;
+        }
+        // A pool without a free frame fails the call, the scan resumes at this page next time
+        RC pinResult = pinPageSnapshot(&tableManager->bufferPool, &scanMgr->pageHandle, scanMgr->recordID.page);
+        if (pinResult != RC_OK) {
+            return pinResult;
+        }
+        char *page = scanMgr->pageHandle.data;
+        int numSlots = pax ? getPaxSlots(page) : getNumSlots(page);
+
+        while (scanMgr->recordID.slot < numSlots) {
+            int slot = scanMgr->recordID.slot++;
+            if (pax) {
+                // Skip free slots, and read only the minipages of the condition's attributes
+                data = scanMgr->condRecord->data + 1;
+                if (getPaxSlot(page, schema, slot, data, scanMgr->condAttrs) != RC_OK) {
+                    continue;
+                }
+            } else if ((data = getSlot(page, slot, NULL)) == NULL) {
+                // Skip tombstones
+                continue;
+            }
+            scanMgr->scanCount++;
+
+            if (scanMatches(scanMgr, schema, data)) {
+                record->id.page = scanMgr->recordID.page;
+                record->id.slot = slot;
+                // Mark the record as read
+                *record->data = '-';
+                projectRecord(scanMgr, schema, page, pax, slot, data, record->data + 1);
+                unpinPage(&tableManager->bufferPool, &scanMgr->pageHandle);
+                // Return success status
+                return RC_OK;
+            }
+        }
+        unpinPage(&tableManager->bufferPool, &scanMgr->pageHandle);
+        scanMgr->recordID.page++;
+        scanMgr->recordID.slot = 0;
+    }
+
+	scanMgr->recordID.slot = 0;
+	scanMgr->scanCount = 0;
+    scanMgr->recordID.page = 1;
 
-    Value *result = (Value *) malloc(sizeof(Value));
+    return RC_RM_NO_MORE_TUPLES;
+}
+
+
+// Attribute value in the format of Record->data for a batch vector, dictionary codes looked up.
+// NULL for a code the dictionary does not have, which setBatchValue stores as an empty string.
+static char *batchValue(Schema *schema, int attrNum, char *value) {
+    int codeBytes = schema->layout->codeBytes[attrNum];
+    if (codeBytes == 0) {
+        return value;
+    }
+    return (char *)getDictString(schema->layout->codecs[attrNum].dict, readDictCode(value, codeBytes));
+}
+
+// Copies the record of a slot into the next row of a batch, only the attributes set in attrs
+// unless it is NULL; false for a free slot
+static bool gatherBatchRow(RM_Batch *batch, Schema *schema, char *page, bool pax, int slot, bool *attrs) {
+    int row = batch->numRows;
     char *data;
 
-    int sizeOfRecord = getRecordSize(schema);
-    int totalSlots = PAGE_SIZE / sizeOfRecord;
-    if (!totalSlots) {
-        return RC_RM_NO_MORE_SLOTS;
+    if (pax) {
+        if (!isPaxSlotUsed(page, slot)) {
+            return FALSE;
+        }
+        // Value slot of every minipage
+        int capacity = getPaxSlots(page);
+        data = getPaxColumn(page, schema, 0);
+        for (int i = 0; i < schema->numAttr; i++) {
+            int size = getAttrSize(schema, i);
+            if (attrs == NULL || attrs[i]) {
+                setBatchValue(batch, row, i, batchValue(schema, i, data + slot * size));
+            }
+            data += capacity * size;
+        }
+        return TRUE;
+    }
+    if ((data = getSlot(page, slot, NULL)) == NULL) {
+        return FALSE;
     }
-    int scanCount = scanMgr->scanCount;
-    int tuplesCount = tableManager->tuplesCount;
+    for (int i = 0; i < schema->numAttr; i++) {
+        if (attrs == NULL || attrs[i]) {
+            setBatchValue(batch, row, i, batchValue(schema, i, data));
+        }
+        data += getAttrSize(schema, i);
+    }
+    return TRUE;
+}
 
-    if (!tuplesCount) {
-        return RC_RM_NO_MORE_TUPLES;
+/*
+	- Function: nextBatch
+	- Description: Retrieves the next rows of the scan as column vectors. Up to RM_BATCH_SIZE records
+	  are copied into the batch and the scan condition is evaluated over the whole batch at once,
+	  instead of once per record as in next().
+	- Parameters:
+		- scan: Pointer to RM_ScanHandle structure representing the scan.
+		- batch: A batch created by createBatch for the schema of the table. Its sel lists the
+		  matching rows, at least one. A projected scan leaves the vectors of the attributes
+		  neither projected nor read by the condition as they were.
+	- Returns:
+		- RC_OK if rows matched, RC_RM_NO_MORE_TUPLES once the table is exhausted.
+*/
+extern RC nextBatch(RM_ScanHandle *scan, RM_Batch *batch) {
+    RecordManager *tableManager = scan->rel->mgmtData;
+    ScanManager *scanMgr = scan->mgmtData;
+    if (!scanMgr->condition) {
+        // Return error code if scan condition is not found
+        return RC_SCAN_CONDITION_NOT_FOUND;
+    }
+    // Index scans return their records one by one
+    if (scanMgr->index != NULL) {
+        return RC_ERROR;
     }
+    Schema *schema = scan->rel->schema;
+    bool pax = tableManager->layout == RM_LAYOUT_PAX;
+
+    // Refill the batch until some of its rows match
+    RC pinResult = RC_OK;
+    do {
+        batch->numRows = 0;
+        while (batch->numRows < RM_BATCH_SIZE &&
+               (scanMgr->recordID.page = nextDataPage(scanMgr->recordID.page)) < tableManager->numPages) {
+            if (scanMgr->recordID.slot == 0 &&
+                !zoneMayMatch(&tableManager->zoneMap, scanMgr->recordID.page, scanMgr->zonePreds, scanMgr->numZonePreds)) {
+                scanMgr->recordID.page++;
+                continue;
+            }
+            // The rows gathered so far are returned first, the scan resumes at this page next time
+            if ((pinResult = pinPageSnapshot(&tableManager->bufferPool, &scanMgr->pageHandle, scanMgr->recordID.page)) != RC_OK) {
+                break;
+            }
+            char *page = scanMgr->pageHandle.data;
+            int numSlots = pax ? getPaxSlots(page) : getNumSlots(page);
+
+            while (scanMgr->recordID.slot < numSlots && batch->numRows < RM_BATCH_SIZE) {
+                int slot = scanMgr->recordID.slot++;
+                if (gatherBatchRow(batch, schema, page, pax, slot, scanMgr->batchAttrs)) {
+                    batch->ids[batch->numRows].page = scanMgr->recordID.page;
+                    batch->ids[batch->numRows].slot = slot;
+                    batch->numRows++;
+                    scanMgr->scanCount++;
+                }
+            }
+            unpinPage(&tableManager->bufferPool, &scanMgr->pageHandle);
+            // A full batch may stop in the middle of a page
+            if (scanMgr->recordID.slot >= numSlots) {
+                scanMgr->recordID.page++;
+                scanMgr->recordID.slot = 0;
+            }
+        }
 
-    while (scanCount < tuplesCount) {
-        (scanCount <= 0) ? (scanMgr->recordID.page = 1, scanMgr->recordID.slot = 0) : (++scanMgr->recordID.slot >= totalSlots ? (scanMgr->recordID.slot = 0, ++scanMgr->recordID.page) : 0);
+        if (batch->numRows == 0 && pinResult != RC_OK) {
+            batch->numSelected = 0;
+            return pinResult;
+        }
+        if (batch->numRows == 0) {
+            batch->numSelected = 0;
+            scanMgr->recordID.slot = 0;
+            scanMgr->scanCount = 0;
+            scanMgr->recordID.page = 1;
+            return RC_RM_NO_MORE_TUPLES;
+        }
+        RC result = selectBatch(batch, scanMgr->condition);
+        if (result != RC_OK) {
+            return result;
+        }
+    } while (batch->numSelected == 0);
 
-        pinPage(&tableManager->bufferPool, &scanMgr->pageHandle, scanMgr->recordID.page);
-        data = scanMgr->pageHandle.data;
-        data += (scanMgr->recordID.slot * sizeOfRecord);
-		 char *dataPointer = record->data;
+    return RC_OK;
+}
 
-        record->id.slot = scanMgr->recordID.slot;
-		        record->id.page = scanMgr->recordID.page;
 
-       
-		if (!dataPointer|| !record){
-            return RC_ERROR;
-        }
-        // Mark the record as read
-        *dataPointer = '-'; 
-		dataPointer++;
-        memcpy(dataPointer, data + 1, sizeOfRecord - 1);
+// State shared by the workers of a parallel scan
+typedef struct ParallelScan
+{
+    RM_TableData *rel;
+    Expr *cond;
+    RM_ZonePred zonePreds[ZONEMAP_MAX_PREDS];
+    int numZonePreds;
+    // first page of the next unclaimed morsel, claimed with an atomic add
+    int nextMorsel;
+    // the buffer manager is not thread safe: pins and unpins of the table and its zone map
+    // go through this lock, the records of a pinned page are read without it
+    pthread_mutex_t poolLock;
+    RM_BatchConsumer consumer;
+    void *ctx;
+    // first error of a worker, stops the others; written under poolLock, read without it
+    RC result;
+} ParallelScan;
+
+typedef struct ScanWorker
+{
+    ParallelScan *scan;
+    int id;
+    pthread_t thread;
+} ScanWorker;
+
+static void failParallelScan(ParallelScan *ps, RC rc) {
+    pthread_mutex_lock(&ps->poolLock);
+    if (ps->result == RC_OK) {
+        __atomic_store_n(&ps->result, rc, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&ps->poolLock);
+}
 
-        scanMgr->scanCount++;
+// Evaluates the condition over the rows gathered by a worker and hands the matches over
+static void flushWorkerBatch(ScanWorker *worker, RM_Batch *batch) {
+    ParallelScan *ps = worker->scan;
+    if (batch->numRows == 0) {
+        return;
+    }
+    RC rc = selectBatch(batch, ps->cond);
+    if (rc != RC_OK) {
+        failParallelScan(ps, rc);
+    } else if (batch->numSelected > 0) {
+        ps->consumer(batch, worker->id, ps->ctx);
+    }
+    batch->numRows = 0;
+}
 
-        evalExpr(record, schema, scanMgr->condition, &result);
-		scanCount++;
+// Claims morsels of RM_MORSEL_PAGES pages until the table is exhausted
+static void *parallelScanWorker(void *arg) {
+    ScanWorker *worker = arg;
+    ParallelScan *ps = worker->scan;
+    RecordManager *tableManager = ps->rel->mgmtData;
+    Schema *schema = ps->rel->schema;
+    bool pax = tableManager->layout == RM_LAYOUT_PAX;
+    BM_PageHandle page;
+    RM_Batch *batch;
+    int first;
+
+    if (createBatch(&batch, schema) != RC_OK) {
+        failParallelScan(ps, RC_MEM_ALLOC_FAILED);
+        return NULL;
+    }
+    batch->numRows = 0;
+    while (__atomic_load_n(&ps->result, __ATOMIC_RELAXED) == RC_OK &&
+           (first = __atomic_fetch_add(&ps->nextMorsel, RM_MORSEL_PAGES, __ATOMIC_RELAXED)) < tableManager->numPages) {
+        int last = first + RM_MORSEL_PAGES < tableManager->numPages ? first + RM_MORSEL_PAGES : tableManager->numPages;
+        for (int pageNum = nextDataPage(first); pageNum < last; pageNum = nextDataPage(pageNum + 1)) {
+            pthread_mutex_lock(&ps->poolLock);
+            bool skip = !zoneMayMatch(&tableManager->zoneMap, pageNum, ps->zonePreds, ps->numZonePreds);
+            RC rc = skip ? RC_OK : pinPageSnapshot(&tableManager->bufferPool, &page, pageNum);
+            pthread_mutex_unlock(&ps->poolLock);
+            if (skip) {
+                continue;
+            }
+            if (rc != RC_OK) {
+                failParallelScan(ps, rc);
+                break;
+            }
 
-        if (result->v.boolV) {
-            unpinPage(&tableManager->bufferPool, &scanMgr->pageHandle);
-            // Return success status
-			return RC_OK;
+            int numSlots = pax ? getPaxSlots(page.data) : getNumSlots(page.data);
+            for (int slot = 0; slot < numSlots; slot++) {
+                if (gatherBatchRow(batch, schema, page.data, pax, slot, NULL)) {
+                    batch->ids[batch->numRows].page = pageNum;
+                    batch->ids[batch->numRows].slot = slot;
+                    if (++batch->numRows == RM_BATCH_SIZE) {
+                        flushWorkerBatch(worker, batch);
+                    }
+                }
+            }
+            pthread_mutex_lock(&ps->poolLock);
+            unpinPage(&tableManager->bufferPool, &page);
+            pthread_mutex_unlock(&ps->poolLock);
         }
     }
+    flushWorkerBatch(worker, batch);
+    freeBatch(batch);
+    return NULL;
+}
 
-    unpinPage(&tableManager->bufferPool, &scanMgr->pageHandle);
-	scanMgr->freePage = 0;
-	scanMgr->recordID.slot = 0;
-	scanMgr->scanCount = 0;
-    scanMgr->recordID.page = 1;
+/*
+	- Function: parallelScan
+	- Description: Scans a table with several threads. The data pages are split into morsels of
+	  RM_MORSEL_PAGES pages that the workers claim one after the other, so a worker that is done
+	  early takes over more of the table. Each worker pins its own pages, gathers their records
+	  into its own batch and evaluates the condition over it as nextBatch does; batches with
+	  matching rows are passed to consumer. The order of the batches is not defined.
+	- Parameters:
+		- rel: Pointer to RM_TableData structure representing the table to be scanned.
+		- cond: The scan condition.
+		- numThreads: Number of workers, 0 for one per online CPU; at most RM_SCAN_MAX_THREADS.
+		- consumer: Called for each batch with matches, from the worker threads.
+		- ctx: Passed on to consumer.
+	- Returns:
+		- RC_OK once every page has been scanned, or the first error of a worker.
+*/
+extern RC parallelScan(RM_TableData *rel, Expr *cond, int numThreads, RM_BatchConsumer consumer, void *ctx) {
+    RecordManager *tableManager = rel->mgmtData;
+    if (cond == NULL) {
+        return RC_SCAN_CONDITION_NOT_FOUND;
+    }
+    if (numThreads <= 0) {
+        numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (numThreads < 1) {
+        numThreads = 1;
+    } else if (numThreads > RM_SCAN_MAX_THREADS) {
+        numThreads = RM_SCAN_MAX_THREADS;
+    }
 
-    return RC_RM_NO_MORE_TUPLES;
+    ParallelScan ps;
+    ps.rel = rel;
+    ps.cond = cond;
+    ps.numZonePreds = getZonePreds(&tableManager->zoneMap, cond, ps.zonePreds, ZONEMAP_MAX_PREDS);
+    ps.nextMorsel = 1;
+    ps.consumer = consumer;
+    ps.ctx = ctx;
+    ps.result = RC_OK;
+    pthread_mutex_init(&ps.poolLock, NULL);
+    // Detect the SIMD level before the workers race for it
+    getSimdLevel();
+
+    ScanWorker workers[RM_SCAN_MAX_THREADS];
+    int started = 0;
+    for (int i = 0; i < numThreads; i++) {
+        workers[i].scan = &ps;
+        workers[i].id = i;
+        if (pthread_create(&workers[i].thread, NULL, parallelScanWorker, &workers[i]) != 0) {
+            break;
+        }
+        started++;
+    }
+    // Without threads the calling one scans the table alone
+    if (started == 0) {
+        workers[0].scan = &ps;
+        workers[0].id = 0;
+        parallelScanWorker(&workers[0]);
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+    pthread_mutex_destroy(&ps.poolLock);
+    return ps.result;
 }
 
 
@@ -619,12 +1723,10 @@ extern RC closeScan(RM_ScanHandle *scan) {
     }
     
    
-    RecordManager *scanManager = scan->mgmtData;
-    RecordManager *recordManager = scan->rel->mgmtData;
+    ScanManager *scanManager = scan->mgmtData;
 
-    // If scan has been started
+    // If scan has been started; next() holds no pin between calls
     if (scanManager->scanCount > 0) {
-        unpinPage(&recordManager->bufferPool, &scanManager->pageHandle);
 		if(!scanManager){
 			return RC_ERROR;
 
@@ -638,6 +1740,32 @@ extern RC closeScan(RM_ScanHandle *scan) {
 	}
     
     // Free memory allocated for scan management data
+    free(scanManager->condAttrs);
+    // freeRecord leaves the data of the record alone
+    if (scanManager->condRecord != NULL) {
+        free(scanManager->condRecord->data);
+        freeRecord(scanManager->condRecord);
+    }
+    if (scanManager->indexScan != NULL) {
+        closeTreeScan(scanManager->indexScan);
+    }
+    if (scanManager->fetched != NULL) {
+        for (int i = 0; i < RM_INDEX_FETCH; i++) {
+            free(scanManager->fetched[i]->data);
+            freeRecord(scanManager->fetched[i]);
+        }
+        free(scanManager->fetched);
+    }
+    free(scanManager->fetchIds);
+    if (scanManager->projSchema != NULL) {
+        freeProjectedSchema(scanManager->projSchema);
+    }
+    free(scanManager->projAttrs);
+    free(scanManager->projOffsets);
+    free(scanManager->batchAttrs);
+    if (scanManager->program != NULL) {
+        freeExprProgram(scanManager->program);
+    }
     free(scan->mgmtData);
     scan->mgmtData = NULL;
 
@@ -653,30 +1781,150 @@ extern RC closeScan(RM_ScanHandle *scan) {
 		- The size of the record.
 */
 extern int getRecordSize(Schema *schema) {
-    int length = 0;
+    return schema->layout->recordSize;
+}
 
-    
+/*
+	- Function: getAttrSize
+	- Description: Computes the number of bytes one value of an attribute takes in a record.
+	- Parameters:
+		- schema: Pointer to Schema structure representing the schema of the record.
+		- attrNum: Index of the attribute.
+	- Returns:
+		- The size of the attribute.
+*/
+extern int getAttrSize(Schema *schema, int attrNum) {
+    return schema->layout->sizes[attrNum];
+}
+
+/*
+	- Function: getAttrOffset
+	- Description: Returns where an attribute starts in a record, counted from the first attribute
+	  (Record->data + 1).
+*/
+extern int getAttrOffset(Schema *schema, int attrNum) {
+    return schema->layout->offsets[attrNum];
+}
+
+// Bytes of an attribute stored as is
+static int typeSize(DataType dt, int typeLength) {
+    switch (dt) {
+        case DT_STRING:
+            return typeLength;
+        case DT_INT:
+            return sizeof(int);
+        case DT_FLOAT:
+            return sizeof(float);
+        case DT_BOOL:
+            return sizeof(bool);
+        default:
+            return 0;
+    }
+}
+
+// Sizes, offsets and codecs of the attributes, from their data types and dictionary codes
+static void computeSchemaLayout(Schema *schema) {
+    SchemaLayout *layout = schema->layout;
+    layout->recordSize = 0;
+    layout->allInts = TRUE;
     for (int i = 0; i < schema->numAttr; i++) {
-        
-        switch (schema->dataTypes[i]) {
-            case DT_STRING:
-                length += schema->typeLength[i];
-                break;
-            case DT_INT:
-                length += sizeof(int);
-                break;
-            case DT_FLOAT:
-                length += sizeof(float);
-                break;
-            case DT_BOOL:
-                length += sizeof(bool);
-                break;
-            default:
-                
-                break;
+        if (layout->codeBytes[i] > 0) {
+            // A dictionary already handed to the codec stays
+            RM_Dictionary *dict = layout->codecs[i].dict;
+            layout->codecs[i] = getDictCodec();
+            layout->codecs[i].dict = dict;
+            layout->sizes[i] = layout->codeBytes[i];
+        } else {
+            layout->codecs[i] = getAttrCodec(schema->dataTypes[i]);
+            layout->sizes[i] = typeSize(schema->dataTypes[i], schema->typeLength[i]);
+        }
+        if (schema->dataTypes[i] != DT_INT) {
+            layout->allInts = FALSE;
         }
+        layout->offsets[i] = layout->recordSize;
+        layout->recordSize += layout->sizes[i];
+    }
+}
+
+/*
+	- Function: initSchemaLayout
+	- Description: Computes the layout descriptor of a schema, so that record sizes and attribute
+	  offsets are looked up instead of summed over the attributes on every access. Every function
+	  creating a Schema calls it, freeSchemaLayout releases it.
+	- Parameters:
+		- schema: A schema whose attributes are set.
+	- Returns:
+		- RC_OK if the layout is computed.
+*/
+extern RC initSchemaLayout(Schema *schema) {
+    SchemaLayout *layout = malloc(sizeof(SchemaLayout));
+    if (layout == NULL) {
+        return RC_MEM_ALLOC_FAILED;
+    }
+    int numAttr = schema->numAttr > 0 ? schema->numAttr : 1;
+    layout->offsets = malloc(sizeof(int) * numAttr);
+    layout->sizes = malloc(sizeof(int) * numAttr);
+    layout->codecs = calloc(numAttr, sizeof(RM_AttrCodec));
+    layout->codeBytes = calloc(numAttr, sizeof(int));
+    if (layout->offsets == NULL || layout->sizes == NULL || layout->codecs == NULL || layout->codeBytes == NULL) {
+        free(layout->offsets);
+        free(layout->sizes);
+        free(layout->codecs);
+        free(layout->codeBytes);
+        free(layout);
+        return RC_MEM_ALLOC_FAILED;
+    }
+    schema->layout = layout;
+    computeSchemaLayout(schema);
+    return RC_OK;
+}
+
+/*
+	- Function: setDictionaryEncoding
+	- Description: Stores a DT_STRING attribute as a code into a dictionary of its distinct values
+	  instead of at its full length. It has to be set on the schema given to createTable; the
+	  records of the table are then built with the schema openTable returns, whose codec maps the
+	  strings to codes. Equality conditions on the attribute compare codes.
+	- Parameters:
+		- schema: A schema not yet used by a table.
+		- attrNum: The attribute to encode.
+		- codeBytes: 1, 2 or 4, for up to 256, 65536 or INT_MAX distinct values; 0 stores the
+		  attribute as is again.
+	- Returns:
+		- RC_OK if the layout of the schema is changed.
+*/
+extern RC setDictionaryEncoding(Schema *schema, int attrNum, int codeBytes) {
+    if (attrNum < 0 || attrNum >= schema->numAttr) {
+        return RC_IMPOSSIBLE_VALUE;
+    }
+    if (schema->dataTypes[attrNum] != DT_STRING) {
+        return RC_RM_UNKOWN_DATATYPE;
+    }
+    if (codeBytes != 0 && codeBytes != 1 && codeBytes != 2 && codeBytes != 4) {
+        return RC_IMPOSSIBLE_VALUE;
+    }
+    // An entry has to fit on a dictionary page
+    if (codeBytes > 0 && (schema->typeLength[attrNum] < 1 || schema->typeLength[attrNum] > (int)(PAGE_SIZE - DICT_PAGE_HEADER))) {
+        return RC_RM_LIMIT_EXCEEDED;
+    }
+    schema->layout->codeBytes[attrNum] = codeBytes;
+    computeSchemaLayout(schema);
+    return RC_OK;
+}
+
+/*
+	- Function: freeSchemaLayout
+	- Description: Frees the layout descriptor of a schema.
+*/
+extern void freeSchemaLayout(Schema *schema) {
+    if (schema->layout != NULL) {
+        free(schema->layout->offsets);
+        free(schema->layout->sizes);
+        free(schema->layout->codecs);
+        free(schema->layout->codeBytes);
+        free(schema->layout);
+        schema->layout = NULL;
     }
-    return length;
 }
 
 
@@ -730,6 +1978,14 @@ extern Schema *createSchema(int numAttr, char **attrNames, DataType *dataTypes,
     tempSchema->typeLength = typeLength;
     tempSchema->keySize = keySize;
     tempSchema->keyAttrs = keys;
+    if (initSchemaLayout(tempSchema) != RC_OK) {
+        for (j = 0; j < numAttr; j++) {
+            free(tempSchema->attrNames[j]);
+        }
+        free(tempSchema->attrNames);
+        free(tempSchema);
+        return NULL;
+    }
 
     return tempSchema;
 }
@@ -745,6 +2001,7 @@ extern Schema *createSchema(int numAttr, char **attrNames, DataType *dataTypes,
 */
 extern RC freeSchema (Schema *schema)
 {
+	freeSchemaLayout(schema);
 	// Free memory allocated for the schema structure
 	free(schema);
 	// Return success status
@@ -765,7 +2022,8 @@ extern RC createRecord(Record **record, Schema *schema) {
     int sizeOfRecord = getRecordSize(schema);
 	// Allocate memory for the new record
     Record *newRecord = (Record*) malloc(sizeof(Record));
-    newRecord->data = (char*) malloc(sizeOfRecord);
+    // One byte for the read marker in front of the attributes
+    newRecord->data = (char*) malloc(sizeOfRecord + 1);
     newRecord->id.page = newRecord->id.slot = -1;
 
     // Mark the record as not read
@@ -780,53 +2038,6 @@ extern RC createRecord(Record **record, Schema *schema) {
     return RC_OK;
 }
 
-/*
-	- Function: attrOffset
-	- Description: Sets the offset from the initial position to the specified attribute of the record into the 'result' parameter.
-	- Parameters:
-		- schema: Pointer to Schema structure representing the schema of the record.
-		- attrNum: Number of attributes.
-		- result: Pointer to an integer where the offset value will be stored.
-	- Returns:
-		- RC_OK if the offset is successfully calculated.
-*/
-RC attrOffset(Schema *schema, int attrNum, int *result) {
-	    *result = 1;
-
-    int i = 0;
-    // Iterate through the attributes
-    while (i < attrNum) {
-        switch (schema->dataTypes[i]) {
-            case DT_STRING: {
-                // Increment the offset by the length of the string attribute
-                *result += schema->typeLength[i];
-                break;
-            }
-            case DT_INT: {
-                // Increment the offset by the size of an integer
-                *result += sizeof(int);
-                break;
-            }
-            case DT_FLOAT: {
-                // Increment the offset by the size of a float
-                *result += sizeof(float);
-                break;
-            }
-            case DT_BOOL: {
-                // Increment the offset by the size of a boolean
-                *result += sizeof(bool);
-                break;
-            }
-            default: {
-				// Handle unknown data types
-                break;
-            }
-        }
-        i++;
-    }
-    return RC_OK;
-}
-
 /*
 	- Function: getAttr
 	- Description: Retrieves the value of a specified attribute from the record and stores it in the provided Value structure.
@@ -839,67 +2050,15 @@ RC attrOffset(Schema *schema, int attrNum, int *result) {
 		- RC_OK if the attribute value is successfully retrieved.
 */
 extern RC getAttr(Record *record, Schema *schema, int attrNum, Value **value) {
-    // Variable to store the offset of the attribute within the record data
-	int varOffset = 0;
     Value *attr = malloc(sizeof(Value));
-
-    
-    char *PointerOfData;
-    PointerOfData = record->data;
-	// Calculate the offset of the attribute
-    attrOffset(schema, attrNum, &varOffset);
-
-
-    
-    PointerOfData += varOffset;
-
-    if (attrNum == 1) {
-        schema->dataTypes[attrNum] = 1;
-    }
-
-    // Retrieve the value based on the attribute's data type
-    switch (schema->dataTypes[attrNum]) {
-        case DT_STRING: {
-            
-            int len = schema->typeLength[attrNum];
-            attr->v.stringV = (char *) malloc(len + 1);
-			if(!len){
-				return RC_ERROR;
-			}
-            
-            memcpy(attr->v.stringV, PointerOfData, len);
-            attr->v.stringV[len] = '\0';
-            attr->dt = DT_STRING;
-            break;
-        }
-        case DT_INT: {
-            
-            int val = 0;
-            memcpy(&val, PointerOfData, sizeof(int));
-            attr->v.intV = val;
-            attr->dt = DT_INT;
-            break;
-        }
-        case DT_FLOAT: {
-           
-            float val;
-            memcpy(&val, PointerOfData, sizeof(float));
-            attr->v.floatV = val;
-            attr->dt = DT_FLOAT;
-            break;
-        }
-        case DT_BOOL: {
-            
-            bool val;
-            memcpy(&val, PointerOfData, sizeof(bool));
-            attr->v.boolV = val;
-            attr->dt = DT_BOOL;
-            break;
-        }
-        default: {
-            printf("For the given data type no serializer\n");
-            break;
-        }
+    SchemaLayout *layout = schema->layout;
+
+    // The attributes start after the marker byte
+    RM_AttrCodec *codec = &layout->codecs[attrNum];
+    RC rc = codec->decode(record->data + 1 + layout->offsets[attrNum], layout->sizes[attrNum], codec->dict, attr);
+    if (rc != RC_OK) {
+        free(attr);
+        return rc;
     }
 
     *value = attr;
@@ -919,47 +2078,137 @@ extern RC getAttr(Record *record, Schema *schema, int attrNum, Value **value) {
 		- RC_OK if the attribute value is successfully set.
 */
 extern RC setAttr(Record *record, Schema *schema, int attrNum, Value *value) {
-    int varOffset = 0;
-
-	// Pointer to the beginning of the record data
-    char *pointerOfData = record->data;
-	 // Calculate the offset of the attribute within the record data
-    attrOffset(schema, attrNum, &varOffset);
-	// Move the pointer to the attribute's position within the record data
-    pointerOfData += varOffset;
-	// Set the value of the attribute based on its data type
-    switch (schema->dataTypes[attrNum]) {
-        case DT_STRING: {
-			// Set string value
-            int len = schema->typeLength[attrNum];
-            strncpy(pointerOfData, value->v.stringV, len);
-            pointerOfData += len;
-            break;
-        }
-        case DT_INT: {
-			// Set integer value
-            *(int *)pointerOfData = value->v.intV;
-            pointerOfData += sizeof(int);
-            break;
+    SchemaLayout *layout = schema->layout;
+    RM_AttrCodec *codec = &layout->codecs[attrNum];
+
+	// The attributes start after the marker byte
+    return codec->encode(record->data + 1 + layout->offsets[attrNum], layout->sizes[attrNum], codec->dict, value);
+}
+
+/*
+	- Function: getAttrs
+	- Description: Reads all attributes of a record at once. The codecs of the schema layout decode
+	  them in one pass; a schema of DT_INT attributes only is copied out as an int array.
+	- Parameters:
+		- record: Pointer to Record structure representing the record to read.
+		- schema: Pointer to Schema structure representing the schema of the record.
+		- values: Array of schema->numAttr values receiving the attributes. String values are
+		  allocated and have to be freed by the caller.
+	- Returns:
+		- RC_OK if all attributes are read.
+*/
+extern RC getAttrs(Record *record, Schema *schema, Value *values) {
+    SchemaLayout *layout = schema->layout;
+    char *data = record->data + 1;
+
+    if (layout->allInts) {
+        int ints[schema->numAttr > 0 ? schema->numAttr : 1];
+        memcpy(ints, data, layout->recordSize);
+        for (int i = 0; i < schema->numAttr; i++) {
+            values[i].dt = DT_INT;
+            values[i].v.intV = ints[i];
         }
-        case DT_FLOAT: {
-			// Set float value
-            *(float *)pointerOfData = value->v.floatV;
-            pointerOfData += sizeof(float);
-            break;
+        return RC_OK;
+    }
+    for (int i = 0; i < schema->numAttr; i++) {
+        RM_AttrCodec *codec = &layout->codecs[i];
+        RC rc = codec->decode(data + layout->offsets[i], layout->sizes[i], codec->dict, &values[i]);
+        if (rc != RC_OK) {
+            // Do not hand out the strings read so far
+            for (int j = 0; j < i; j++) {
+                if (values[j].dt == DT_STRING) {
+                    free(values[j].v.stringV);
+                }
+            }
+            return rc;
         }
-        case DT_BOOL: {
-			// Set boolean value
-            *(bool *)pointerOfData = value->v.boolV;
-            pointerOfData += sizeof(bool);
-            break;
+    }
+    return RC_OK;
+}
+
+/*
+	- Function: setAttrs
+	- Description: Writes all attributes of a record at once, the bulk form of setAttr.
+	- Parameters:
+		- record: Pointer to Record structure representing the record to write.
+		- schema: Pointer to Schema structure representing the schema of the record.
+		- values: Array of schema->numAttr values, one per attribute.
+	- Returns:
+		- RC_OK if all attributes are written.
+*/
+extern RC setAttrs(Record *record, Schema *schema, Value *values) {
+    SchemaLayout *layout = schema->layout;
+    char *data = record->data + 1;
+
+    if (layout->allInts) {
+        int ints[schema->numAttr > 0 ? schema->numAttr : 1];
+        for (int i = 0; i < schema->numAttr; i++) {
+            ints[i] = values[i].v.intV;
         }
-        default: {
-            printf("No Serializer for the defined data type.\n");
-            break;
+        memcpy(data, ints, layout->recordSize);
+        return RC_OK;
+    }
+    for (int i = 0; i < schema->numAttr; i++) {
+        RM_AttrCodec *codec = &layout->codecs[i];
+        RC rc = codec->encode(data + layout->offsets[i], layout->sizes[i], codec->dict, &values[i]);
+        if (rc != RC_OK) {
+            return rc;
         }
     }
+    return RC_OK;
+}
 
+/*
+	- Function: getAttrRef
+	- Description: Reads an attribute of a record looked up with getRecordRef, without allocating.
+	  Numbers and booleans are copied into the view, strings are left in the page.
+	- Parameters:
+		- ref: The record.
+		- attrNum: The attribute to read.
+		- attr: Receives the typed view.
+	- Returns:
+		- RC_OK if the attribute is read.
+*/
+extern RC getAttrRef(RecordRef *ref, int attrNum, AttrRef *attr) {
+    Schema *schema = ref->rel->schema;
+    if (attrNum < 0 || attrNum >= schema->numAttr) {
+        return RC_IMPOSSIBLE_VALUE;
+    }
+    int size = getAttrSize(schema, attrNum);
+    const char *value;
+    if (ref->data == NULL) {
+        value = getPaxColumn(ref->pageHandle.data, schema, attrNum) + ref->id.slot * size;
+    } else {
+        value = ref->data + getAttrOffset(schema, attrNum);
+    }
+
+    attr->dt = schema->dataTypes[attrNum];
+    attr->length = size;
+    switch (attr->dt) {
+        case DT_INT:
+            memcpy(&attr->v.intV, value, sizeof(int));
+            break;
+        case DT_FLOAT:
+            memcpy(&attr->v.floatV, value, sizeof(float));
+            break;
+        case DT_BOOL:
+            memcpy(&attr->v.boolV, value, sizeof(bool));
+            break;
+        case DT_STRING:
+            if (schema->layout->codeBytes[attrNum] == 0) {
+                attr->v.stringV = value;
+                break;
+            }
+            // A dictionary encoded string is read from the table's dictionary
+            attr->length = schema->typeLength[attrNum];
+            attr->v.stringV = getDictString(schema->layout->codecs[attrNum].dict, readDictCode(value, size));
+            if (attr->v.stringV == NULL) {
+                return RC_ERROR;
+            }
+            break;
+        default:
+            return RC_RM_UNKOWN_DATATYPE;
+    }
     return RC_OK;
 }
 
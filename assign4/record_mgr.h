@@ -5,6 +5,11 @@
 #include "expr.h"
 #include "tables.h"
 #include "buffer_mgr.h"
+#include "rm_batch.h"
+#include "rm_zonemap.h"
+#include "btree_mgr.h"
+#include "rm_index.h"
+#include "rm_dict.h"
 
 // Bookkeeping for scans
 typedef struct RM_ScanHandle
@@ -13,49 +18,151 @@ typedef struct RM_ScanHandle
 	void *mgmtData;
 } RM_ScanHandle;
 
-// Custom data structure to define the Record Manager.
+// How the records of a table are laid out in its data pages
+typedef enum RM_PageLayout {
+	RM_LAYOUT_ROW = 0, // slotted pages of whole records (rm_page.c)
+	RM_LAYOUT_PAX = 1  // one minipage per attribute (rm_pax.c)
+} RM_PageLayout;
+
+// Custom data structure to define the Record Manager, one per open table.
 typedef struct RecordManager
 {
 	// PageHandle for using Buffer Manager to access the page files
 	BM_PageHandle pageHandle;
 	// Buffer Pool	
 	BM_BufferPool bufferPool;
-	// Record ID	
-	RID recordID;
-	// condition for scanning the records in the table
-	Expr *condition;
 	// total no of tuples in the table
 	int tuplesCount;
 	// stores the location of first free page which has empty slots in table
 	int freePage;
+	// number of pages of the table file, header page included
+	int numPages;
+	// layout of the data pages, chosen at createTable
+	RM_PageLayout layout;
+	// min/max summaries of the data pages
+	RM_ZoneMap zoneMap;
+	// dictionaries of the dictionary encoded attributes
+	RM_DictFile dictFile;
+	// B+ trees maintained by the DML functions
+	RM_TableIndex indexes[RM_MAX_INDEXES];
+	int numIndexes;
+} RecordManager;
+
+// Custom data structure to keep the state of a scan
+typedef struct ScanManager
+{
+	// PageHandle of the page being scanned
+	BM_PageHandle pageHandle;
+	// Record ID of the next record to examine
+	RID recordID;
+	// condition for scanning the records in the table
+	Expr *condition;
 	// This variable stores the count of the no of records scanned
 	int scanCount;
-} RecordManager;
+	// attributes read by the condition, only these are gathered from PAX pages before it is evaluated
+	bool *condAttrs;
+	// condition compiled by startScan, NULL if it has to be interpreted with evalExpr
+	ExprProgram *program;
+	// range tests of the condition checked against the zone map before a page is pinned
+	RM_ZonePred zonePreds[ZONEMAP_MAX_PREDS];
+	int numZonePreds;
+	// attributes next() copies into its output record, in this order; NULL for all of them
+	int numProj;
+	int *projAttrs;
+	int *projOffsets;    // their byte offsets in a full record
+	Schema *projSchema;  // schema of the compact output record
+	// attributes nextBatch() fills in: the condition's and the projected ones, NULL for all
+	bool *batchAttrs;
+	// full record the interpreted condition is evaluated on
+	Record *condRecord;
+	// B+ tree walked by an index scan, NULL for a scan of the data pages
+	BTreeHandle *index;
+	BT_ScanHandle *indexScan;
+	// key range of an index scan, bounds included
+	Value lowKey;
+	Value highKey;
+	// records of the next RM_INDEX_FETCH entries of an index scan, fetched with getRecords
+	RID *fetchIds;
+	Record **fetched;
+	int numFetched;
+	int nextFetched;
+	// set once the tree has no more entries in the key range
+	bool indexDone;
+} ScanManager;
+
+// Read-only view of a record in its pinned page, filled by getRecordRef and valid until
+// releaseRecordRef. Writers pinning the page meanwhile work on a copy of it.
+typedef struct RecordRef
+{
+	RID id;
+	RM_TableData *rel;
+	BM_PageHandle pageHandle;
+	// attributes laid out as in Record->data after the marker byte, NULL on PAX pages where
+	// they are spread over the minipages; getAttrRef reads both
+	const char *data;
+} RecordRef;
+
+// Typed view of one attribute of a RecordRef. Strings are not NUL terminated: stringV points
+// at length bytes inside the page, or inside the dictionary of a dictionary encoded attribute.
+typedef struct AttrRef
+{
+	DataType dt;
+	int length;
+	union {
+		int intV;
+		float floatV;
+		bool boolV;
+		const char *stringV;
+	} v;
+} AttrRef;
+
 
 
+// Receives the batches of a parallel scan that have matching rows (listed in batch->sel). It is
+// called from the worker threads, concurrently; worker tells which one, from 0.
+typedef void (*RM_BatchConsumer) (RM_Batch *batch, int worker, void *ctx);
 
 // table and manager
 extern RC initRecordManager (void *mgmtData);
 extern RC shutdownRecordManager ();
 extern RC createTable (char *name, Schema *schema);
+extern RC createTableWithLayout (char *name, Schema *schema, RM_PageLayout layout);
+extern RC createCompressedTable (char *name, Schema *schema, RM_PageLayout layout);
 extern RC openTable (RM_TableData *rel, char *name);
 extern RC closeTable (RM_TableData *rel);
 extern RC deleteTable (char *name);
 extern int getNumTuples (RM_TableData *rel);
+extern RC attachIndex (RM_TableData *rel, int attrNum, BTreeHandle *tree);
+extern RC detachIndex (RM_TableData *rel, int attrNum);
 
 // handling records in a table
 extern RC insertRecord (RM_TableData *rel, Record *record);
+extern RC insertRecords (RM_TableData *rel, Record **records, int n, RID *outIds);
 extern RC deleteRecord (RM_TableData *rel, RID id);
 extern RC updateRecord (RM_TableData *rel, Record *record);
+extern RC vacuumTable (RM_TableData *rel);
 extern RC getRecord (RM_TableData *rel, RID id, Record *record);
+extern RC getRecords (RM_TableData *rel, RID *ids, int n, Record **out);
+extern RC getRecordRef (RM_TableData *rel, RID id, RecordRef *ref);
+extern RC releaseRecordRef (RecordRef *ref);
 
 // scans
 extern RC startScan (RM_TableData *rel, RM_ScanHandle *scan, Expr *cond);
+extern RC startProjectedScan (RM_TableData *rel, RM_ScanHandle *scan, Expr *cond, int numAttrs, int *attrNums);
+extern RC startIndexScan (RM_TableData *rel, RM_ScanHandle *scan, BTreeHandle *index, Value *lowKey, Value *highKey, Expr *cond);
+extern Schema *getScanSchema (RM_ScanHandle *scan);
 extern RC next (RM_ScanHandle *scan, Record *record);
+extern RC nextBatch (RM_ScanHandle *scan, RM_Batch *batch);
+extern RC parallelScan (RM_TableData *rel, Expr *cond, int numThreads, RM_BatchConsumer consumer, void *ctx);
 extern RC closeScan (RM_ScanHandle *scan);
 
 // dealing with schemas
 extern int getRecordSize (Schema *schema);
+extern int getAttrSize (Schema *schema, int attrNum);
+extern int getAttrOffset (Schema *schema, int attrNum);
+extern RC initSchemaLayout (Schema *schema);
+extern RC setDictionaryEncoding (Schema *schema, int attrNum, int codeBytes);
+extern void freeSchemaLayout (Schema *schema);
 extern Schema *createSchema (int numAttr, char **attrNames, DataType *dataTypes, int *typeLength, int keySize, int *keys);
 extern RC freeSchema (Schema *schema);
 
@@ -64,5 +171,8 @@ extern RC createRecord (Record **record, Schema *schema);
 extern RC freeRecord (Record *record);
 extern RC getAttr (Record *record, Schema *schema, int attrNum, Value **value);
 extern RC setAttr (Record *record, Schema *schema, int attrNum, Value *value);
+extern RC getAttrs (Record *record, Schema *schema, Value *values);
+extern RC setAttrs (Record *record, Schema *schema, Value *values);
+extern RC getAttrRef (RecordRef *ref, int attrNum, AttrRef *attr);
 
 #endif // RECORD_MGR_H
@@ -0,0 +1,300 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dberror.h"
+#include "record_mgr.h"
+#include "rm_batch.h"
+#include "rm_simd.h"
+
+/*
+	- Function: createBatch
+	- Description: Allocates a batch with room for RM_BATCH_SIZE rows of the schema. The batch is
+	  reused by every nextBatch call on scans of tables with that schema.
+	- Parameters:
+		- batch: Receives the new batch.
+		- schema: The schema of the rows.
+	- Returns:
+		- RC_OK, or RC_MEM_ALLOC_FAILED.
+*/
+RC createBatch(RM_Batch **batch, Schema *schema)
+{
+	RM_Batch *newBatch = calloc(1, sizeof(RM_Batch));
+	if (newBatch == NULL) {
+		return RC_MEM_ALLOC_FAILED;
+	}
+	newBatch->schema = schema;
+	newBatch->ids = malloc(RM_BATCH_SIZE * sizeof(RID));
+	newBatch->sel = malloc(RM_BATCH_SIZE * sizeof(int));
+	newBatch->columns = calloc(schema->numAttr, sizeof(RM_Vector));
+	if (newBatch->ids == NULL || newBatch->sel == NULL || newBatch->columns == NULL) {
+		freeBatch(newBatch);
+		return RC_MEM_ALLOC_FAILED;
+	}
+	for (int i = 0; i < schema->numAttr; i++) {
+		RM_Vector *column = &newBatch->columns[i];
+		column->dt = schema->dataTypes[i];
+		// Strings get room for their terminating NUL, dictionary encoded ones their decoded value
+		column->width = (column->dt == DT_STRING) ? schema->typeLength[i] + 1 : getAttrSize(schema, i);
+		column->v.stringV = malloc(RM_BATCH_SIZE * column->width);
+		if (column->v.stringV == NULL) {
+			freeBatch(newBatch);
+			return RC_MEM_ALLOC_FAILED;
+		}
+	}
+	*batch = newBatch;
+	return RC_OK;
+}
+
+/*
+	- Function: freeBatch
+	- Description: Frees a batch created by createBatch.
+*/
+RC freeBatch(RM_Batch *batch)
+{
+	if (batch->columns != NULL) {
+		for (int i = 0; i < batch->schema->numAttr; i++) {
+			free(batch->columns[i].v.stringV);
+		}
+	}
+	free(batch->columns);
+	free(batch->ids);
+	free(batch->sel);
+	free(batch);
+	return RC_OK;
+}
+
+/*
+	- Function: setBatchValue
+	- Description: Stores one attribute of a row, given in the byte format of Record->data. A NULL
+	  value stores zeros, an empty string for a DT_STRING attribute.
+*/
+void setBatchValue(RM_Batch *batch, int row, int attrNum, char *value)
+{
+	RM_Vector *column = &batch->columns[attrNum];
+	char *dest = column->v.stringV + row * column->width;
+	if (value == NULL) {
+		memset(dest, 0, column->width);
+	} else if (column->dt == DT_STRING) {
+		memcpy(dest, value, column->width - 1);
+		dest[column->width - 1] = '\0';
+	} else {
+		memcpy(dest, value, column->width);
+	}
+}
+
+// One side of a comparison: a column of the batch, a constant repeated for
+// every row (stride 0), or the result of a nested boolean expression
+typedef struct BatchOperand
+{
+	DataType dt;
+	char *values;
+	int stride;
+	union v constant;
+	bool bools[RM_BATCH_SIZE];
+} BatchOperand;
+
+static RC loadOperand(RM_Batch *batch, Expr *expr, BatchOperand *operand)
+{
+	switch (expr->type) {
+		case EXPR_ATTRREF: {
+			RM_Vector *column = &batch->columns[expr->expr.attrRef];
+			operand->dt = column->dt;
+			operand->values = column->v.stringV;
+			operand->stride = column->width;
+			return RC_OK;
+		}
+		case EXPR_CONST:
+			operand->dt = expr->expr.cons->dt;
+			operand->constant = expr->expr.cons->v;
+			operand->values = operand->dt == DT_STRING ? operand->constant.stringV : (char *)&operand->constant;
+			operand->stride = 0;
+			return RC_OK;
+		default: {
+			uint64_t bits[RM_BATCH_WORDS];
+			RC rc = evalBatchExpr(batch, expr, bits);
+			operand->dt = DT_BOOL;
+			operand->values = (char *)operand->bools;
+			operand->stride = sizeof(bool);
+			for (int i = 0; i < batch->numRows; i++) {
+				operand->bools[i] = RM_BATCH_TEST(bits, i);
+			}
+			return rc;
+		}
+	}
+}
+
+// Compares the values of two operands row by row with the condition test on a and b
+#define COMPARE_ROWS(type, test)						\
+	do {									\
+		for (int i = 0; i < batch->numRows; i++) {				\
+			type a = *(type *)(left->values + i * left->stride);		\
+			type b = *(type *)(right->values + i * right->stride);		\
+			result[i >> 6] |= (uint64_t)(test) << (i & 63);			\
+		}									\
+	} while (0)
+
+// Int and float comparisons with at least one column go to the SIMD kernels
+static bool compareWithKernel(RM_Batch *batch, bool equal, BatchOperand *left, BatchOperand *right, uint64_t *result)
+{
+	int n = batch->numRows;
+	bool isFloat = (left->dt == DT_FLOAT);
+
+	if (left->dt != DT_INT && left->dt != DT_FLOAT) {
+		return FALSE;
+	}
+	if (left->stride != 0 && right->stride != 0) {
+		if (isFloat) {
+			simdCompareFloats((float *)left->values, (float *)right->values, n, equal ? SIMD_EQ : SIMD_LT, result);
+		} else {
+			simdCompareInts((int *)left->values, (int *)right->values, n, equal ? SIMD_EQ : SIMD_LT, result);
+		}
+		return TRUE;
+	}
+	// A constant on the left turns left < column into column > left
+	BatchOperand *column = left->stride != 0 ? left : right;
+	BatchOperand *constant = left->stride != 0 ? right : left;
+	SimdCmp cmp = equal ? SIMD_EQ : (column == left ? SIMD_LT : SIMD_GT);
+	if (column->stride == 0) {
+		return FALSE;
+	}
+	if (isFloat) {
+		simdCompareFloatConst((float *)column->values, n, cmp, constant->constant.floatV, result);
+	} else {
+		simdCompareIntConst((int *)column->values, n, cmp, constant->constant.intV, result);
+	}
+	return TRUE;
+}
+
+static RC compareOperands(RM_Batch *batch, OpType opType, BatchOperand *left, BatchOperand *right, uint64_t *result)
+{
+	bool equal = (opType == OP_COMP_EQUAL);
+
+	if (left->dt != right->dt) {
+		THROW(RC_RM_COMPARE_VALUE_OF_DIFFERENT_DATATYPE, "comparison only supported for values of the same datatype");
+	}
+	if (compareWithKernel(batch, equal, left, right, result)) {
+		return RC_OK;
+	}
+	memset(result, 0, RM_BATCH_WORDS * sizeof(uint64_t));
+	switch (left->dt) {
+		case DT_INT:
+			if (equal) COMPARE_ROWS(int, a == b); else COMPARE_ROWS(int, a < b);
+			break;
+		case DT_FLOAT:
+			if (equal) COMPARE_ROWS(float, a == b); else COMPARE_ROWS(float, a < b);
+			break;
+		case DT_BOOL:
+			if (equal) COMPARE_ROWS(bool, a == b); else COMPARE_ROWS(bool, a < b);
+			break;
+		case DT_STRING:
+			for (int i = 0; i < batch->numRows; i++) {
+				int cmp = strcmp(left->values + i * left->stride, right->values + i * right->stride);
+				result[i >> 6] |= (uint64_t)(equal ? cmp == 0 : cmp < 0) << (i & 63);
+			}
+			break;
+	}
+	return RC_OK;
+}
+
+/*
+	- Function: evalBatchExpr
+	- Description: Evaluates a boolean expression for all rows of a batch at once, one operator of
+	  the expression at a time over whole vectors instead of one record at a time. Comparisons of
+	  int and float columns run in the SIMD kernels of rm_simd.c, boolean operators 64 rows a step.
+	- Parameters:
+		- batch: The rows.
+		- expr: The condition.
+		- result: Bitmap of RM_BATCH_WORDS words receiving the value of the condition for each of the
+		  batch->numRows rows. Bits past numRows are undefined.
+	- Returns:
+		- RC_OK, or the error evalExpr would report for the condition.
+*/
+RC evalBatchExpr(RM_Batch *batch, Expr *expr, uint64_t *result)
+{
+	int words = (batch->numRows + 63) / 64;
+
+	switch (expr->type) {
+		case EXPR_CONST:
+			if (expr->expr.cons->dt != DT_BOOL) {
+				THROW(RC_RM_EXPR_RESULT_IS_NOT_BOOLEAN, "condition is not boolean");
+			}
+			memset(result, expr->expr.cons->v.boolV ? 0xFF : 0, RM_BATCH_WORDS * sizeof(uint64_t));
+			return RC_OK;
+		case EXPR_ATTRREF: {
+			RM_Vector *column = &batch->columns[expr->expr.attrRef];
+			if (column->dt != DT_BOOL) {
+				THROW(RC_RM_EXPR_RESULT_IS_NOT_BOOLEAN, "condition is not boolean");
+			}
+			memset(result, 0, RM_BATCH_WORDS * sizeof(uint64_t));
+			for (int i = 0; i < batch->numRows; i++) {
+				result[i >> 6] |= (uint64_t)(column->v.boolV[i] != 0) << (i & 63);
+			}
+			return RC_OK;
+		}
+		case EXPR_OP:
+			break;
+	}
+
+	Operator *op = expr->expr.op;
+	RC rc;
+	switch (op->type) {
+		case OP_BOOL_NOT:
+			if ((rc = evalBatchExpr(batch, op->args[0], result)) != RC_OK) {
+				return rc;
+			}
+			for (int w = 0; w < words; w++) {
+				result[w] = ~result[w];
+			}
+			return RC_OK;
+		case OP_BOOL_AND:
+		case OP_BOOL_OR: {
+			uint64_t right[RM_BATCH_WORDS];
+			if ((rc = evalBatchExpr(batch, op->args[0], result)) != RC_OK ||
+				(rc = evalBatchExpr(batch, op->args[1], right)) != RC_OK) {
+				return rc;
+			}
+			for (int w = 0; w < words; w++) {
+				result[w] = op->type == OP_BOOL_AND ? (result[w] & right[w]) : (result[w] | right[w]);
+			}
+			return RC_OK;
+		}
+		default: {
+			BatchOperand left, right;
+			if ((rc = loadOperand(batch, op->args[0], &left)) != RC_OK ||
+				(rc = loadOperand(batch, op->args[1], &right)) != RC_OK) {
+				return rc;
+			}
+			return compareOperands(batch, op->type, &left, &right, result);
+		}
+	}
+}
+
+/*
+	- Function: selectBatch
+	- Description: Fills the selection vector of a batch with the rows matching a condition.
+	- Returns:
+		- RC_OK, or the error of evalBatchExpr.
+*/
+RC selectBatch(RM_Batch *batch, Expr *expr)
+{
+	uint64_t match[RM_BATCH_WORDS];
+	RC rc = evalBatchExpr(batch, expr, match);
+	batch->numSelected = 0;
+	if (rc != RC_OK) {
+		return rc;
+	}
+	// Walk the set bits only
+	for (int w = 0; w * 64 < batch->numRows; w++) {
+		uint64_t bits = match[w];
+		while (bits != 0) {
+			int row = w * 64 + __builtin_ctzll(bits);
+			if (row >= batch->numRows) {
+				break;
+			}
+			batch->sel[batch->numSelected++] = row;
+			bits &= bits - 1;
+		}
+	}
+	return RC_OK;
+}
@@ -0,0 +1,46 @@
+#ifndef RM_BATCH_H
+#define RM_BATCH_H
+
+#include "dberror.h"
+#include "const.h"
+#include "tables.h"
+#include "expr.h"
+#include <stdint.h>
+
+// Words of a bitmap with one bit per row of a batch
+#define RM_BATCH_WORDS ((RM_BATCH_SIZE + 63) / 64)
+#define RM_BATCH_TEST(bits, i) (((bits)[(i) >> 6] >> ((i) & 63)) & 1ULL)
+
+// Values of one attribute for all rows of a batch. Row i of a string vector
+// starts at v.stringV + i * width and is NUL terminated.
+typedef struct RM_Vector
+{
+	DataType dt;
+	int width; // bytes between the values of two rows
+	union vec {
+		int *intV;
+		float *floatV;
+		bool *boolV;
+		char *stringV;
+	} v;
+} RM_Vector;
+
+// Reusable batch of up to RM_BATCH_SIZE rows filled by nextBatch. The rows
+// of the batch matching the scan condition are listed in sel.
+typedef struct RM_Batch
+{
+	Schema *schema;
+	int numRows;         // rows filled, matching or not
+	RID *ids;            // RID of every row
+	RM_Vector *columns;  // one vector per attribute of the schema
+	int *sel;            // selection vector: positions of the matching rows, ascending
+	int numSelected;
+} RM_Batch;
+
+extern RC createBatch (RM_Batch **batch, Schema *schema);
+extern RC freeBatch (RM_Batch *batch);
+extern void setBatchValue (RM_Batch *batch, int row, int attrNum, char *value);
+extern RC evalBatchExpr (RM_Batch *batch, Expr *expr, uint64_t *result);
+extern RC selectBatch (RM_Batch *batch, Expr *expr);
+
+#endif // RM_BATCH_H
@@ -0,0 +1,353 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dberror.h"
+#include "const.h"
+#include "buffer_mgr.h"
+#include "storage_mgr.h"
+#include "rm_page.h"
+#include "rm_catalog.h"
+
+// Entries of the catalog file, and the buffer pool reading and writing it
+static RM_CatalogEntry *catalog = NULL;
+static BM_BufferPool catalogPool;
+static bool catalogOpen = false;
+static int catalogPages = 0;
+
+// Deep copy of a schema, the catalog must not depend on the caller's arrays
+static Schema *copySchema(Schema *schema)
+{
+	Schema *copy = malloc(sizeof(Schema));
+	copy->numAttr = schema->numAttr;
+	copy->keySize = schema->keySize;
+	copy->attrNames = malloc(sizeof(char *) * schema->numAttr);
+	copy->dataTypes = malloc(sizeof(DataType) * schema->numAttr);
+	copy->typeLength = malloc(sizeof(int) * schema->numAttr);
+	copy->keyAttrs = malloc(sizeof(int) * (schema->keySize > 0 ? schema->keySize : 1));
+	for (int i = 0; i < schema->numAttr; i++) {
+		copy->attrNames[i] = strdup(schema->attrNames[i]);
+		copy->dataTypes[i] = schema->dataTypes[i];
+		copy->typeLength[i] = schema->typeLength[i];
+	}
+	for (int i = 0; i < schema->keySize; i++) {
+		copy->keyAttrs[i] = schema->keyAttrs != NULL ? schema->keyAttrs[i] : i;
+	}
+	initSchemaLayout(copy);
+	for (int i = 0; i < schema->numAttr; i++) {
+		if (schema->layout->codeBytes[i] > 0) {
+			setDictionaryEncoding(copy, i, schema->layout->codeBytes[i]);
+		}
+	}
+	return copy;
+}
+
+static void freeEntry(RM_CatalogEntry *entry)
+{
+	for (int i = 0; i < entry->schema->numAttr; i++) {
+		free(entry->schema->attrNames[i]);
+	}
+	free(entry->schema->attrNames);
+	free(entry->schema->dataTypes);
+	free(entry->schema->typeLength);
+	free(entry->schema->keyAttrs);
+	freeSchemaLayout(entry->schema);
+	free(entry->schema);
+	free(entry->name);
+	free(entry->fileName);
+	free(entry);
+}
+
+// Serialized size of an entry, see rm_catalog.h
+static int entrySize(char *name, char *fileName, Schema *schema)
+{
+	int size = sizeof(int) * (3 + schema->keySize + 3 * schema->numAttr);
+	size += strlen(name) + 1 + strlen(fileName) + 1;
+	for (int i = 0; i < schema->numAttr; i++) {
+		size += strlen(schema->attrNames[i]) + 1;
+	}
+	return size;
+}
+
+static void serializeEntry(char *buf, char *name, char *fileName, Schema *schema, RM_PageLayout layout)
+{
+	int *ints = (int *)buf;
+	*ints++ = schema->numAttr;
+	*ints++ = schema->keySize;
+	*ints++ = layout;
+	for (int i = 0; i < schema->keySize; i++) {
+		*ints++ = schema->keyAttrs[i];
+	}
+	for (int i = 0; i < schema->numAttr; i++) {
+		*ints++ = schema->dataTypes[i];
+		*ints++ = schema->typeLength[i];
+		*ints++ = schema->layout->codeBytes[i];
+	}
+	char *str = (char *)ints;
+	strcpy(str, name);
+	str += strlen(name) + 1;
+	strcpy(str, fileName);
+	str += strlen(fileName) + 1;
+	for (int i = 0; i < schema->numAttr; i++) {
+		strcpy(str, schema->attrNames[i]);
+		str += strlen(schema->attrNames[i]) + 1;
+	}
+}
+
+static RM_CatalogEntry *deserializeEntry(char *buf, int length)
+{
+	// Copy out of the page first, its int fields are not aligned
+	char *data = malloc(length);
+	memcpy(data, buf, length);
+	int *ints = (int *)data;
+	Schema *schema = malloc(sizeof(Schema));
+	schema->numAttr = *ints++;
+	schema->keySize = *ints++;
+	RM_PageLayout layout = *ints++;
+	schema->keyAttrs = malloc(sizeof(int) * (schema->keySize > 0 ? schema->keySize : 1));
+	for (int i = 0; i < schema->keySize; i++) {
+		schema->keyAttrs[i] = *ints++;
+	}
+	schema->dataTypes = malloc(sizeof(DataType) * schema->numAttr);
+	schema->typeLength = malloc(sizeof(int) * schema->numAttr);
+	schema->attrNames = malloc(sizeof(char *) * schema->numAttr);
+	int *codeBytes = malloc(sizeof(int) * (schema->numAttr > 0 ? schema->numAttr : 1));
+	for (int i = 0; i < schema->numAttr; i++) {
+		schema->dataTypes[i] = *ints++;
+		schema->typeLength[i] = *ints++;
+		codeBytes[i] = *ints++;
+	}
+
+	RM_CatalogEntry *entry = malloc(sizeof(RM_CatalogEntry));
+	char *str = (char *)ints;
+	entry->name = strdup(str);
+	str += strlen(str) + 1;
+	entry->fileName = strdup(str);
+	str += strlen(str) + 1;
+	for (int i = 0; i < schema->numAttr; i++) {
+		schema->attrNames[i] = strdup(str);
+		str += strlen(str) + 1;
+	}
+	free(data);
+	initSchemaLayout(schema);
+	for (int i = 0; i < schema->numAttr; i++) {
+		if (codeBytes[i] > 0) {
+			setDictionaryEncoding(schema, i, codeBytes[i]);
+		}
+	}
+	free(codeBytes);
+	entry->schema = schema;
+	entry->layout = layout;
+	entry->handle = NULL;
+	entry->openCount = 0;
+	return entry;
+}
+
+// Writes the number of pages of the catalog file to its header page
+static RC writeCatalogPages(void)
+{
+	BM_PageHandle header;
+	RC rc = pinPage(&catalogPool, &header, 0);
+	if (rc != RC_OK) {
+		return rc;
+	}
+	*(int *)header.data = catalogPages;
+	markDirty(&catalogPool, &header);
+	forcePage(&catalogPool, &header);
+	return unpinPage(&catalogPool, &header);
+}
+
+/*
+	- Function: openCatalog
+	- Description: Loads the system catalog, creating the catalog file the first time. Calling it
+	  while the catalog is open does nothing.
+	- Returns:
+		- RC_OK if the catalog is loaded.
+*/
+RC openCatalog(void)
+{
+	SM_FileHandle fileHndl;
+	BM_PageHandle page;
+	RC rc;
+
+	if (catalogOpen) {
+		return RC_OK;
+	}
+	if (openPageFile(CATALOG_FILE, &fileHndl) != RC_OK && (rc = createPageFile(CATALOG_FILE)) != RC_OK) {
+		return rc;
+	}
+	if ((rc = initBufferPool(&catalogPool, CATALOG_FILE, CATALOG_BUF_SIZE, RS_LRU, NULL)) != RC_OK) {
+		return rc;
+	}
+	catalogOpen = true;
+
+	if ((rc = pinPage(&catalogPool, &page, 0)) != RC_OK) {
+		return rc;
+	}
+	catalogPages = *(int *)page.data;
+	unpinPage(&catalogPool, &page);
+	// A new catalog file has only its header page
+	if (catalogPages < 1) {
+		catalogPages = 1;
+	}
+
+	for (int pageNum = 1; pageNum < catalogPages; pageNum++) {
+		if ((rc = pinPage(&catalogPool, &page, pageNum)) != RC_OK) {
+			return rc;
+		}
+		for (int slot = 0; slot < getNumSlots(page.data); slot++) {
+			int length;
+			char *data = getSlot(page.data, slot, &length);
+			if (data != NULL) {
+				RM_CatalogEntry *entry = deserializeEntry(data, length);
+				entry->id.page = pageNum;
+				entry->id.slot = slot;
+				entry->next = catalog;
+				catalog = entry;
+			}
+		}
+		unpinPage(&catalogPool, &page);
+	}
+	return RC_OK;
+}
+
+/*
+	- Function: closeCatalog
+	- Description: Writes the catalog back and frees its entries.
+	- Returns:
+		- RC_OK if the catalog is closed, RC_ERROR while a table is open: its RM_TableData shares
+		  the schema of the entry.
+*/
+RC closeCatalog(void)
+{
+	if (!catalogOpen) {
+		return RC_OK;
+	}
+	for (RM_CatalogEntry *entry = catalog; entry != NULL; entry = entry->next) {
+		if (entry->handle != NULL) {
+			return RC_ERROR;
+		}
+	}
+	while (catalog != NULL) {
+		RM_CatalogEntry *next = catalog->next;
+		freeEntry(catalog);
+		catalog = next;
+	}
+	catalogOpen = false;
+	return shutdownBufferPool(&catalogPool);
+}
+
+/*
+	- Function: findCatalogEntry
+	- Description: Looks a table up by name.
+	- Returns:
+		- The entry, or NULL if the table is not in the catalog.
+*/
+RM_CatalogEntry *findCatalogEntry(char *name)
+{
+	for (RM_CatalogEntry *entry = catalog; entry != NULL; entry = entry->next) {
+		if (strcmp(entry->name, name) == 0) {
+			return entry;
+		}
+	}
+	return NULL;
+}
+
+/*
+	- Function: addCatalogEntry
+	- Description: Adds a table to the catalog, replacing an entry with the same name unless that
+	  table is open. The entry is written through to the catalog file.
+	- Parameters:
+		- name: The table name.
+		- fileName: The page file holding the table.
+		- schema: The schema of the table, copied into the catalog.
+		- layout: The layout of the table's data pages.
+	- Returns:
+		- RC_OK if the entry is stored, RC_ERROR if a table of that name is open.
+*/
+RC addCatalogEntry(char *name, char *fileName, Schema *schema, RM_PageLayout layout)
+{
+	BM_PageHandle page;
+	RC rc;
+
+	if (!catalogOpen) {
+		return RC_FILE_HANDLE_NOT_INIT;
+	}
+	RM_CatalogEntry *old = findCatalogEntry(name);
+	if (old != NULL && old->handle != NULL) {
+		return RC_ERROR;
+	}
+	if (old != NULL && (rc = removeCatalogEntry(name)) != RC_OK) {
+		return rc;
+	}
+	int length = entrySize(name, fileName, schema);
+	if (length + SLOT_ENTRY_LEN > PAGE_SIZE - PAGE_HEADER_LEN) {
+		return RC_RM_LIMIT_EXCEEDED;
+	}
+	char *buf = malloc(length);
+	serializeEntry(buf, name, fileName, schema, layout);
+
+	// The catalog is small, take the first page with room or append one
+	int slot = -1;
+	int pageNum;
+	for (pageNum = 1; pageNum <= catalogPages && slot < 0; pageNum++) {
+		if ((rc = pinPage(&catalogPool, &page, pageNum)) != RC_OK) {
+			free(buf);
+			return rc;
+		}
+		if (pageNum == catalogPages) {
+			initSlottedPage(page.data);
+			catalogPages++;
+			writeCatalogPages();
+		}
+		if ((slot = insertSlot(page.data, buf, length)) >= 0) {
+			markDirty(&catalogPool, &page);
+			forcePage(&catalogPool, &page);
+		}
+		unpinPage(&catalogPool, &page);
+	}
+	free(buf);
+
+	RM_CatalogEntry *entry = malloc(sizeof(RM_CatalogEntry));
+	entry->name = strdup(name);
+	entry->fileName = strdup(fileName);
+	entry->schema = copySchema(schema);
+	entry->layout = layout;
+	entry->id.page = pageNum - 1;
+	entry->id.slot = slot;
+	entry->handle = NULL;
+	entry->openCount = 0;
+	entry->next = catalog;
+	catalog = entry;
+	return RC_OK;
+}
+
+/*
+	- Function: removeCatalogEntry
+	- Description: Removes a table from the catalog and the catalog file.
+	- Returns:
+		- RC_OK if the entry is removed, RC_FILE_NOT_FOUND if there is none.
+*/
+RC removeCatalogEntry(char *name)
+{
+	BM_PageHandle page;
+	RC rc;
+
+	for (RM_CatalogEntry **link = &catalog; *link != NULL; link = &(*link)->next) {
+		RM_CatalogEntry *entry = *link;
+		if (strcmp(entry->name, name) != 0) {
+			continue;
+		}
+		if ((rc = pinPage(&catalogPool, &page, entry->id.page)) != RC_OK) {
+			return rc;
+		}
+		deleteSlot(page.data, entry->id.slot);
+		markDirty(&catalogPool, &page);
+		forcePage(&catalogPool, &page);
+		unpinPage(&catalogPool, &page);
+		*link = entry->next;
+		freeEntry(entry);
+		return RC_OK;
+	}
+	return RC_FILE_NOT_FOUND;
+}
@@ -0,0 +1,36 @@
+#ifndef RM_CATALOG_H
+#define RM_CATALOG_H
+
+#include "dberror.h"
+#include "tables.h"
+#include "record_mgr.h"
+
+// System catalog entry of one table. The catalog keeps every entry in memory
+// while the record manager is initialized and shares the open handle of a
+// table between all openTable calls on it.
+typedef struct RM_CatalogEntry
+{
+	char *name;              // table name
+	char *fileName;          // page file holding the table
+	Schema *schema;          // owned by the catalog
+	RM_PageLayout layout;    // layout of the table's data pages
+	RID id;                  // where the entry is stored in the catalog file
+	RecordManager *handle;   // open handle of the table, NULL while closed
+	int openCount;           // openTable calls not yet closed
+	struct RM_CatalogEntry *next;
+} RM_CatalogEntry;
+
+/*
+ * The catalog file (CATALOG_FILE) has a header page holding the number of
+ * pages of the file, followed by slotted pages with one record per table:
+ * numAttr, keySize, the page layout, the key attributes, the data type, length and dictionary
+ * code width of every attribute, then the table name, the file name and the attribute names as
+ * NUL terminated strings.
+ */
+extern RC openCatalog (void);
+extern RC closeCatalog (void);
+extern RM_CatalogEntry *findCatalogEntry (char *name);
+extern RC addCatalogEntry (char *name, char *fileName, Schema *schema, RM_PageLayout layout);
+extern RC removeCatalogEntry (char *name);
+
+#endif // RM_CATALOG_H
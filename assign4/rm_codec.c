@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dberror.h"
+#include "rm_codec.h"
+#include "rm_dict.h"
+
+static RC decodeInt(const char *data, int size, RM_Dictionary *dict, Value *value)
+{
+	(void)size;
+	(void)dict;
+	value->dt = DT_INT;
+	memcpy(&value->v.intV, data, sizeof(int));
+	return RC_OK;
+}
+
+static RC decodeFloat(const char *data, int size, RM_Dictionary *dict, Value *value)
+{
+	(void)size;
+	(void)dict;
+	value->dt = DT_FLOAT;
+	memcpy(&value->v.floatV, data, sizeof(float));
+	return RC_OK;
+}
+
+static RC decodeBool(const char *data, int size, RM_Dictionary *dict, Value *value)
+{
+	(void)size;
+	(void)dict;
+	value->dt = DT_BOOL;
+	memcpy(&value->v.boolV, data, sizeof(bool));
+	return RC_OK;
+}
+
+// Copies the fixed width field into a NUL terminated string owned by the value
+static RC decodeString(const char *data, int size, RM_Dictionary *dict, Value *value)
+{
+	(void)dict;
+	if (size == 0) {
+		return RC_ERROR;
+	}
+	value->dt = DT_STRING;
+	value->v.stringV = malloc(size + 1);
+	if (value->v.stringV == NULL) {
+		return RC_MEM_ALLOC_FAILED;
+	}
+	memcpy(value->v.stringV, data, size);
+	value->v.stringV[size] = '\0';
+	return RC_OK;
+}
+
+static RC decodeUnknown(const char *data, int size, RM_Dictionary *dict, Value *value)
+{
+	(void)data;
+	(void)size;
+	(void)dict;
+	(void)value;
+	return RC_RM_UNKOWN_DATATYPE;
+}
+
+static RC encodeInt(char *data, int size, RM_Dictionary *dict, Value *value)
+{
+	(void)size;
+	(void)dict;
+	memcpy(data, &value->v.intV, sizeof(int));
+	return RC_OK;
+}
+
+static RC encodeFloat(char *data, int size, RM_Dictionary *dict, Value *value)
+{
+	(void)size;
+	(void)dict;
+	memcpy(data, &value->v.floatV, sizeof(float));
+	return RC_OK;
+}
+
+static RC encodeBool(char *data, int size, RM_Dictionary *dict, Value *value)
+{
+	(void)size;
+	(void)dict;
+	memcpy(data, &value->v.boolV, sizeof(bool));
+	return RC_OK;
+}
+
+// Shorter strings are padded with NUL bytes, longer ones cut at the field width
+static RC encodeString(char *data, int size, RM_Dictionary *dict, Value *value)
+{
+	(void)dict;
+	strncpy(data, value->v.stringV, size);
+	return RC_OK;
+}
+
+static RC encodeUnknown(char *data, int size, RM_Dictionary *dict, Value *value)
+{
+	(void)data;
+	(void)size;
+	(void)dict;
+	(void)value;
+	return RC_RM_UNKOWN_DATATYPE;
+}
+
+// A dictionary encoded string is stored as its code, size bytes wide
+static RC decodeDictCode(const char *data, int size, RM_Dictionary *dict, Value *value)
+{
+	if (dict == NULL) {
+		return RC_ERROR;
+	}
+	const char *string = getDictString(dict, readDictCode(data, size));
+	if (string == NULL) {
+		return RC_ERROR;
+	}
+	value->dt = DT_STRING;
+	value->v.stringV = strdup(string);
+	return value->v.stringV != NULL ? RC_OK : RC_MEM_ALLOC_FAILED;
+}
+
+static RC encodeDictCode(char *data, int size, RM_Dictionary *dict, Value *value)
+{
+	int code;
+	if (dict == NULL) {
+		return RC_ERROR;
+	}
+	RC rc = encodeDictString(dict, value->v.stringV, &code);
+	if (rc == RC_OK) {
+		writeDictCode(data, size, code);
+	}
+	return rc;
+}
+
+// Indexed by DataType
+static const RM_AttrCodec codecs[] = {
+	[DT_INT] = { decodeInt, encodeInt, NULL },
+	[DT_STRING] = { decodeString, encodeString, NULL },
+	[DT_FLOAT] = { decodeFloat, encodeFloat, NULL },
+	[DT_BOOL] = { decodeBool, encodeBool, NULL }
+};
+
+/*
+	- Function: getAttrCodec
+	- Description: Looks up the codec of a data type.
+	- Parameters:
+		- dt: The data type of an attribute.
+	- Returns:
+		- Its codec; for an unknown data type one that fails with RC_RM_UNKOWN_DATATYPE.
+*/
+RM_AttrCodec getAttrCodec(DataType dt)
+{
+	if ((int) dt < 0 || (int) dt >= (int) (sizeof(codecs) / sizeof(codecs[0]))) {
+		RM_AttrCodec unknown = { decodeUnknown, encodeUnknown, NULL };
+		return unknown;
+	}
+	return codecs[dt];
+}
+
+/*
+	- Function: getDictCodec
+	- Description: Returns the codec of a dictionary encoded DT_STRING attribute. It fails with
+	  RC_ERROR until openTable sets its dictionary.
+*/
+RM_AttrCodec getDictCodec(void)
+{
+	RM_AttrCodec codec = { decodeDictCode, encodeDictCode, NULL };
+	return codec;
+}
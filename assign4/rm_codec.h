@@ -0,0 +1,27 @@
+#ifndef RM_CODEC_H
+#define RM_CODEC_H
+
+#include "dberror.h"
+#include "tables.h"
+
+struct RM_Dictionary;
+
+/*
+ * Codec of an attribute: the routines reading its bytes in a record into a
+ * Value and writing them from one. initSchemaLayout picks the codec of every
+ * attribute from a table keyed by data type, so getAttr, setAttr and their
+ * bulk forms call through the layout instead of switching on the data type
+ * of the attribute on every access. Dictionary encoded attributes get the
+ * dictionary codec, which needs the dictionary of the open table (rm_dict.h).
+ */
+typedef struct RM_AttrCodec
+{
+	RC (*decode) (const char *data, int size, struct RM_Dictionary *dict, Value *value);
+	RC (*encode) (char *data, int size, struct RM_Dictionary *dict, Value *value);
+	struct RM_Dictionary *dict; // set while the table of a dictionary encoded attribute is open
+} RM_AttrCodec;
+
+extern RM_AttrCodec getAttrCodec (DataType dt);
+extern RM_AttrCodec getDictCodec (void);
+
+#endif // RM_CODEC_H
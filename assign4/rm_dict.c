@@ -0,0 +1,422 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+
+#include "dberror.h"
+#include "storage_mgr.h"
+#include "rm_codec.h"
+#include "rm_dict.h"
+
+// Name of the sidecar file of a table, to be freed by the caller
+static char *dictFileName(char *tableFile)
+{
+	char *name = malloc(strlen(tableFile) + strlen(DICT_SUFFIX) + 1);
+	strcpy(name, tableFile);
+	strcat(name, DICT_SUFFIX);
+	return name;
+}
+
+static bool hasDictionaries(Schema *schema)
+{
+	for (int i = 0; i < schema->numAttr; i++) {
+		if (schema->layout->codeBytes[i] > 0) {
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+/*
+	- Function: createDictFile
+	- Description: Creates the empty dictionaries of a new table, replacing old ones. Nothing is
+	  created for a schema without dictionary encoded attributes.
+*/
+RC createDictFile(char *tableFile, Schema *schema)
+{
+	char *name = dictFileName(tableFile);
+	RC rc = RC_OK;
+	destroyPageFile(name);
+	if (hasDictionaries(schema)) {
+		rc = createPageFile(name);
+	}
+	free(name);
+	return rc;
+}
+
+/*
+	- Function: destroyDictFile
+	- Description: Deletes the dictionaries of a table.
+*/
+RC destroyDictFile(char *tableFile)
+{
+	char *name = dictFileName(tableFile);
+	RC rc = destroyPageFile(name);
+	free(name);
+	return rc;
+}
+
+// Bytes of an entry up to its terminating NUL or the attribute width
+static int entryLength(const char *string, int width)
+{
+	int length = 0;
+	while (length < width && string[length] != '\0') {
+		length++;
+	}
+	return length;
+}
+
+// FNV-1a
+static unsigned int hashString(const char *string, int length)
+{
+	unsigned int hash = 2166136261u;
+	for (int i = 0; i < length; i++) {
+		hash = (hash ^ (unsigned char)string[i]) * 16777619u;
+	}
+	return hash;
+}
+
+static char *dictEntry(RM_Dictionary *dict, int code)
+{
+	return dict->chunks[code / DICT_CHUNK_ENTRIES] + (code % DICT_CHUNK_ENTRIES) * (dict->width + 1);
+}
+
+// Code of an entry of the given bytes, -1 if the dictionary does not have it
+static int findEntry(RM_Dictionary *dict, const char *string, int length)
+{
+	unsigned int mask = dict->numBuckets - 1;
+	for (unsigned int b = hashString(string, length) & mask; dict->buckets[b] != 0; b = (b + 1) & mask) {
+		char *entry = dictEntry(dict, dict->buckets[b] - 1);
+		if (entryLength(entry, dict->width) == length && memcmp(entry, string, length) == 0) {
+			return dict->buckets[b] - 1;
+		}
+	}
+	return -1;
+}
+
+static void hashEntry(RM_Dictionary *dict, int code)
+{
+	char *entry = dictEntry(dict, code);
+	unsigned int mask = dict->numBuckets - 1;
+	unsigned int b = hashString(entry, entryLength(entry, dict->width)) & mask;
+	while (dict->buckets[b] != 0) {
+		b = (b + 1) & mask;
+	}
+	dict->buckets[b] = code + 1;
+}
+
+// Adds an entry to the in-memory dictionary, keeping the hash table at most half full. Entries
+// already handed out by getDictString stay where they are, a full dictionary gets a new chunk.
+static RC addEntry(RM_Dictionary *dict, const char *string, int length)
+{
+	if (dict->numEntries == dict->numChunks * DICT_CHUNK_ENTRIES) {
+		char **chunks = realloc(dict->chunks, sizeof(char *) * (dict->numChunks + 1));
+		if (chunks == NULL) {
+			return RC_MEM_ALLOC_FAILED;
+		}
+		dict->chunks = chunks;
+		if ((chunks[dict->numChunks] = malloc((size_t)DICT_CHUNK_ENTRIES * (dict->width + 1))) == NULL) {
+			return RC_MEM_ALLOC_FAILED;
+		}
+		dict->numChunks++;
+	}
+	if (2 * (dict->numEntries + 1) > dict->numBuckets) {
+		int *buckets = calloc(dict->numBuckets * 2, sizeof(int));
+		if (buckets == NULL) {
+			return RC_MEM_ALLOC_FAILED;
+		}
+		free(dict->buckets);
+		dict->buckets = buckets;
+		dict->numBuckets *= 2;
+		for (int code = 0; code < dict->numEntries; code++) {
+			hashEntry(dict, code);
+		}
+	}
+	char *entry = dictEntry(dict, dict->numEntries);
+	memset(entry, 0, dict->width + 1);
+	memcpy(entry, string, length);
+	hashEntry(dict, dict->numEntries++);
+	return RC_OK;
+}
+
+// Writes the page count and first chain pages of the sidecar file
+static RC writeDictHeader(RM_DictFile *dictFile, int attrNum, int headPage)
+{
+	BM_PageHandle header;
+	RC rc = pinPage(&dictFile->pool, &header, 0);
+	if (rc != RC_OK) {
+		return rc;
+	}
+	int *ints = (int *)header.data;
+	ints[0] = dictFile->numPages;
+	if (attrNum >= 0) {
+		ints[1 + attrNum] = headPage;
+	}
+	markDirty(&dictFile->pool, &header);
+	return unpinPage(&dictFile->pool, &header);
+}
+
+// Appends an entry to the page chain of a dictionary, starting a page when the last one is full
+static RC appendEntry(RM_Dictionary *dict, const char *entry)
+{
+	RM_DictFile *dictFile = dict->file;
+	int perPage = (PAGE_SIZE - DICT_PAGE_HEADER) / dict->width;
+	BM_PageHandle page;
+	int count;
+	RC rc;
+
+	if (dict->tailPage != 0) {
+		if ((rc = pinPage(&dictFile->pool, &page, dict->tailPage)) != RC_OK) {
+			return rc;
+		}
+		memcpy(&count, page.data + sizeof(int), sizeof(int));
+		if (count < perPage) {
+			memcpy(page.data + DICT_PAGE_HEADER + count * dict->width, entry, dict->width);
+			count++;
+			memcpy(page.data + sizeof(int), &count, sizeof(int));
+			markDirty(&dictFile->pool, &page);
+			return unpinPage(&dictFile->pool, &page);
+		}
+		// Link the page that is about to be started
+		memcpy(page.data, &dictFile->numPages, sizeof(int));
+		markDirty(&dictFile->pool, &page);
+		unpinPage(&dictFile->pool, &page);
+	}
+
+	int pageNum = dictFile->numPages++;
+	if ((rc = pinPage(&dictFile->pool, &page, pageNum)) != RC_OK) {
+		return rc;
+	}
+	memset(page.data, 0, PAGE_SIZE);
+	count = 1;
+	memcpy(page.data + sizeof(int), &count, sizeof(int));
+	memcpy(page.data + DICT_PAGE_HEADER, entry, dict->width);
+	markDirty(&dictFile->pool, &page);
+	unpinPage(&dictFile->pool, &page);
+
+	// A new head page is recorded in the header, which also counts the page
+	rc = writeDictHeader(dictFile, dict->tailPage == 0 ? dict->attrNum : -1, pageNum);
+	dict->tailPage = pageNum;
+	return rc;
+}
+
+// Reads the page chain of a dictionary into memory
+static RC loadDictionary(RM_Dictionary *dict, int headPage)
+{
+	BM_PageHandle page;
+	RC rc = RC_OK;
+
+	for (int pageNum = headPage; pageNum != 0 && rc == RC_OK; ) {
+		int next, count;
+		if ((rc = pinPage(&dict->file->pool, &page, pageNum)) != RC_OK) {
+			return rc;
+		}
+		memcpy(&next, page.data, sizeof(int));
+		memcpy(&count, page.data + sizeof(int), sizeof(int));
+		for (int i = 0; i < count && rc == RC_OK; i++) {
+			char *entry = page.data + DICT_PAGE_HEADER + i * dict->width;
+			rc = addEntry(dict, entry, entryLength(entry, dict->width));
+		}
+		unpinPage(&dict->file->pool, &page);
+		dict->tailPage = pageNum;
+		pageNum = next;
+	}
+	return rc;
+}
+
+/*
+	- Function: openDictFile
+	- Description: Loads the dictionaries of a table into memory and hands them to the codecs of
+	  its dictionary encoded attributes. The sidecar file is created if it is missing.
+	- Parameters:
+		- dictFile: The dictionaries to open.
+		- tableFile: The page file of the table.
+		- schema: The schema of the table.
+	- Returns:
+		- RC_OK if the dictionaries are loaded.
+*/
+RC openDictFile(RM_DictFile *dictFile, char *tableFile, Schema *schema)
+{
+	SM_FileHandle fileHndl;
+	BM_PageHandle header;
+	RC rc;
+
+	dictFile->numDicts = 0;
+	dictFile->dicts = NULL;
+	dictFile->fileName = NULL;
+	dictFile->pool.mgmtData = NULL;
+	if (!hasDictionaries(schema)) {
+		return RC_OK;
+	}
+
+	dictFile->fileName = dictFileName(tableFile);
+	if (openPageFile(dictFile->fileName, &fileHndl) == RC_OK) {
+		closePageFile(&fileHndl);
+	} else if ((rc = createPageFile(dictFile->fileName)) != RC_OK) {
+		closeDictFile(dictFile, schema);
+		return rc;
+	}
+	if ((rc = initBufferPool(&dictFile->pool, dictFile->fileName, DICT_BUF_SIZE, RS_LRU, NULL)) != RC_OK) {
+		dictFile->pool.mgmtData = NULL;
+		closeDictFile(dictFile, schema);
+		return rc;
+	}
+	if ((rc = pinPage(&dictFile->pool, &header, 0)) != RC_OK) {
+		closeDictFile(dictFile, schema);
+		return rc;
+	}
+	int *heads = malloc(sizeof(int) * schema->numAttr);
+	memcpy(&dictFile->numPages, header.data, sizeof(int));
+	memcpy(heads, header.data + sizeof(int), sizeof(int) * schema->numAttr);
+	unpinPage(&dictFile->pool, &header);
+	// A new file has only its header page
+	if (dictFile->numPages < 1) {
+		dictFile->numPages = 1;
+		memset(heads, 0, sizeof(int) * schema->numAttr);
+	}
+
+	dictFile->dicts = calloc(schema->numAttr, sizeof(RM_Dictionary));
+	for (int i = 0; i < schema->numAttr && rc == RC_OK; i++) {
+		if (schema->layout->codeBytes[i] == 0) {
+			continue;
+		}
+		RM_Dictionary *dict = &dictFile->dicts[dictFile->numDicts++];
+		dict->attrNum = i;
+		dict->width = schema->typeLength[i];
+		dict->codeBytes = schema->layout->codeBytes[i];
+		dict->numBuckets = 32;
+		dict->buckets = calloc(dict->numBuckets, sizeof(int));
+		dict->file = dictFile;
+		if ((rc = loadDictionary(dict, heads[i])) == RC_OK) {
+			schema->layout->codecs[i].dict = dict;
+		}
+	}
+	free(heads);
+	if (rc != RC_OK) {
+		closeDictFile(dictFile, schema);
+	}
+	return rc;
+}
+
+/*
+	- Function: closeDictFile
+	- Description: Writes the dictionaries of a table back and frees them. The codecs of the
+	  schema lose their dictionaries.
+*/
+RC closeDictFile(RM_DictFile *dictFile, Schema *schema)
+{
+	RC rc = RC_OK;
+	for (int i = 0; i < dictFile->numDicts; i++) {
+		schema->layout->codecs[dictFile->dicts[i].attrNum].dict = NULL;
+		for (int c = 0; c < dictFile->dicts[i].numChunks; c++) {
+			free(dictFile->dicts[i].chunks[c]);
+		}
+		free(dictFile->dicts[i].chunks);
+		free(dictFile->dicts[i].buckets);
+	}
+	free(dictFile->dicts);
+	if (dictFile->pool.mgmtData != NULL) {
+		rc = shutdownBufferPool(&dictFile->pool);
+	}
+	free(dictFile->fileName);
+	dictFile->numDicts = 0;
+	dictFile->dicts = NULL;
+	dictFile->fileName = NULL;
+	return rc;
+}
+
+/*
+	- Function: lookupDictCode
+	- Description: Looks up the code of a string without adding it.
+	- Returns:
+		- The code, -1 if the dictionary does not have the string. A string longer than the
+		  attribute is never stored, so it has no code.
+*/
+int lookupDictCode(RM_Dictionary *dict, const char *string)
+{
+	int length = strlen(string);
+	return length > dict->width ? -1 : findEntry(dict, string, length);
+}
+
+/*
+	- Function: encodeDictString
+	- Description: Returns the code of a string, adding it to the dictionary if it is new. Like
+	  setAttr, it keeps only the first typeLength bytes of the string.
+	- Parameters:
+		- dict: The dictionary of an attribute.
+		- string: The value to encode.
+		- code: Receives its code.
+	- Returns:
+		- RC_OK if the string has a code, RC_RM_LIMIT_EXCEEDED if the codes of the attribute's
+		  code width are used up.
+*/
+RC encodeDictString(RM_Dictionary *dict, const char *string, int *code)
+{
+	int length = entryLength(string, dict->width);
+	RC rc;
+
+	if ((*code = findEntry(dict, string, length)) >= 0) {
+		return RC_OK;
+	}
+	long maxCodes = dict->codeBytes >= (int)sizeof(int) ? INT_MAX : 1L << (8 * dict->codeBytes);
+	if (dict->numEntries >= maxCodes) {
+		return RC_RM_LIMIT_EXCEEDED;
+	}
+	if ((rc = addEntry(dict, string, length)) != RC_OK) {
+		return rc;
+	}
+	*code = dict->numEntries - 1;
+	return appendEntry(dict, dictEntry(dict, *code));
+}
+
+/*
+	- Function: getDictString
+	- Description: Returns the string of a code, NUL terminated and valid while the table is open.
+	  Adding entries does not move the ones already in the dictionary.
+	- Returns:
+		- The string, NULL for a code the dictionary has not handed out.
+*/
+const char *getDictString(RM_Dictionary *dict, int code)
+{
+	if (code < 0 || code >= dict->numEntries) {
+		return NULL;
+	}
+	return dictEntry(dict, code);
+}
+
+// Codes are stored unsigned, in the byte order of the machine like the other attributes
+int readDictCode(const char *data, int codeBytes)
+{
+	switch (codeBytes) {
+		case 1:
+			return *(const uint8_t *)data;
+		case 2: {
+			uint16_t code;
+			memcpy(&code, data, sizeof(code));
+			return code;
+		}
+		default: {
+			int code;
+			memcpy(&code, data, sizeof(code));
+			return code;
+		}
+	}
+}
+
+void writeDictCode(char *data, int codeBytes, int code)
+{
+	switch (codeBytes) {
+		case 1:
+			*(uint8_t *)data = (uint8_t)code;
+			break;
+		case 2: {
+			uint16_t value = (uint16_t)code;
+			memcpy(data, &value, sizeof(value));
+			break;
+		}
+		default:
+			memcpy(data, &code, sizeof(code));
+			break;
+	}
+}
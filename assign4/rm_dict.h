@@ -0,0 +1,60 @@
+#ifndef RM_DICT_H
+#define RM_DICT_H
+
+#include "dberror.h"
+#include "const.h"
+#include "tables.h"
+#include "buffer_mgr.h"
+
+// Bytes in front of the entries of a dictionary page: the next page of the chain and the entry count
+#define DICT_PAGE_HEADER (2 * sizeof(int))
+
+// Entries of an in-memory dictionary are allocated this many at a time, so they never move
+#define DICT_CHUNK_ENTRIES 64
+
+/*
+ * Dictionaries of the DT_STRING attributes a schema encodes with
+ * setDictionaryEncoding. Records store a 1, 2 or 4 byte code in place of such
+ * an attribute; code i stands for entry i of the attribute's dictionary.
+ * Entries are only appended, so a code never changes. The dictionaries of a
+ * table are kept in a sidecar page file (the table file name followed by
+ * DICT_SUFFIX): page 0 holds the number of pages of the file and, for every
+ * attribute, the first page of its chain (0 for none). Each chain page holds
+ * DICT_PAGE_HEADER bytes, then its entries, typeLength bytes each and NUL
+ * padded like a stored string.
+ */
+typedef struct RM_Dictionary
+{
+	int attrNum;
+	int width;      // typeLength of the attribute
+	int codeBytes;  // bytes of a code in a record
+	int numEntries;
+	int numChunks;
+	char **chunks;  // entry i at (i % DICT_CHUNK_ENTRIES) * (width + 1) of chunk i / DICT_CHUNK_ENTRIES, NUL terminated
+	int *buckets;   // open addressing table of code + 1, 0 for a free bucket
+	int numBuckets; // power of two
+	int tailPage;   // last page of the chain, 0 while it is empty
+	struct RM_DictFile *file;
+} RM_Dictionary;
+
+// Dictionaries of an open table and the buffer pool of their sidecar file
+typedef struct RM_DictFile
+{
+	BM_BufferPool pool;
+	char *fileName;
+	int numPages;
+	int numDicts;
+	RM_Dictionary *dicts;
+} RM_DictFile;
+
+extern RC createDictFile (char *tableFile, Schema *schema);
+extern RC destroyDictFile (char *tableFile);
+extern RC openDictFile (RM_DictFile *dictFile, char *tableFile, Schema *schema);
+extern RC closeDictFile (RM_DictFile *dictFile, Schema *schema);
+extern int lookupDictCode (RM_Dictionary *dict, const char *string);
+extern RC encodeDictString (RM_Dictionary *dict, const char *string, int *code);
+extern const char *getDictString (RM_Dictionary *dict, int code);
+extern int readDictCode (const char *data, int codeBytes);
+extern void writeDictCode (char *data, int codeBytes, int code);
+
+#endif // RM_DICT_H
@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dberror.h"
+#include "const.h"
+#include "rm_fsm.h"
+
+// FSM page describing the given data page
+static int fsmPageOf(int pageNum)
+{
+	return FSM_FIRST_PAGE + (pageNum - FSM_FIRST_PAGE) / FSM_GROUP_PAGES * FSM_GROUP_PAGES;
+}
+
+/*
+	- Function: isFsmPage
+	- Description: Tells whether a page of the table file belongs to the free-space map.
+*/
+bool isFsmPage(int pageNum)
+{
+	return pageNum >= FSM_FIRST_PAGE && (pageNum - FSM_FIRST_PAGE) % FSM_GROUP_PAGES == 0;
+}
+
+/*
+	- Function: nextDataPage
+	- Description: Returns the first data page at or after pageNum, skipping the header and FSM pages.
+*/
+int nextDataPage(int pageNum)
+{
+	if (pageNum <= FSM_FIRST_PAGE) {
+		return FSM_FIRST_PAGE + 1;
+	}
+	return isFsmPage(pageNum) ? pageNum + 1 : pageNum;
+}
+
+/*
+	- Function: getFsmCategory
+	- Description: Maps free bytes to the category stored in the map, rounding down.
+*/
+int getFsmCategory(int freeBytes)
+{
+	int category = freeBytes >> FSM_CATEGORY_SHIFT;
+	return category > 255 ? 255 : category;
+}
+
+/*
+	- Function: updateFreeSpace
+	- Description: Records the category of a data page in the free-space map.
+	- Parameters:
+		- bm: The buffer pool of the table.
+		- pageNum: The data page.
+		- category: The room left in the page, in the unit of its layout.
+	- Returns:
+		- RC_OK, or the error of pinning the FSM page.
+*/
+RC updateFreeSpace(BM_BufferPool *bm, int pageNum, int category)
+{
+	BM_PageHandle fsm;
+	int fsmPage = fsmPageOf(pageNum);
+	RC rc = pinPage(bm, &fsm, fsmPage);
+	if (rc != RC_OK) {
+		return rc;
+	}
+	unsigned char *entry = (unsigned char *)fsm.data + (pageNum - fsmPage - 1);
+	unsigned char stored = (unsigned char)(category > 255 ? 255 : category);
+	if (*entry != stored) {
+		*entry = stored;
+		markDirty(bm, &fsm);
+	}
+	return unpinPage(bm, &fsm);
+}
+
+/*
+	- Function: findFreePage
+	- Description: Looks the free-space map up for the first data page that may have room for a record,
+	  reading one FSM page per PAGE_SIZE data pages instead of the data pages themselves.
+	- Parameters:
+		- bm: The buffer pool of the table.
+		- fromPage: The first page to consider.
+		- numPages: The number of pages of the table file.
+		- wanted: The category the page needs. For slotted pages getFsmCategory of the record size
+		  rounds down like the stored categories, so no page with room is passed over, but a page
+		  in that very category may be a few bytes short.
+	- Returns:
+		- The data page, or -1 if every page is too full and a new one has to be appended.
+*/
+int findFreePage(BM_BufferPool *bm, int fromPage, int numPages, int wanted)
+{
+	BM_PageHandle fsm;
+
+	for (int pageNum = nextDataPage(fromPage); pageNum < numPages; ) {
+		int fsmPage = fsmPageOf(pageNum);
+		if (pinPage(bm, &fsm, fsmPage) != RC_OK) {
+			return -1;
+		}
+		unsigned char *entries = (unsigned char *)fsm.data;
+		int last = numPages - fsmPage - 1;
+		if (last > PAGE_SIZE) {
+			last = PAGE_SIZE;
+		}
+		for (int i = pageNum - fsmPage - 1; i < last; i++) {
+			if (entries[i] >= wanted) {
+				unpinPage(bm, &fsm);
+				return fsmPage + 1 + i;
+			}
+		}
+		unpinPage(bm, &fsm);
+		// First data page of the next group
+		pageNum = fsmPage + FSM_GROUP_PAGES + 1;
+	}
+	return -1;
+}
@@ -0,0 +1,25 @@
+#ifndef RM_FSM_H
+#define RM_FSM_H
+
+#include "dberror.h"
+#include "const.h"
+#include "buffer_mgr.h"
+
+/*
+ * Free-space map of a table. FSM pages sit at fixed positions of the table
+ * file: page FSM_FIRST_PAGE and then one every PAGE_SIZE + 1 pages. Each FSM
+ * page holds one byte per data page following it, the page's category, capped
+ * at 255. For a slotted page it is the free bytes divided by
+ * 2^FSM_CATEGORY_SHIFT (getFsmCategory), a lower bound of the room left in the
+ * page; for a PAX page it is the number of free slots, which is exact.
+ */
+#define FSM_FIRST_PAGE 1
+#define FSM_GROUP_PAGES (PAGE_SIZE + 1)
+
+extern bool isFsmPage (int pageNum);
+extern int nextDataPage (int pageNum);
+extern int getFsmCategory (int freeBytes);
+extern RC updateFreeSpace (BM_BufferPool *bm, int pageNum, int category);
+extern int findFreePage (BM_BufferPool *bm, int fromPage, int numPages, int wanted);
+
+#endif // RM_FSM_H
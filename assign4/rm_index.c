@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dberror.h"
+#include "btree_mgr.h"
+#include "rm_index.h"
+
+/*
+	- Function: getIndexKey
+	- Description: Reads the key of an index from the attributes of a record, Record->data
+	  without its marker byte.
+*/
+int getIndexKey(RM_TableIndex *index, char *attrs)
+{
+	int key;
+	memcpy(&key, attrs + index->offset, sizeof(int));
+	return key;
+}
+
+static int compareIndexEntries(const void *a, const void *b)
+{
+	int left = ((const RM_IndexEntry *)a)->key;
+	int right = ((const RM_IndexEntry *)b)->key;
+	return (left > right) - (left < right);
+}
+
+/*
+	- Function: prepareIndexKeys
+	- Description: Collects and sorts the keys of the records a statement inserts, one array per
+	  index, and checks that none of them is in its tree yet or comes twice.
+	- Parameters:
+		- indexes: The indexes of the table.
+		- numIndexes: Their number.
+		- records: The records to insert.
+		- n: Their number.
+		- entries: Receives one array of n entries per index, for applyIndexKeys.
+	- Returns:
+		- RC_OK if the records can be inserted, RC_IM_KEY_ALREADY_EXISTS otherwise.
+*/
+RC prepareIndexKeys(RM_TableIndex *indexes, int numIndexes, Record **records, int n, RM_IndexEntry **entries)
+{
+	Value key;
+	RID found;
+	key.dt = DT_INT;
+
+	memset(entries, 0, sizeof(RM_IndexEntry *) * numIndexes);
+	for (int i = 0; i < numIndexes; i++) {
+		if ((entries[i] = malloc(sizeof(RM_IndexEntry) * (n > 0 ? n : 1))) == NULL) {
+			freeIndexKeys(numIndexes, entries);
+			return RC_MEM_ALLOC_FAILED;
+		}
+		for (int j = 0; j < n; j++) {
+			entries[i][j].key = getIndexKey(&indexes[i], records[j]->data + 1);
+			entries[i][j].record = records[j];
+		}
+		qsort(entries[i], n, sizeof(RM_IndexEntry), compareIndexEntries);
+
+		for (int j = 0; j < n; j++) {
+			key.v.intV = entries[i][j].key;
+			if ((j > 0 && entries[i][j - 1].key == key.v.intV) || findKey(indexes[i].tree, &key, &found) == RC_OK) {
+				freeIndexKeys(numIndexes, entries);
+				return RC_IM_KEY_ALREADY_EXISTS;
+			}
+		}
+	}
+	return RC_OK;
+}
+
+/*
+	- Function: applyIndexKeys
+	- Description: Inserts the keys collected by prepareIndexKeys into the trees, in key order,
+	  with the RIDs the records got, and frees them. Records whose id page is -1 were not placed
+	  and are skipped. If a tree fails, the keys the call inserted already are deleted again, so
+	  every tree is left as it was.
+	- Returns:
+		- RC_OK if all keys are inserted, the error of the tree otherwise.
+*/
+RC applyIndexKeys(RM_TableIndex *indexes, int numIndexes, int n, RM_IndexEntry **entries)
+{
+	RC result = RC_OK;
+	Value key;
+	int i, j;
+	key.dt = DT_INT;
+
+	for (i = 0; i < numIndexes && result == RC_OK; i++) {
+		for (j = 0; j < n; j++) {
+			if (entries[i][j].record->id.page < 0) {
+				continue;
+			}
+			key.v.intV = entries[i][j].key;
+			if ((result = insertKey(indexes[i].tree, &key, entries[i][j].record->id)) != RC_OK) {
+				break;
+			}
+		}
+	}
+	if (result != RC_OK) {
+		// The failed key is at entries[i - 1][j]; the keys in front of it are undone
+		for (int t = 0; t < i; t++) {
+			int end = (t == i - 1) ? j : n;
+			for (int k = 0; k < end; k++) {
+				if (entries[t][k].record->id.page >= 0) {
+					key.v.intV = entries[t][k].key;
+					deleteKey(indexes[t].tree, &key);
+				}
+			}
+		}
+	}
+	freeIndexKeys(numIndexes, entries);
+	return result;
+}
+
+/*
+	- Function: freeIndexKeys
+	- Description: Frees the keys collected by prepareIndexKeys.
+*/
+void freeIndexKeys(int numIndexes, RM_IndexEntry **entries)
+{
+	for (int i = 0; i < numIndexes; i++) {
+		free(entries[i]);
+		entries[i] = NULL;
+	}
+}
@@ -0,0 +1,35 @@
+#ifndef RM_INDEX_H
+#define RM_INDEX_H
+
+#include "dberror.h"
+#include "const.h"
+#include "tables.h"
+#include "btree_mgr.h"
+
+/*
+ * B+ trees attached to an open table with attachIndex. Each one is keyed by a
+ * DT_INT key attribute of the schema and maps every record's key to its RID;
+ * insertRecord(s), deleteRecord and updateRecord keep it up to date. As the
+ * trees hold unique keys, a statement that would store a key twice fails with
+ * RC_IM_KEY_ALREADY_EXISTS before it changes the table.
+ */
+typedef struct RM_TableIndex
+{
+	int attrNum;
+	int offset; // byte offset of the attribute in a record
+	BTreeHandle *tree;
+} RM_TableIndex;
+
+// Key of a record inserted by a statement, sorted per index so the keys reach the tree in order
+typedef struct RM_IndexEntry
+{
+	int key;
+	Record *record;
+} RM_IndexEntry;
+
+extern int getIndexKey (RM_TableIndex *index, char *attrs);
+extern RC prepareIndexKeys (RM_TableIndex *indexes, int numIndexes, Record **records, int n, RM_IndexEntry **entries);
+extern RC applyIndexKeys (RM_TableIndex *indexes, int numIndexes, int n, RM_IndexEntry **entries);
+extern void freeIndexKeys (int numIndexes, RM_IndexEntry **entries);
+
+#endif // RM_INDEX_H
@@ -0,0 +1,263 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "dberror.h"
+#include "rm_page.h"
+
+// Header and slot fields are not aligned, so they are accessed with memcpy
+static int getField(char *page, int offset)
+{
+	uint16_t value;
+	memcpy(&value, page + offset, sizeof(uint16_t));
+	return value;
+}
+
+static void setField(char *page, int offset, int value)
+{
+	uint16_t field = (uint16_t)value;
+	memcpy(page + offset, &field, sizeof(uint16_t));
+}
+
+static int slotEntry(int slot)
+{
+	return PAGE_HEADER_LEN + slot * SLOT_ENTRY_LEN;
+}
+
+// Bytes between the end of the slot directory and the record area
+static int contiguousFreeBytes(char *page)
+{
+	return getField(page, PH_FREE_OFFSET) - slotEntry(getField(page, PH_NUM_SLOTS));
+}
+
+/*
+	- Function: initSlottedPage
+	- Description: Formats a page as an empty slotted page.
+	- Parameters:
+		- page: The PAGE_SIZE bytes of the page.
+*/
+void initSlottedPage(char *page)
+{
+	memset(page, 0, PAGE_HEADER_LEN);
+	setField(page, PH_FREE_OFFSET, PAGE_SIZE);
+	setField(page, PH_FREE_SLOT, NO_SLOT);
+}
+
+/*
+	- Function: getNumSlots
+	- Description: Returns the number of slots of the directory, tombstones included.
+*/
+int getNumSlots(char *page)
+{
+	return getField(page, PH_NUM_SLOTS);
+}
+
+/*
+	- Function: getLiveSlots
+	- Description: Returns the number of records stored in the page.
+*/
+int getLiveSlots(char *page)
+{
+	return getField(page, PH_LIVE_SLOTS);
+}
+
+/*
+	- Function: getPageFreeBytes
+	- Description: Returns the size of the largest record insertSlot can still place in the page,
+	  counting the space compaction would recover and the directory entry a new slot would need.
+*/
+int getPageFreeBytes(char *page)
+{
+	int free = contiguousFreeBytes(page) + getField(page, PH_FRAGMENTED);
+	if (getField(page, PH_FREE_SLOT) == NO_SLOT) {
+		free -= SLOT_ENTRY_LEN;
+	}
+	return free > 0 ? free : 0;
+}
+
+/*
+	- Function: compactPage
+	- Description: Moves the records of a page together at its end so the space of deleted
+	  records becomes contiguous free space again. Slot numbers do not change.
+	- Parameters:
+		- page: The PAGE_SIZE bytes of the page.
+*/
+void compactPage(char *page)
+{
+	char copy[PAGE_SIZE];
+	int numSlots = getField(page, PH_NUM_SLOTS);
+	int end = PAGE_SIZE;
+
+	memcpy(copy, page, PAGE_SIZE);
+	for (int slot = 0; slot < numSlots; slot++) {
+		int length = getField(page, slotEntry(slot) + 2);
+		if (length > 0) {
+			end -= length;
+			memcpy(page + end, copy + getField(page, slotEntry(slot)), length);
+			setField(page, slotEntry(slot), end);
+		}
+	}
+	setField(page, PH_FREE_OFFSET, end);
+	setField(page, PH_FRAGMENTED, 0);
+}
+
+/*
+	- Function: vacuumSlottedPage
+	- Description: Compacts the records of a page and drops the tombstones at the end of its slot
+	  directory, so the directory and the scans over it only reach the last record. The tombstones
+	  left between records are relinked in ascending order. Slot numbers of records do not change.
+	- Parameters:
+		- page: The PAGE_SIZE bytes of the page.
+	- Returns:
+		- TRUE if the page changed.
+*/
+bool vacuumSlottedPage(char *page)
+{
+	int numSlots = getField(page, PH_NUM_SLOTS);
+	bool changed = getField(page, PH_FRAGMENTED) > 0;
+
+	if (changed) {
+		compactPage(page);
+	}
+	while (numSlots > 0 && getField(page, slotEntry(numSlots - 1) + 2) == 0) {
+		numSlots--;
+	}
+	if (numSlots == getField(page, PH_NUM_SLOTS)) {
+		return changed;
+	}
+	setField(page, PH_NUM_SLOTS, numSlots);
+	int next = NO_SLOT;
+	for (int slot = numSlots - 1; slot >= 0; slot--) {
+		if (getField(page, slotEntry(slot) + 2) == 0) {
+			setField(page, slotEntry(slot), next);
+			next = slot;
+		}
+	}
+	setField(page, PH_FREE_SLOT, next);
+	return TRUE;
+}
+
+/*
+	- Function: insertSlot
+	- Description: Stores a record in the page, reusing the first slot of the free slot list if
+	  there is one. The page is compacted when only the space of deleted records is left.
+	- Parameters:
+		- page: The PAGE_SIZE bytes of the page.
+		- record: The bytes of the record.
+		- length: The size of the record, at least 1.
+	- Returns:
+		- The slot of the record, or -1 if it does not fit in the page.
+*/
+int insertSlot(char *page, char *record, int length)
+{
+	int slot = getField(page, PH_FREE_SLOT);
+	int needed = length + (slot == NO_SLOT ? SLOT_ENTRY_LEN : 0);
+
+	if (contiguousFreeBytes(page) < needed) {
+		if (contiguousFreeBytes(page) + getField(page, PH_FRAGMENTED) < needed) {
+			return -1;
+		}
+		compactPage(page);
+	}
+
+	if (slot == NO_SLOT) {
+		slot = getField(page, PH_NUM_SLOTS);
+		setField(page, PH_NUM_SLOTS, slot + 1);
+	} else {
+		// Unlink the slot from the free slot list
+		setField(page, PH_FREE_SLOT, getField(page, slotEntry(slot)));
+	}
+	int offset = getField(page, PH_FREE_OFFSET) - length;
+	memcpy(page + offset, record, length);
+	setField(page, PH_FREE_OFFSET, offset);
+	setField(page, slotEntry(slot), offset);
+	setField(page, slotEntry(slot) + 2, length);
+	setField(page, PH_LIVE_SLOTS, getField(page, PH_LIVE_SLOTS) + 1);
+	return slot;
+}
+
+/*
+	- Function: getSlot
+	- Description: Locates a record in the page.
+	- Parameters:
+		- page: The PAGE_SIZE bytes of the page.
+		- slot: The slot of the record.
+		- length: Set to the size of the record, may be NULL.
+	- Returns:
+		- A pointer to the record inside the page, or NULL for a tombstone or a slot out of range.
+*/
+char *getSlot(char *page, int slot, int *length)
+{
+	if (slot < 0 || slot >= getField(page, PH_NUM_SLOTS)) {
+		return NULL;
+	}
+	int size = getField(page, slotEntry(slot) + 2);
+	if (size == 0) {
+		return NULL;
+	}
+	if (length != NULL) {
+		*length = size;
+	}
+	return page + getField(page, slotEntry(slot));
+}
+
+/*
+	- Function: deleteSlot
+	- Description: Turns the slot of a record into a tombstone and puts it on the free slot list.
+	  The record's bytes are reclaimed by the next compaction.
+	- Returns:
+		- RC_OK, or RC_RM_NO_TUPLE_WITH_GIVEN_RID if the slot holds no record.
+*/
+RC deleteSlot(char *page, int slot)
+{
+	int length;
+	if (getSlot(page, slot, &length) == NULL) {
+		return RC_RM_NO_TUPLE_WITH_GIVEN_RID;
+	}
+	setField(page, PH_FRAGMENTED, getField(page, PH_FRAGMENTED) + length);
+	setField(page, slotEntry(slot), getField(page, PH_FREE_SLOT));
+	setField(page, slotEntry(slot) + 2, 0);
+	setField(page, PH_FREE_SLOT, slot);
+	setField(page, PH_LIVE_SLOTS, getField(page, PH_LIVE_SLOTS) - 1);
+	return RC_OK;
+}
+
+/*
+	- Function: updateSlot
+	- Description: Replaces the record of a slot. A record that is not longer than the old one is
+	  written in place, a longer one is moved within the page so its slot and RID stay the same.
+	- Returns:
+		- RC_OK, RC_RM_NO_TUPLE_WITH_GIVEN_RID if the slot holds no record, or
+		  RC_RM_NO_MORE_SLOTS if the new record does not fit in the page.
+*/
+RC updateSlot(char *page, int slot, char *record, int length)
+{
+	int oldLength;
+	char *old = getSlot(page, slot, &oldLength);
+	if (old == NULL) {
+		return RC_RM_NO_TUPLE_WITH_GIVEN_RID;
+	}
+	if (length <= oldLength) {
+		memcpy(old, record, length);
+		setField(page, slotEntry(slot) + 2, length);
+		setField(page, PH_FRAGMENTED, getField(page, PH_FRAGMENTED) + oldLength - length);
+		return RC_OK;
+	}
+	if (contiguousFreeBytes(page) + getField(page, PH_FRAGMENTED) + oldLength < length) {
+		return RC_RM_NO_MORE_SLOTS;
+	}
+
+	// Give up the old bytes, then place the record like a new one
+	setField(page, slotEntry(slot) + 2, 0);
+	setField(page, PH_FRAGMENTED, getField(page, PH_FRAGMENTED) + oldLength);
+	if (contiguousFreeBytes(page) < length) {
+		compactPage(page);
+	}
+	int offset = getField(page, PH_FREE_OFFSET) - length;
+	memcpy(page + offset, record, length);
+	setField(page, PH_FREE_OFFSET, offset);
+	setField(page, slotEntry(slot), offset);
+	setField(page, slotEntry(slot) + 2, length);
+	return RC_OK;
+}
@@ -0,0 +1,44 @@
+#ifndef RM_PAGE_H
+#define RM_PAGE_H
+
+#include "dberror.h"
+#include "const.h"
+#include "dt.h"
+
+/*
+ * Slotted page layout of the record manager's data pages:
+ *
+ *   [0, PAGE_HEADER_LEN)  page header, fields at the PH_* offsets
+ *   slot directory        one SLOT_ENTRY_LEN entry {offset, length} per slot, growing up
+ *   free space
+ *   records               packed at the end of the page, growing down
+ *
+ * A slot with length 0 is a tombstone; its offset field links the next
+ * tombstone of the page's free slot list. All header and slot fields are
+ * 2 byte unsigned integers except the flags byte.
+ */
+#define PH_NUM_SLOTS 0                                    // slots in the directory
+#define PH_FREE_OFFSET (PH_NUM_SLOTS + BYTES_SLOTS_COUNT) // first byte of the record area
+#define PH_FREE_SLOT (PH_FREE_OFFSET + 2)                 // head of the free slot list
+#define PH_FRAGMENTED (PH_FREE_SLOT + 2)                  // bytes of deleted records in the record area
+#define PH_LIVE_SLOTS (PH_FRAGMENTED + 2)                 // slots holding a record
+#define PH_FLAGS (PH_LIVE_SLOTS + 2)                      // page format flags
+
+#define SLOT_ENTRY_LEN 4
+#define NO_SLOT 0xFFFF
+
+// page setup and information
+extern void initSlottedPage (char *page);
+extern int getNumSlots (char *page);
+extern int getLiveSlots (char *page);
+extern int getPageFreeBytes (char *page);
+
+// records of a page
+extern int insertSlot (char *page, char *record, int length);
+extern char *getSlot (char *page, int slot, int *length);
+extern RC deleteSlot (char *page, int slot);
+extern RC updateSlot (char *page, int slot, char *record, int length);
+extern void compactPage (char *page);
+extern bool vacuumSlottedPage (char *page);
+
+#endif // RM_PAGE_H
@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "dberror.h"
+#include "record_mgr.h"
+#include "rm_pax.h"
+
+// Header fields are not aligned, so they are accessed with memcpy
+static int getField(char *page, int offset)
+{
+	uint16_t value;
+	memcpy(&value, page + offset, sizeof(uint16_t));
+	return value;
+}
+
+static void setField(char *page, int offset, int value)
+{
+	uint16_t field = (uint16_t)value;
+	memcpy(page + offset, &field, sizeof(uint16_t));
+}
+
+static int bitmapLen(int capacity)
+{
+	return (capacity + 7) / 8;
+}
+
+/*
+	- Function: getPaxCapacity
+	- Description: Returns the number of records of the schema a PAX page holds, 0 if not even one fits.
+*/
+int getPaxCapacity(Schema *schema)
+{
+	int size = getRecordSize(schema);
+	if (size <= 0) {
+		return 0;
+	}
+	// Each record takes its bytes plus one bit of the presence bitmap
+	int capacity = (PAGE_SIZE - PAX_HEADER_LEN) * 8 / (size * 8 + 1);
+	while (capacity > 0 && PAX_HEADER_LEN + bitmapLen(capacity) + capacity * size > PAGE_SIZE) {
+		capacity--;
+	}
+	return capacity;
+}
+
+/*
+	- Function: initPaxPage
+	- Description: Formats a page as an empty PAX page for records of the schema.
+	- Parameters:
+		- page: The PAGE_SIZE bytes of the page.
+		- schema: The schema of the table.
+*/
+void initPaxPage(char *page, Schema *schema)
+{
+	int capacity = getPaxCapacity(schema);
+	memset(page, 0, PAX_HEADER_LEN + bitmapLen(capacity));
+	setField(page, PAX_CAPACITY, capacity);
+}
+
+/*
+	- Function: getPaxSlots
+	- Description: Returns the number of slots of the page, used or not.
+*/
+int getPaxSlots(char *page)
+{
+	return getField(page, PAX_CAPACITY);
+}
+
+/*
+	- Function: getPaxLiveSlots
+	- Description: Returns the number of records stored in the page.
+*/
+int getPaxLiveSlots(char *page)
+{
+	return getField(page, PAX_LIVE_SLOTS);
+}
+
+/*
+	- Function: isPaxSlotUsed
+	- Description: Tests the presence bit of a slot.
+*/
+bool isPaxSlotUsed(char *page, int slot)
+{
+	if (slot < 0 || slot >= getField(page, PAX_CAPACITY)) {
+		return false;
+	}
+	unsigned char *bitmap = (unsigned char *)page + PAX_HEADER_LEN;
+	return (bitmap[slot >> 3] >> (slot & 7)) & 1;
+}
+
+/*
+	- Function: getPaxFreeSlots
+	- Description: Returns the number of slots of the page not holding a record.
+*/
+int getPaxFreeSlots(char *page)
+{
+	return getField(page, PAX_CAPACITY) - getField(page, PAX_LIVE_SLOTS);
+}
+
+/*
+	- Function: getPaxColumn
+	- Description: Locates the minipage of an attribute. Value i of the minipage belongs to slot i,
+	  whether the slot is used is told by isPaxSlotUsed.
+	- Returns:
+		- A pointer to the first value of the attribute inside the page.
+*/
+char *getPaxColumn(char *page, Schema *schema, int attrNum)
+{
+	int capacity = getField(page, PAX_CAPACITY);
+	// The minipages before it hold capacity values of each earlier attribute
+	return page + PAX_HEADER_LEN + bitmapLen(capacity) + capacity * getAttrOffset(schema, attrNum);
+}
+
+/*
+	- Function: insertPaxSlot
+	- Description: Stores a record in the first free slot of the page, spreading its attributes over
+	  the minipages.
+	- Parameters:
+		- page: The PAGE_SIZE bytes of the page.
+		- schema: The schema of the table.
+		- record: The attributes of the record in row format.
+	- Returns:
+		- The slot of the record, or -1 if the page is full.
+*/
+int insertPaxSlot(char *page, Schema *schema, char *record)
+{
+	int capacity = getField(page, PAX_CAPACITY);
+	unsigned char *bitmap = (unsigned char *)page + PAX_HEADER_LEN;
+	int slot = -1;
+
+	if (getField(page, PAX_LIVE_SLOTS) >= capacity) {
+		return -1;
+	}
+	// Skip full bytes of the bitmap, eight slots at a time
+	for (int i = 0; i < bitmapLen(capacity) && slot < 0; i++) {
+		if (bitmap[i] != 0xFF) {
+			int bit = 0;
+			while ((bitmap[i] >> bit) & 1) {
+				bit++;
+			}
+			slot = i * 8 + bit;
+		}
+	}
+	if (slot < 0 || slot >= capacity) {
+		return -1;
+	}
+
+	bitmap[slot >> 3] |= (unsigned char)(1 << (slot & 7));
+	setField(page, PAX_LIVE_SLOTS, getField(page, PAX_LIVE_SLOTS) + 1);
+	updatePaxSlot(page, schema, slot, record);
+	return slot;
+}
+
+/*
+	- Function: getPaxSlot
+	- Description: Gathers a record from the minipages.
+	- Parameters:
+		- page: The PAGE_SIZE bytes of the page.
+		- schema: The schema of the table.
+		- slot: The slot of the record.
+		- record: Receives the attributes of the record in row format.
+		- attrs: The attributes to copy, NULL for all of them. The others are left untouched.
+	- Returns:
+		- RC_OK, or RC_RM_NO_TUPLE_WITH_GIVEN_RID if the slot holds no record.
+*/
+RC getPaxSlot(char *page, Schema *schema, int slot, char *record, bool *attrs)
+{
+	if (!isPaxSlotUsed(page, slot)) {
+		return RC_RM_NO_TUPLE_WITH_GIVEN_RID;
+	}
+	char *column = getPaxColumn(page, schema, 0);
+	int capacity = getField(page, PAX_CAPACITY);
+	for (int i = 0; i < schema->numAttr; i++) {
+		int size = getAttrSize(schema, i);
+		if (attrs == NULL || attrs[i]) {
+			memcpy(record, column + slot * size, size);
+		}
+		record += size;
+		column += capacity * size;
+	}
+	return RC_OK;
+}
+
+/*
+	- Function: deletePaxSlot
+	- Description: Clears the presence bit of a slot so the next insert can reuse it.
+	- Returns:
+		- RC_OK, or RC_RM_NO_TUPLE_WITH_GIVEN_RID if the slot holds no record.
+*/
+RC deletePaxSlot(char *page, int slot)
+{
+	if (!isPaxSlotUsed(page, slot)) {
+		return RC_RM_NO_TUPLE_WITH_GIVEN_RID;
+	}
+	unsigned char *bitmap = (unsigned char *)page + PAX_HEADER_LEN;
+	bitmap[slot >> 3] &= (unsigned char)~(1 << (slot & 7));
+	setField(page, PAX_LIVE_SLOTS, getField(page, PAX_LIVE_SLOTS) - 1);
+	return RC_OK;
+}
+
+/*
+	- Function: updatePaxSlot
+	- Description: Replaces the record of a slot in place, records of a PAX page never move.
+	- Returns:
+		- RC_OK, or RC_RM_NO_TUPLE_WITH_GIVEN_RID if the slot holds no record.
+*/
+RC updatePaxSlot(char *page, Schema *schema, int slot, char *record)
+{
+	if (!isPaxSlotUsed(page, slot)) {
+		return RC_RM_NO_TUPLE_WITH_GIVEN_RID;
+	}
+	char *column = getPaxColumn(page, schema, 0);
+	int capacity = getField(page, PAX_CAPACITY);
+	for (int i = 0; i < schema->numAttr; i++) {
+		int size = getAttrSize(schema, i);
+		memcpy(column + slot * size, record, size);
+		record += size;
+		column += capacity * size;
+	}
+	return RC_OK;
+}
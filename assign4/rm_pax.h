@@ -0,0 +1,43 @@
+#ifndef RM_PAX_H
+#define RM_PAX_H
+
+#include "dberror.h"
+#include "const.h"
+#include "tables.h"
+
+/*
+ * PAX page layout of the record manager's data pages, used by tables created
+ * with RM_LAYOUT_PAX. A page holds a fixed number of record slots, its
+ * capacity, and stores every attribute of those records in a minipage of its
+ * own:
+ *
+ *   [0, PAX_HEADER_LEN)  capacity and live slot count, 2 byte unsigned integers
+ *   presence bitmap      one bit per slot, set while the slot holds a record
+ *   minipage 0           capacity values of attribute 0
+ *   ...
+ *   minipage n-1         capacity values of attribute n-1
+ *
+ * A predicate on one attribute only reads that attribute's minipage.
+ * Records are passed in and out in the row format of Record->data, without
+ * its marker byte, so callers do not see the layout.
+ */
+#define PAX_CAPACITY 0
+#define PAX_LIVE_SLOTS 2
+#define PAX_HEADER_LEN 4
+
+// page setup and information
+extern int getPaxCapacity (Schema *schema);
+extern void initPaxPage (char *page, Schema *schema);
+extern int getPaxSlots (char *page);
+extern int getPaxLiveSlots (char *page);
+extern bool isPaxSlotUsed (char *page, int slot);
+extern int getPaxFreeSlots (char *page);
+extern char *getPaxColumn (char *page, Schema *schema, int attrNum);
+
+// records of a page
+extern int insertPaxSlot (char *page, Schema *schema, char *record);
+extern RC getPaxSlot (char *page, Schema *schema, int slot, char *record, bool *attrs);
+extern RC deletePaxSlot (char *page, int slot);
+extern RC updatePaxSlot (char *page, Schema *schema, int slot, char *record);
+
+#endif // RM_PAX_H
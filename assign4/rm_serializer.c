@@ -18,7 +18,7 @@ typedef struct VarString {
 			var = (VarString *) malloc(sizeof(VarString));	\
 			var->size = 0;					\
 			var->bufsize = 100;					\
-			var->buf = calloc(100,0);				\
+			var->buf = calloc(100,1);				\
 		} while (0)
 
 #define FREE_VARSTRING(var)			\
@@ -49,6 +49,7 @@ typedef struct VarString {
 				int newbufsize = var->bufsize;				\
 				while((newbufsize *= 2) < newsize);			\
 				var->buf = realloc(var->buf, newbufsize);			\
+				var->bufsize = newbufsize;					\
 			}								\
 		} while (0)
 
@@ -67,9 +68,6 @@ typedef struct VarString {
 			free(tmp);					\
 		} while(0)
 
-// prototypes
-static RC attrOffset (Schema *schema, int attrNum, int *result);
-
 // implementations
 char *
 serializeTableInfo(RM_TableData *rel)
@@ -171,52 +169,33 @@ serializeRecord(Record *record, Schema *schema)
 char * 
 serializeAttr(Record *record, Schema *schema, int attrNum)
 {
-	int offset;
-	char *attrData;
+	Value *val;
 	VarString *result;
 	MAKE_VARSTRING(result);
 
-	attrOffset(schema, attrNum, &offset);
-	attrData = record->data + offset;
+	// The codec of the attribute decodes it, past the marker byte of the record
+	if (getAttr(record, schema, attrNum, &val) != RC_OK)
+	{
+		APPEND_STRING(result, "NO SERIALIZER FOR DATATYPE");
+		RETURN_STRING(result);
+	}
 
-	switch(schema->dataTypes[attrNum])
+	switch(val->dt)
 	{
 	case DT_INT:
-	{
-		int val = 0;
-		memcpy(&val,attrData, sizeof(int));
-		APPEND(result, "%s:%i", schema->attrNames[attrNum], val);
-	}
-	break;
+		APPEND(result, "%s:%i", schema->attrNames[attrNum], val->v.intV);
+		break;
 	case DT_STRING:
-	{
-		char *buf;
-		int len = schema->typeLength[attrNum];
-		buf = (char *) malloc(len + 1);
-		strncpy(buf, attrData, len);
-		buf[len] = '\0';
-
-		APPEND(result, "%s:%s", schema->attrNames[attrNum], buf);
-		free(buf);
-	}
-	break;
+		APPEND(result, "%s:%s", schema->attrNames[attrNum], val->v.stringV);
+		break;
 	case DT_FLOAT:
-	{
-		float val;
-		memcpy(&val,attrData, sizeof(float));
-		APPEND(result, "%s:%f", schema->attrNames[attrNum], val);
-	}
-	break;
+		APPEND(result, "%s:%f", schema->attrNames[attrNum], val->v.floatV);
+		break;
 	case DT_BOOL:
-	{
-		bool val;
-		memcpy(&val,attrData, sizeof(bool));
-		APPEND(result, "%s:%s", schema->attrNames[attrNum], val ? "TRUE" : "FALSE");
-	}
-	break;
-	default:
-		return "NO SERIALIZER FOR DATATYPE";
+		APPEND(result, "%s:%s", schema->attrNames[attrNum], val->v.boolV ? "TRUE" : "FALSE");
+		break;
 	}
+	freeVal(val);
 
 	RETURN_STRING(result);
 }
@@ -279,30 +258,3 @@ stringToValue(char *val)
 	return result;
 }
 
-
-RC 
-attrOffset (Schema *schema, int attrNum, int *result)
-{
-	int offset = 0;
-	int attrPos = 0;
-
-	for(attrPos = 0; attrPos < attrNum; attrPos++)
-		switch (schema->dataTypes[attrPos])
-		{
-		case DT_STRING:
-			offset += schema->typeLength[attrPos];
-			break;
-		case DT_INT:
-			offset += sizeof(int);
-			break;
-		case DT_FLOAT:
-			offset += sizeof(float);
-			break;
-		case DT_BOOL:
-			offset += sizeof(bool);
-			break;
-		}
-
-	*result = offset;
-	return RC_OK;
-}
@@ -0,0 +1,292 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "dt.h"
+#include "rm_simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_X86 1
+#endif
+
+// Scalar kernels, also used for the rows after the last full vector
+#define SCALAR_COMPARE(leftValue, rightValue)					\
+	do {									\
+		for (; i < n; i++) {						\
+			bool result = (cmp == SIMD_EQ) ? (leftValue) == (rightValue)	\
+			            : (cmp == SIMD_LT) ? (leftValue) < (rightValue)	\
+			                               : (leftValue) > (rightValue);	\
+			bits[i >> 6] |= (uint64_t)result << (i & 63);		\
+		}								\
+	} while (0)
+
+static void scalarIntConst(const int *values, int i, int n, SimdCmp cmp, int constant, uint64_t *bits)
+{
+	SCALAR_COMPARE(values[i], constant);
+}
+
+static void scalarFloatConst(const float *values, int i, int n, SimdCmp cmp, float constant, uint64_t *bits)
+{
+	SCALAR_COMPARE(values[i], constant);
+}
+
+static void scalarInts(const int *left, const int *right, int i, int n, SimdCmp cmp, uint64_t *bits)
+{
+	SCALAR_COMPARE(left[i], right[i]);
+}
+
+static void scalarFloats(const float *left, const float *right, int i, int n, SimdCmp cmp, uint64_t *bits)
+{
+	SCALAR_COMPARE(left[i], right[i]);
+}
+
+#ifdef SIMD_X86
+
+// Vectors start at multiples of 8 rows, so a mask never straddles two words
+#define STORE_MASK(mask) (bits[i >> 6] |= (uint64_t)(unsigned)(mask) << (i & 63))
+
+__attribute__((target("avx2")))
+static __m256i avx2CompareInts(__m256i l, __m256i r, SimdCmp cmp)
+{
+	return cmp == SIMD_EQ ? _mm256_cmpeq_epi32(l, r)
+	     : cmp == SIMD_LT ? _mm256_cmpgt_epi32(r, l)
+	                      : _mm256_cmpgt_epi32(l, r);
+}
+
+__attribute__((target("avx2")))
+static __m256 avx2CompareFloats(__m256 l, __m256 r, SimdCmp cmp)
+{
+	return cmp == SIMD_EQ ? _mm256_cmp_ps(l, r, _CMP_EQ_OQ)
+	     : cmp == SIMD_LT ? _mm256_cmp_ps(l, r, _CMP_LT_OQ)
+	                      : _mm256_cmp_ps(l, r, _CMP_GT_OQ);
+}
+
+__attribute__((target("avx2")))
+static void avx2IntConst(const int *values, int n, SimdCmp cmp, int constant, uint64_t *bits)
+{
+	__m256i c = _mm256_set1_epi32(constant);
+	int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i m = avx2CompareInts(_mm256_loadu_si256((const __m256i *)(values + i)), c, cmp);
+		STORE_MASK(_mm256_movemask_ps(_mm256_castsi256_ps(m)));
+	}
+	scalarIntConst(values, i, n, cmp, constant, bits);
+}
+
+__attribute__((target("avx2")))
+static void avx2FloatConst(const float *values, int n, SimdCmp cmp, float constant, uint64_t *bits)
+{
+	__m256 c = _mm256_set1_ps(constant);
+	int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		STORE_MASK(_mm256_movemask_ps(avx2CompareFloats(_mm256_loadu_ps(values + i), c, cmp)));
+	}
+	scalarFloatConst(values, i, n, cmp, constant, bits);
+}
+
+__attribute__((target("avx2")))
+static void avx2Ints(const int *left, const int *right, int n, SimdCmp cmp, uint64_t *bits)
+{
+	int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i m = avx2CompareInts(_mm256_loadu_si256((const __m256i *)(left + i)),
+		                            _mm256_loadu_si256((const __m256i *)(right + i)), cmp);
+		STORE_MASK(_mm256_movemask_ps(_mm256_castsi256_ps(m)));
+	}
+	scalarInts(left, right, i, n, cmp, bits);
+}
+
+__attribute__((target("avx2")))
+static void avx2Floats(const float *left, const float *right, int n, SimdCmp cmp, uint64_t *bits)
+{
+	int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		STORE_MASK(_mm256_movemask_ps(avx2CompareFloats(_mm256_loadu_ps(left + i), _mm256_loadu_ps(right + i), cmp)));
+	}
+	scalarFloats(left, right, i, n, cmp, bits);
+}
+
+__attribute__((target("sse4.1")))
+static __m128i sseCompareInts(__m128i l, __m128i r, SimdCmp cmp)
+{
+	return cmp == SIMD_EQ ? _mm_cmpeq_epi32(l, r)
+	     : cmp == SIMD_LT ? _mm_cmplt_epi32(l, r)
+	                      : _mm_cmpgt_epi32(l, r);
+}
+
+__attribute__((target("sse4.1")))
+static __m128 sseCompareFloats(__m128 l, __m128 r, SimdCmp cmp)
+{
+	return cmp == SIMD_EQ ? _mm_cmpeq_ps(l, r)
+	     : cmp == SIMD_LT ? _mm_cmplt_ps(l, r)
+	                      : _mm_cmpgt_ps(l, r);
+}
+
+// Two 4 row vectors per step keep the masks 8 row aligned
+__attribute__((target("sse4.1")))
+static void sseIntConst(const int *values, int n, SimdCmp cmp, int constant, uint64_t *bits)
+{
+	__m128i c = _mm_set1_epi32(constant);
+	int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		int lo = _mm_movemask_ps(_mm_castsi128_ps(sseCompareInts(_mm_loadu_si128((const __m128i *)(values + i)), c, cmp)));
+		int hi = _mm_movemask_ps(_mm_castsi128_ps(sseCompareInts(_mm_loadu_si128((const __m128i *)(values + i + 4)), c, cmp)));
+		STORE_MASK(lo | (hi << 4));
+	}
+	scalarIntConst(values, i, n, cmp, constant, bits);
+}
+
+__attribute__((target("sse4.1")))
+static void sseFloatConst(const float *values, int n, SimdCmp cmp, float constant, uint64_t *bits)
+{
+	__m128 c = _mm_set1_ps(constant);
+	int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		int lo = _mm_movemask_ps(sseCompareFloats(_mm_loadu_ps(values + i), c, cmp));
+		int hi = _mm_movemask_ps(sseCompareFloats(_mm_loadu_ps(values + i + 4), c, cmp));
+		STORE_MASK(lo | (hi << 4));
+	}
+	scalarFloatConst(values, i, n, cmp, constant, bits);
+}
+
+__attribute__((target("sse4.1")))
+static void sseInts(const int *left, const int *right, int n, SimdCmp cmp, uint64_t *bits)
+{
+	int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		int lo = _mm_movemask_ps(_mm_castsi128_ps(sseCompareInts(_mm_loadu_si128((const __m128i *)(left + i)),
+		                                                         _mm_loadu_si128((const __m128i *)(right + i)), cmp)));
+		int hi = _mm_movemask_ps(_mm_castsi128_ps(sseCompareInts(_mm_loadu_si128((const __m128i *)(left + i + 4)),
+		                                                         _mm_loadu_si128((const __m128i *)(right + i + 4)), cmp)));
+		STORE_MASK(lo | (hi << 4));
+	}
+	scalarInts(left, right, i, n, cmp, bits);
+}
+
+__attribute__((target("sse4.1")))
+static void sseFloats(const float *left, const float *right, int n, SimdCmp cmp, uint64_t *bits)
+{
+	int i = 0;
+	for (; i + 8 <= n; i += 8) {
+		int lo = _mm_movemask_ps(sseCompareFloats(_mm_loadu_ps(left + i), _mm_loadu_ps(right + i), cmp));
+		int hi = _mm_movemask_ps(sseCompareFloats(_mm_loadu_ps(left + i + 4), _mm_loadu_ps(right + i + 4), cmp));
+		STORE_MASK(lo | (hi << 4));
+	}
+	scalarFloats(left, right, i, n, cmp, bits);
+}
+
+#endif // SIMD_X86
+
+// -1 until the first kernel call detects the CPU
+static int simdLevel = -1;
+
+static SimdLevel detectSimdLevel(void)
+{
+#ifdef SIMD_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		return SIMD_AVX2;
+	}
+	if (__builtin_cpu_supports("sse4.1")) {
+		return SIMD_SSE4;
+	}
+#endif
+	return SIMD_SCALAR;
+}
+
+/*
+	- Function: getSimdLevel
+	- Description: Returns the instruction set the kernels use, detected with CPUID on the first call.
+*/
+SimdLevel getSimdLevel(void)
+{
+	if (simdLevel < 0) {
+		simdLevel = detectSimdLevel();
+	}
+	return simdLevel;
+}
+
+/*
+	- Function: setSimdLevel
+	- Description: Limits the kernels to an instruction set, capped at what the CPU supports.
+*/
+void setSimdLevel(SimdLevel level)
+{
+	SimdLevel supported = detectSimdLevel();
+	simdLevel = level < supported ? level : supported;
+}
+
+static void clearBits(int n, uint64_t *bits)
+{
+	memset(bits, 0, ((n + 63) / 64) * sizeof(uint64_t));
+}
+
+void simdCompareIntConst(const int *values, int n, SimdCmp cmp, int constant, uint64_t *bits)
+{
+	clearBits(n, bits);
+	switch (getSimdLevel()) {
+#ifdef SIMD_X86
+		case SIMD_AVX2:
+			avx2IntConst(values, n, cmp, constant, bits);
+			return;
+		case SIMD_SSE4:
+			sseIntConst(values, n, cmp, constant, bits);
+			return;
+#endif
+		default:
+			scalarIntConst(values, 0, n, cmp, constant, bits);
+	}
+}
+
+void simdCompareFloatConst(const float *values, int n, SimdCmp cmp, float constant, uint64_t *bits)
+{
+	clearBits(n, bits);
+	switch (getSimdLevel()) {
+#ifdef SIMD_X86
+		case SIMD_AVX2:
+			avx2FloatConst(values, n, cmp, constant, bits);
+			return;
+		case SIMD_SSE4:
+			sseFloatConst(values, n, cmp, constant, bits);
+			return;
+#endif
+		default:
+			scalarFloatConst(values, 0, n, cmp, constant, bits);
+	}
+}
+
+void simdCompareInts(const int *left, const int *right, int n, SimdCmp cmp, uint64_t *bits)
+{
+	clearBits(n, bits);
+	switch (getSimdLevel()) {
+#ifdef SIMD_X86
+		case SIMD_AVX2:
+			avx2Ints(left, right, n, cmp, bits);
+			return;
+		case SIMD_SSE4:
+			sseInts(left, right, n, cmp, bits);
+			return;
+#endif
+		default:
+			scalarInts(left, right, 0, n, cmp, bits);
+	}
+}
+
+void simdCompareFloats(const float *left, const float *right, int n, SimdCmp cmp, uint64_t *bits)
+{
+	clearBits(n, bits);
+	switch (getSimdLevel()) {
+#ifdef SIMD_X86
+		case SIMD_AVX2:
+			avx2Floats(left, right, n, cmp, bits);
+			return;
+		case SIMD_SSE4:
+			sseFloats(left, right, n, cmp, bits);
+			return;
+#endif
+		default:
+			scalarFloats(left, right, 0, n, cmp, bits);
+	}
+}
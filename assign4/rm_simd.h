@@ -0,0 +1,35 @@
+#ifndef RM_SIMD_H
+#define RM_SIMD_H
+
+#include <stdint.h>
+
+/*
+ * Comparison kernels over contiguous int and float columns, used by the
+ * batch scans. Every kernel sets bit i of bits, a bitmap of (n + 63) / 64
+ * words, to the result of comparing row i and clears the others. The AVX2
+ * or SSE4.1 version is picked on the first call from what the CPU supports,
+ * with a scalar version as fallback.
+ */
+typedef enum SimdCmp {
+	SIMD_EQ, // left == right
+	SIMD_LT, // left < right
+	SIMD_GT  // left > right
+} SimdCmp;
+
+typedef enum SimdLevel {
+	SIMD_SCALAR = 0,
+	SIMD_SSE4 = 1,
+	SIMD_AVX2 = 2
+} SimdLevel;
+
+extern SimdLevel getSimdLevel (void);
+extern void setSimdLevel (SimdLevel level);
+
+// column against a constant
+extern void simdCompareIntConst (const int *values, int n, SimdCmp cmp, int constant, uint64_t *bits);
+extern void simdCompareFloatConst (const float *values, int n, SimdCmp cmp, float constant, uint64_t *bits);
+// column against column
+extern void simdCompareInts (const int *left, const int *right, int n, SimdCmp cmp, uint64_t *bits);
+extern void simdCompareFloats (const float *left, const float *right, int n, SimdCmp cmp, uint64_t *bits);
+
+#endif // RM_SIMD_H
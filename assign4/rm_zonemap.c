@@ -0,0 +1,327 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dberror.h"
+#include "storage_mgr.h"
+#include "record_mgr.h"
+#include "rm_zonemap.h"
+
+// Name of the sidecar file of a table, to be freed by the caller
+static char *zoneMapFileName(char *tableFile)
+{
+	char *name = malloc(strlen(tableFile) + strlen(ZONEMAP_SUFFIX) + 1);
+	strcpy(name, tableFile);
+	strcat(name, ZONEMAP_SUFFIX);
+	return name;
+}
+
+/*
+	- Function: createZoneMap
+	- Description: Creates an empty zone map for a table, replacing an old one.
+*/
+RC createZoneMap(char *tableFile)
+{
+	char *name = zoneMapFileName(tableFile);
+	RC rc = createPageFile(name);
+	free(name);
+	return rc;
+}
+
+/*
+	- Function: destroyZoneMap
+	- Description: Deletes the zone map of a table.
+*/
+RC destroyZoneMap(char *tableFile)
+{
+	char *name = zoneMapFileName(tableFile);
+	RC rc = destroyPageFile(name);
+	free(name);
+	return rc;
+}
+
+/*
+	- Function: openZoneMap
+	- Description: Starts the buffer pool of a table's zone map, creating the sidecar file if it is
+	  missing, and lays out its entries for the schema.
+	- Parameters:
+		- zoneMap: The zone map to open.
+		- tableFile: The page file of the table.
+		- schema: The schema of the table.
+		- created: Set if the sidecar file was missing; the caller has to fill in the pages
+		  the table already has.
+	- Returns:
+		- RC_OK if the zone map is open.
+*/
+RC openZoneMap(RM_ZoneMap *zoneMap, char *tableFile, Schema *schema, bool *created)
+{
+	SM_FileHandle fileHndl;
+	RC rc;
+
+	zoneMap->fileName = zoneMapFileName(tableFile);
+	*created = FALSE;
+	if (openPageFile(zoneMap->fileName, &fileHndl) != RC_OK) {
+		if ((rc = createPageFile(zoneMap->fileName)) != RC_OK) {
+			free(zoneMap->fileName);
+			return rc;
+		}
+		*created = TRUE;
+	}
+
+	zoneMap->numAttrs = 0;
+	zoneMap->attrs = malloc(sizeof(int) * schema->numAttr);
+	zoneMap->types = malloc(sizeof(DataType) * schema->numAttr);
+	zoneMap->offsets = malloc(sizeof(int) * schema->numAttr);
+	for (int i = 0; i < schema->numAttr; i++) {
+		if (schema->dataTypes[i] == DT_INT || schema->dataTypes[i] == DT_FLOAT) {
+			zoneMap->attrs[zoneMap->numAttrs] = i;
+			zoneMap->types[zoneMap->numAttrs] = schema->dataTypes[i];
+			zoneMap->offsets[zoneMap->numAttrs] = getAttrOffset(schema, i);
+			zoneMap->numAttrs++;
+		}
+	}
+	zoneMap->entrySize = sizeof(int) + zoneMap->numAttrs * 2 * sizeof(int);
+	zoneMap->entriesPerPage = PAGE_SIZE / zoneMap->entrySize;
+
+	if ((rc = initBufferPool(&zoneMap->pool, zoneMap->fileName, ZONEMAP_BUF_SIZE, RS_LRU, NULL)) != RC_OK) {
+		zoneMap->pool.mgmtData = NULL;
+		closeZoneMap(zoneMap);
+	}
+	return rc;
+}
+
+/*
+	- Function: closeZoneMap
+	- Description: Writes the zone map back and frees it.
+*/
+RC closeZoneMap(RM_ZoneMap *zoneMap)
+{
+	RC rc = RC_OK;
+	if (zoneMap->pool.mgmtData != NULL) {
+		rc = shutdownBufferPool(&zoneMap->pool);
+	}
+	free(zoneMap->attrs);
+	free(zoneMap->types);
+	free(zoneMap->offsets);
+	free(zoneMap->fileName);
+	return rc;
+}
+
+// Reads an int or float attribute value as a double
+static double zoneValue(DataType dt, char *bytes)
+{
+	if (dt == DT_INT) {
+		int value;
+		memcpy(&value, bytes, sizeof(int));
+		return value;
+	}
+	float value;
+	memcpy(&value, bytes, sizeof(float));
+	return value;
+}
+
+/*
+	- Function: widenZoneMap
+	- Description: Widens the summary of a data page to include a record stored in it.
+	- Parameters:
+		- zoneMap: The zone map of the table.
+		- pageNum: The data page of the record.
+		- record: The attributes of the record, Record->data without its marker byte.
+	- Returns:
+		- RC_OK if the summary is updated.
+*/
+RC widenZoneMap(RM_ZoneMap *zoneMap, int pageNum, char *record)
+{
+	BM_PageHandle page;
+	RC rc = pinPage(&zoneMap->pool, &page, pageNum / zoneMap->entriesPerPage);
+	if (rc != RC_OK) {
+		return rc;
+	}
+	char *entry = page.data + (pageNum % zoneMap->entriesPerPage) * zoneMap->entrySize;
+	int used;
+	bool changed = FALSE;
+	memcpy(&used, entry, sizeof(int));
+
+	for (int i = 0; i < zoneMap->numAttrs; i++) {
+		char *value = record + zoneMap->offsets[i];
+		char *min = entry + sizeof(int) + i * 2 * sizeof(int);
+		char *max = min + sizeof(int);
+		double v = zoneValue(zoneMap->types[i], value);
+		if (!used || v < zoneValue(zoneMap->types[i], min)) {
+			memcpy(min, value, sizeof(int));
+			changed = TRUE;
+		}
+		if (!used || v > zoneValue(zoneMap->types[i], max)) {
+			memcpy(max, value, sizeof(int));
+			changed = TRUE;
+		}
+	}
+	if (!used) {
+		used = 1;
+		memcpy(entry, &used, sizeof(int));
+		changed = TRUE;
+	}
+	if (changed) {
+		markDirty(&zoneMap->pool, &page);
+	}
+	return unpinPage(&zoneMap->pool, &page);
+}
+
+/*
+	- Function: clearZoneMap
+	- Description: Resets the summary of a data page to that of a page that never held a record, so
+	  it can be widened again from the records the page has now.
+	- Parameters:
+		- zoneMap: The zone map of the table.
+		- pageNum: The data page.
+	- Returns:
+		- RC_OK if the summary is reset.
+*/
+RC clearZoneMap(RM_ZoneMap *zoneMap, int pageNum)
+{
+	BM_PageHandle page;
+	int used;
+	RC rc = pinPage(&zoneMap->pool, &page, pageNum / zoneMap->entriesPerPage);
+	if (rc != RC_OK) {
+		return rc;
+	}
+	char *entry = page.data + (pageNum % zoneMap->entriesPerPage) * zoneMap->entrySize;
+	memcpy(&used, entry, sizeof(int));
+	if (used) {
+		memset(entry, 0, zoneMap->entrySize);
+		markDirty(&zoneMap->pool, &page);
+	}
+	return unpinPage(&zoneMap->pool, &page);
+}
+
+// Turns a comparison of a summarized attribute with a constant into a range test
+static bool zonePred(RM_ZoneMap *zoneMap, Operator *op, bool negated, RM_ZonePred *pred)
+{
+	Expr *left = op->args[0];
+	Expr *right = op->args[1];
+	bool attrLeft = (left->type == EXPR_ATTRREF && right->type == EXPR_CONST);
+	Expr *attr = attrLeft ? left : right;
+	Expr *cons = attrLeft ? right : left;
+
+	if (attr->type != EXPR_ATTRREF || cons->type != EXPR_CONST) {
+		return FALSE;
+	}
+	for (pred->zoneAttr = 0; pred->zoneAttr < zoneMap->numAttrs; pred->zoneAttr++) {
+		if (zoneMap->attrs[pred->zoneAttr] == attr->expr.attrRef) {
+			break;
+		}
+	}
+	if (pred->zoneAttr == zoneMap->numAttrs || cons->expr.cons->dt != zoneMap->types[pred->zoneAttr]) {
+		return FALSE;
+	}
+	pred->value = (cons->expr.cons->dt == DT_INT) ? cons->expr.cons->v.intV : cons->expr.cons->v.floatV;
+
+	if (op->type == OP_COMP_EQUAL) {
+		// attr != value prunes nothing
+		pred->test = ZONE_EQUAL;
+		return !negated;
+	}
+	if (attrLeft) {
+		pred->test = negated ? ZONE_GREATER_EQUAL : ZONE_LESS;
+	} else {
+		pred->test = negated ? ZONE_LESS_EQUAL : ZONE_GREATER;
+	}
+	return TRUE;
+}
+
+static void collectZonePreds(RM_ZoneMap *zoneMap, Expr *expr, bool negated, RM_ZonePred *preds, int *numPreds, int maxPreds)
+{
+	if (expr->type != EXPR_OP || *numPreds >= maxPreds) {
+		return;
+	}
+	Operator *op = expr->expr.op;
+	switch (op->type) {
+		case OP_BOOL_AND:
+			// Under a NOT the AND becomes an OR, which can not prune
+			if (!negated) {
+				collectZonePreds(zoneMap, op->args[0], FALSE, preds, numPreds, maxPreds);
+				collectZonePreds(zoneMap, op->args[1], FALSE, preds, numPreds, maxPreds);
+			}
+			break;
+		case OP_BOOL_NOT:
+			collectZonePreds(zoneMap, op->args[0], !negated, preds, numPreds, maxPreds);
+			break;
+		case OP_COMP_EQUAL:
+		case OP_COMP_SMALLER:
+			if (zonePred(zoneMap, op, negated, &preds[*numPreds])) {
+				(*numPreds)++;
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+/*
+	- Function: getZonePreds
+	- Description: Extracts range tests on summarized attributes that every record matching a scan
+	  condition passes: the comparisons with constants that are joined to the rest of the condition
+	  by AND.
+	- Parameters:
+		- zoneMap: The zone map of the table.
+		- cond: The scan condition.
+		- preds: Receives the tests.
+		- maxPreds: Room in preds.
+	- Returns:
+		- The number of tests, 0 if the zone map can not prune for the condition.
+*/
+int getZonePreds(RM_ZoneMap *zoneMap, Expr *cond, RM_ZonePred *preds, int maxPreds)
+{
+	int numPreds = 0;
+	collectZonePreds(zoneMap, cond, FALSE, preds, &numPreds, maxPreds);
+	return numPreds;
+}
+
+/*
+	- Function: zoneMayMatch
+	- Description: Tells from the zone map whether a data page may hold a record passing all tests,
+	  without pinning the data page.
+	- Returns:
+		- FALSE if the page can be skipped.
+*/
+bool zoneMayMatch(RM_ZoneMap *zoneMap, int pageNum, RM_ZonePred *preds, int numPreds)
+{
+	BM_PageHandle page;
+	bool match = TRUE;
+	int used;
+
+	if (numPreds == 0 || pinPage(&zoneMap->pool, &page, pageNum / zoneMap->entriesPerPage) != RC_OK) {
+		return TRUE;
+	}
+	char *entry = page.data + (pageNum % zoneMap->entriesPerPage) * zoneMap->entrySize;
+	memcpy(&used, entry, sizeof(int));
+	// A page that never held a record has nothing to match
+	if (!used) {
+		match = FALSE;
+	}
+	for (int i = 0; i < numPreds && match; i++) {
+		char *bounds = entry + sizeof(int) + preds[i].zoneAttr * 2 * sizeof(int);
+		double min = zoneValue(zoneMap->types[preds[i].zoneAttr], bounds);
+		double max = zoneValue(zoneMap->types[preds[i].zoneAttr], bounds + sizeof(int));
+		double value = preds[i].value;
+		switch (preds[i].test) {
+			case ZONE_EQUAL:
+				match = (value >= min && value <= max);
+				break;
+			case ZONE_LESS:
+				match = (min < value);
+				break;
+			case ZONE_LESS_EQUAL:
+				match = (min <= value);
+				break;
+			case ZONE_GREATER:
+				match = (max > value);
+				break;
+			case ZONE_GREATER_EQUAL:
+				match = (max >= value);
+				break;
+		}
+	}
+	unpinPage(&zoneMap->pool, &page);
+	return match;
+}
@@ -0,0 +1,56 @@
+#ifndef RM_ZONEMAP_H
+#define RM_ZONEMAP_H
+
+#include "dberror.h"
+#include "const.h"
+#include "tables.h"
+#include "expr.h"
+#include "buffer_mgr.h"
+
+/*
+ * Zone map of a table: the minimum and maximum of every DT_INT and DT_FLOAT
+ * attribute over the records of each data page, kept in a sidecar page file
+ * (the table file name followed by ZONEMAP_SUFFIX). Entry i describes page i
+ * of the table: an int that is 0 while the page never held a record, then
+ * min and max of each summarized attribute, 4 bytes each. Summaries only
+ * widen, deletes leave them as they are until vacuumTable recomputes them, so
+ * a page outside the summary of a predicate can not hold a matching record.
+ */
+typedef struct RM_ZoneMap
+{
+	BM_BufferPool pool;
+	char *fileName;  // sidecar page file read by pool
+	int numAttrs;    // summarized attributes
+	int *attrs;      // their attribute numbers
+	DataType *types; // data types
+	int *offsets;    // and byte offsets in a record
+	int entrySize;
+	int entriesPerPage;
+} RM_ZoneMap;
+
+// Range test of a zone attribute against a constant, derived from a scan condition
+typedef enum RM_ZoneTest {
+	ZONE_EQUAL,
+	ZONE_LESS,
+	ZONE_LESS_EQUAL,
+	ZONE_GREATER,
+	ZONE_GREATER_EQUAL
+} RM_ZoneTest;
+
+typedef struct RM_ZonePred
+{
+	int zoneAttr;     // index into RM_ZoneMap.attrs
+	RM_ZoneTest test; // attribute test value
+	double value;
+} RM_ZonePred;
+
+extern RC createZoneMap (char *tableFile);
+extern RC destroyZoneMap (char *tableFile);
+extern RC openZoneMap (RM_ZoneMap *zoneMap, char *tableFile, Schema *schema, bool *created);
+extern RC closeZoneMap (RM_ZoneMap *zoneMap);
+extern RC widenZoneMap (RM_ZoneMap *zoneMap, int pageNum, char *record);
+extern RC clearZoneMap (RM_ZoneMap *zoneMap, int pageNum);
+extern int getZonePreds (RM_ZoneMap *zoneMap, Expr *cond, RM_ZonePred *preds, int maxPreds);
+extern bool zoneMayMatch (RM_ZoneMap *zoneMap, int pageNum, RM_ZonePred *preds, int numPreds);
+
+#endif // RM_ZONEMAP_H
@@ -0,0 +1,530 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "dberror.h"
+#include "storage_mgr.h"
+#include "sm_compress.h"
+
+// Bytes a match has at least, and bits of the hash of such a prefix
+#define LZ_MIN_MATCH 4
+#define LZ_HASH_BITS 12
+#define LZ_MAX_OFFSET 65535
+
+static uint32_t lzRead32(const char *p)
+{
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+// Writes the length beyond what a 4 bit token field holds as a run of bytes
+static int lzPutLength(char *dst, int pos, int dstCap, int length)
+{
+	for (; length >= 255; length -= 255) {
+		if (pos >= dstCap) {
+			return -1;
+		}
+		dst[pos++] = (char)255;
+	}
+	if (pos >= dstCap) {
+		return -1;
+	}
+	dst[pos++] = (char)length;
+	return pos;
+}
+
+// Appends one sequence: literals src[0..litLen), then a match unless matchLen is 0
+static int lzPutSequence(char *dst, int pos, int dstCap, const char *lit, int litLen, int offset, int matchLen)
+{
+	int litCode = litLen < 15 ? litLen : 15;
+	int matchCode = 0;
+	if (matchLen > 0) {
+		matchCode = (matchLen - LZ_MIN_MATCH) < 15 ? (matchLen - LZ_MIN_MATCH) : 15;
+	}
+	if (pos >= dstCap) {
+		return -1;
+	}
+	dst[pos++] = (char)((litCode << 4) | matchCode);
+	if (litCode == 15 && (pos = lzPutLength(dst, pos, dstCap, litLen - 15)) < 0) {
+		return -1;
+	}
+	if (pos + litLen > dstCap) {
+		return -1;
+	}
+	memcpy(dst + pos, lit, litLen);
+	pos += litLen;
+	if (matchLen == 0) {
+		return pos;
+	}
+	if (pos + 2 > dstCap) {
+		return -1;
+	}
+	dst[pos++] = (char)(offset & 0xFF);
+	dst[pos++] = (char)(offset >> 8);
+	if (matchCode == 15) {
+		pos = lzPutLength(dst, pos, dstCap, matchLen - LZ_MIN_MATCH - 15);
+	}
+	return pos;
+}
+
+/*
+	- Function: lzCompress
+	- Description: Compresses a buffer with an LZ77 codec in the style of LZ4: a sequence of
+	  tokens, each giving a run of literal bytes and then a match of at least LZ_MIN_MATCH bytes
+	  copied from up to 64 KB back. Matches are found through a hash table of 4 byte prefixes, so
+	  a page of zeros or repeated records shrinks to a few bytes.
+	- Parameters:
+		- src: The bytes to compress.
+		- srcLen: Their number.
+		- dst: Receives the compressed bytes.
+		- dstCap: Room in dst.
+	- Returns:
+		- The number of compressed bytes, -1 if they do not fit in dstCap.
+*/
+int lzCompress(const char *src, int srcLen, char *dst, int dstCap)
+{
+	int table[1 << LZ_HASH_BITS];
+	int pos = 0;
+	int anchor = 0;
+	int ip = 0;
+
+	// Positions are stored plus one so that 0 means none
+	memset(table, 0, sizeof(table));
+	while (ip + LZ_MIN_MATCH <= srcLen) {
+		uint32_t seq = lzRead32(src + ip);
+		uint32_t hash = (seq * 2654435761U) >> (32 - LZ_HASH_BITS);
+		int ref = table[hash] - 1;
+		table[hash] = ip + 1;
+
+		if (ref < 0 || ip - ref > LZ_MAX_OFFSET || lzRead32(src + ref) != seq) {
+			ip++;
+			continue;
+		}
+		int matchLen = LZ_MIN_MATCH;
+		while (ip + matchLen < srcLen && src[ref + matchLen] == src[ip + matchLen]) {
+			matchLen++;
+		}
+		pos = lzPutSequence(dst, pos, dstCap, src + anchor, ip - anchor, ip - ref, matchLen);
+		if (pos < 0) {
+			return -1;
+		}
+		ip += matchLen;
+		anchor = ip;
+	}
+	// The last sequence has literals only
+	return lzPutSequence(dst, pos, dstCap, src + anchor, srcLen - anchor, 0, 0);
+}
+
+// Reads the rest of a length whose token field is 15
+static int lzGetLength(const unsigned char *src, int *pos, int srcLen)
+{
+	int length = 0;
+	unsigned char b;
+	do {
+		if (*pos >= srcLen) {
+			return -1;
+		}
+		b = src[(*pos)++];
+		length += b;
+	} while (b == 255);
+	return length;
+}
+
+/*
+	- Function: lzDecompress
+	- Description: Restores a buffer compressed by lzCompress. Every length and offset is checked
+	  against both buffers, so a damaged page is reported instead of overrunning them.
+	- Parameters:
+		- src: The compressed bytes.
+		- srcLen: Their number.
+		- dst: Receives the original bytes.
+		- dstLen: Their number, as given to lzCompress.
+	- Returns:
+		- RC_OK if exactly dstLen bytes were restored, RC_READING_FAILED otherwise.
+*/
+RC lzDecompress(const char *src, int srcLen, char *dst, int dstLen)
+{
+	const unsigned char *in = (const unsigned char *)src;
+	int ip = 0;
+	int op = 0;
+
+	while (ip < srcLen) {
+		int token = in[ip++];
+		int litLen = token >> 4;
+		if (litLen == 15) {
+			int extra = lzGetLength(in, &ip, srcLen);
+			if (extra < 0) {
+				return RC_READING_FAILED;
+			}
+			litLen += extra;
+		}
+		if (litLen > srcLen - ip || litLen > dstLen - op) {
+			return RC_READING_FAILED;
+		}
+		memcpy(dst + op, src + ip, litLen);
+		ip += litLen;
+		op += litLen;
+		// Only the last sequence ends right after its literals
+		if (ip == srcLen) {
+			break;
+		}
+
+		if (srcLen - ip < 2) {
+			return RC_READING_FAILED;
+		}
+		int offset = in[ip] | (in[ip + 1] << 8);
+		ip += 2;
+		int matchLen = (token & 15) + LZ_MIN_MATCH;
+		if ((token & 15) == 15) {
+			int extra = lzGetLength(in, &ip, srcLen);
+			if (extra < 0) {
+				return RC_READING_FAILED;
+			}
+			matchLen += extra;
+		}
+		if (offset == 0 || offset > op || matchLen > dstLen - op) {
+			return RC_READING_FAILED;
+		}
+		// Byte by byte, a match may overlap the bytes it produces
+		for (int i = 0; i < matchLen; i++, op++) {
+			dst[op] = dst[op - offset];
+		}
+	}
+	return op == dstLen ? RC_OK : RC_READING_FAILED;
+}
+
+/*
+	- Function: createCompressedPageFile
+	- Description: Creates a page file whose pages are stored LZ compressed (see sm_compress.h).
+	  Like createPageFile it starts with one page of zeros; openPageFile recognizes the format,
+	  and readBlock, writeBlock and ensureCapacity handle it transparently.
+	- Parameters:
+		- fileName: The page file to create, replacing an existing one.
+	- Returns:
+		- RC_OK if the file is created.
+*/
+RC createCompressedPageFile(char *fileName)
+{
+	FILE *fp = fopen(fileName, "wb");
+	if (fp == NULL) {
+		return RC_FILE_NOT_FOUND;
+	}
+	char *header = calloc(PAGE_SIZE, sizeof(char));
+	SM_CompressHeader head;
+	memset(&head, 0, sizeof(head));
+	memcpy(head.magic, SM_COMPRESS_MAGIC, sizeof(head.magic));
+	head.numPages = 1;
+	head.numMapBlocks = 0;
+	head.fileEnd = PAGE_SIZE;
+	memcpy(header, &head, sizeof(head));
+
+	size_t written = fwrite(header, sizeof(char), PAGE_SIZE, fp);
+	free(header);
+	fclose(fp);
+	return written == PAGE_SIZE ? RC_OK : RC_WRITE_FAILED;
+}
+
+static bool readHeader(FILE *fp, SM_CompressHeader *head)
+{
+	return fseek(fp, 0, SEEK_SET) == 0 && fread(head, sizeof(*head), 1, fp) == 1 &&
+		memcmp(head->magic, SM_COMPRESS_MAGIC, sizeof(head->magic)) == 0;
+}
+
+static bool writeHeader(FILE *fp, SM_CompressHeader *head)
+{
+	return fseek(fp, 0, SEEK_SET) == 0 && fwrite(head, sizeof(*head), 1, fp) == 1;
+}
+
+/*
+	- Function: readCompressedPageCount
+	- Description: Tells whether an open file is a compressed page file.
+	- Parameters:
+		- file: The file, opened for reading.
+		- numPages: Receives its number of pages if it is one.
+	- Returns:
+		- TRUE for a compressed page file.
+*/
+bool readCompressedPageCount(FILE *file, int *numPages)
+{
+	SM_CompressHeader head;
+	if (!readHeader(file, &head)) {
+		return FALSE;
+	}
+	*numPages = head.numPages;
+	return TRUE;
+}
+
+// File offset of the map entry of a page, 0 if its map block does not exist yet
+static int64_t slotPosition(FILE *fp, SM_CompressHeader *head, int pageNum)
+{
+	int block = pageNum / SM_SLOTS_PER_MAP_BLOCK;
+	int64_t blockOffset;
+	if (block >= head->numMapBlocks) {
+		return 0;
+	}
+	if (fseek(fp, sizeof(*head) + block * sizeof(int64_t), SEEK_SET) != 0 ||
+		fread(&blockOffset, sizeof(blockOffset), 1, fp) != 1) {
+		return -1;
+	}
+	return blockOffset + (int64_t)(pageNum % SM_SLOTS_PER_MAP_BLOCK) * sizeof(SM_PageSlot);
+}
+
+/*
+	- Function: readCompressedBlock
+	- Description: readBlock of a compressed page file: looks up the slot of the page in its map
+	  block and decompresses it into memPage.
+	- Returns:
+		- RC_OK if the page is read, RC_READ_NON_EXISTING_PAGE if it is past the end of the file.
+*/
+RC readCompressedBlock(int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage)
+{
+	SM_CompressHeader head;
+	SM_PageSlot slot;
+	RC rc = RC_OK;
+
+	FILE *fp = fopen(fHandle->fileName, "rb");
+	if (fp == NULL) {
+		return RC_FILE_NOT_FOUND;
+	}
+	if (!readHeader(fp, &head)) {
+		fclose(fp);
+		return RC_READING_FAILED;
+	}
+	if (pageNum < 0 || pageNum >= head.numPages) {
+		fclose(fp);
+		return RC_READ_NON_EXISTING_PAGE;
+	}
+
+	int64_t position = slotPosition(fp, &head, pageNum);
+	memset(&slot, 0, sizeof(slot));
+	if (position < 0 || (position > 0 && (fseek(fp, position, SEEK_SET) != 0 || fread(&slot, sizeof(slot), 1, fp) != 1))) {
+		fclose(fp);
+		return RC_READING_FAILED;
+	}
+
+	if (slot.capacity == 0) {
+		memset(memPage, 0, PAGE_SIZE);
+	} else if (slot.length == PAGE_SIZE) {
+		if (fseek(fp, slot.offset, SEEK_SET) != 0 || fread(memPage, sizeof(char), PAGE_SIZE, fp) != PAGE_SIZE) {
+			rc = RC_READING_FAILED;
+		}
+	} else {
+		char *packed = malloc(slot.length);
+		if (fseek(fp, slot.offset, SEEK_SET) != 0 || fread(packed, sizeof(char), slot.length, fp) != (size_t)slot.length) {
+			rc = RC_READING_FAILED;
+		} else {
+			rc = lzDecompress(packed, slot.length, memPage, PAGE_SIZE);
+		}
+		free(packed);
+	}
+	fclose(fp);
+
+	fHandle->totalNumPages = head.numPages;
+	fHandle->curPagePos = (pageNum + 1) * PAGE_SIZE;
+	return rc;
+}
+
+// Adds zeroed map blocks at the end of the file until the map covers a page
+static bool addMapBlocks(FILE *fp, SM_CompressHeader *head, int pageNum)
+{
+	int needed = pageNum / SM_SLOTS_PER_MAP_BLOCK + 1;
+	char *zeros = NULL;
+
+	if (needed > SM_MAX_MAP_BLOCKS) {
+		return FALSE;
+	}
+	while (head->numMapBlocks < needed) {
+		int64_t blockOffset = head->fileEnd;
+		if (zeros == NULL) {
+			zeros = calloc(PAGE_SIZE, sizeof(char));
+		}
+		if (fseek(fp, blockOffset, SEEK_SET) != 0 || fwrite(zeros, sizeof(char), PAGE_SIZE, fp) != PAGE_SIZE ||
+			fseek(fp, sizeof(*head) + head->numMapBlocks * sizeof(int64_t), SEEK_SET) != 0 ||
+			fwrite(&blockOffset, sizeof(blockOffset), 1, fp) != 1) {
+			free(zeros);
+			return FALSE;
+		}
+		head->fileEnd += PAGE_SIZE;
+		head->numMapBlocks++;
+	}
+	free(zeros);
+	return TRUE;
+}
+
+/*
+	- Function: writeCompressedBlock
+	- Description: writeBlock of a compressed page file: compresses memPage and writes it over its
+	  slot if it fits, else into a new slot at the end of the file. A page that does not compress
+	  is stored as is.
+	- Returns:
+		- RC_OK if the page is written.
+*/
+RC writeCompressedBlock(int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage)
+{
+	SM_CompressHeader head;
+	SM_PageSlot slot;
+
+	if (pageNum < 0 || pageNum > fHandle->totalNumPages || memPage == NULL) {
+		return RC_WRITE_FAILED;
+	}
+	FILE *fp = fopen(fHandle->fileName, "r+b");
+	if (fp == NULL) {
+		return RC_FILE_NOT_FOUND;
+	}
+	if (!readHeader(fp, &head) || !addMapBlocks(fp, &head, pageNum)) {
+		fclose(fp);
+		return RC_WRITE_FAILED;
+	}
+
+	char *packed = malloc(PAGE_SIZE);
+	int length = lzCompress(memPage, PAGE_SIZE, packed, PAGE_SIZE - 1);
+	char *bytes = packed;
+	if (length < 0) {
+		length = PAGE_SIZE;
+		bytes = memPage;
+	}
+
+	int64_t position = slotPosition(fp, &head, pageNum);
+	bool ok = position > 0 && fseek(fp, position, SEEK_SET) == 0 && fread(&slot, sizeof(slot), 1, fp) == 1;
+	if (ok && length > slot.capacity) {
+		slot.offset = head.fileEnd;
+		slot.capacity = (length + SM_SLOT_ALIGN - 1) / SM_SLOT_ALIGN * SM_SLOT_ALIGN;
+		head.fileEnd += slot.capacity;
+	}
+	slot.length = length;
+	ok = ok && fseek(fp, slot.offset, SEEK_SET) == 0 && fwrite(bytes, sizeof(char), length, fp) == (size_t)length &&
+		fseek(fp, position, SEEK_SET) == 0 && fwrite(&slot, sizeof(slot), 1, fp) == 1;
+	if (pageNum >= head.numPages) {
+		head.numPages = pageNum + 1;
+	}
+	ok = ok && writeHeader(fp, &head);
+	free(packed);
+	fclose(fp);
+	if (!ok) {
+		return RC_WRITE_FAILED;
+	}
+
+	fHandle->totalNumPages = head.numPages;
+	fHandle->curPagePos = (pageNum + 1) * PAGE_SIZE;
+	return RC_OK;
+}
+
+/*
+	- Function: ensureCompressedCapacity
+	- Description: ensureCapacity of a compressed page file. New pages get no slot until they are
+	  written, so growing the file only updates its header.
+	- Returns:
+		- RC_OK if the file has at least numberOfPages pages.
+*/
+RC ensureCompressedCapacity(int numberOfPages, SM_FileHandle *fHandle)
+{
+	SM_CompressHeader head;
+
+	if (numberOfPages < 0) {
+		return RC_INVALID_NUMBER_OF_PAGES;
+	}
+	FILE *fp = fopen(fHandle->fileName, "r+b");
+	if (fp == NULL) {
+		return RC_FILE_NOT_FOUND;
+	}
+	if (!readHeader(fp, &head)) {
+		fclose(fp);
+		return RC_WRITE_FAILED;
+	}
+	if (numberOfPages > head.numPages) {
+		head.numPages = numberOfPages;
+		if (!writeHeader(fp, &head)) {
+			fclose(fp);
+			return RC_WRITE_FAILED;
+		}
+	}
+	fclose(fp);
+	fHandle->totalNumPages = head.numPages;
+	return RC_OK;
+}
+
+// Copies the slot of a page to the end of the compacted file and points the slot there
+static bool moveSlot(FILE *from, FILE *to, SM_CompressHeader *head, SM_PageSlot *slot, char *bytes)
+{
+	if (slot->length < 0 || slot->length > PAGE_SIZE ||
+		fseek(from, slot->offset, SEEK_SET) != 0 || fread(bytes, sizeof(char), slot->length, from) != (size_t)slot->length) {
+		return FALSE;
+	}
+	slot->offset = head->fileEnd;
+	slot->capacity = (slot->length + SM_SLOT_ALIGN - 1) / SM_SLOT_ALIGN * SM_SLOT_ALIGN;
+	head->fileEnd += slot->capacity;
+	return fseek(to, slot->offset, SEEK_SET) == 0 && fwrite(bytes, sizeof(char), slot->length, to) == (size_t)slot->length;
+}
+
+/*
+	- Function: truncateCompressedFile
+	- Description: truncatePageFile of a compressed page file. The pages that are kept are copied
+	  into a new file next to it (the file name followed by SM_COMPACT_SUFFIX), map blocks first and
+	  then their slots back to back, which then replaces the file. This also gives back the slots
+	  that moved pages left behind.
+	- Returns:
+		- RC_OK if the file has numberOfPages pages.
+*/
+RC truncateCompressedFile(int numberOfPages, SM_FileHandle *fHandle)
+{
+	SM_CompressHeader head;
+	SM_CompressHeader compact;
+	SM_PageSlot slot;
+
+	FILE *fp = fopen(fHandle->fileName, "rb");
+	if (fp == NULL) {
+		return RC_FILE_NOT_FOUND;
+	}
+	if (!readHeader(fp, &head)) {
+		fclose(fp);
+		return RC_WRITE_FAILED;
+	}
+	if (numberOfPages > head.numPages) {
+		numberOfPages = head.numPages;
+	}
+	char *compactName = malloc(strlen(fHandle->fileName) + sizeof(SM_COMPACT_SUFFIX));
+	sprintf(compactName, "%s%s", fHandle->fileName, SM_COMPACT_SUFFIX);
+	FILE *out = fopen(compactName, "w+b");
+	char *bytes = calloc(PAGE_SIZE, sizeof(char));
+
+	compact = head;
+	compact.numPages = numberOfPages;
+	compact.numMapBlocks = 0;
+	compact.fileEnd = PAGE_SIZE;
+	// Only the pages the old map covers can have a slot
+	int lastPage = numberOfPages < head.numMapBlocks * SM_SLOTS_PER_MAP_BLOCK ?
+		numberOfPages - 1 : head.numMapBlocks * SM_SLOTS_PER_MAP_BLOCK - 1;
+	bool ok = out != NULL && fwrite(bytes, sizeof(char), PAGE_SIZE, out) == PAGE_SIZE &&
+		(lastPage < 0 || addMapBlocks(out, &compact, lastPage));
+	for (int pageNum = 0; ok && pageNum <= lastPage; pageNum++) {
+		int64_t position = slotPosition(fp, &head, pageNum);
+		ok = position > 0 && fseek(fp, position, SEEK_SET) == 0 && fread(&slot, sizeof(slot), 1, fp) == 1;
+		if (!ok || slot.capacity == 0) {
+			continue;
+		}
+		position = slotPosition(out, &compact, pageNum);
+		ok = position > 0 && moveSlot(fp, out, &compact, &slot, bytes) &&
+			fseek(out, position, SEEK_SET) == 0 && fwrite(&slot, sizeof(slot), 1, out) == 1;
+	}
+	ok = ok && writeHeader(out, &compact);
+	fclose(fp);
+	if (out != NULL && fclose(out) != 0) {
+		ok = FALSE;
+	}
+	ok = ok && rename(compactName, fHandle->fileName) == 0;
+	if (!ok) {
+		remove(compactName);
+	}
+	free(compactName);
+	free(bytes);
+	if (!ok) {
+		return RC_WRITE_FAILED;
+	}
+	fHandle->totalNumPages = numberOfPages;
+	if (fHandle->curPagePos > numberOfPages * PAGE_SIZE) {
+		fHandle->curPagePos = numberOfPages * PAGE_SIZE;
+	}
+	return RC_OK;
+}
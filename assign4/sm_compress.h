@@ -0,0 +1,58 @@
+#ifndef SM_COMPRESS_H
+#define SM_COMPRESS_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "dberror.h"
+#include "const.h"
+#include "dt.h"
+#include "storage_mgr.h"
+
+// First bytes of a compressed page file
+#define SM_COMPRESS_MAGIC "ADOLZPG1"
+
+/*
+ * Layout of a page file made by createCompressedPageFile. The file starts with
+ * a header of PAGE_SIZE bytes: SM_CompressHeader followed by the file offsets
+ * of the map blocks. Map block k, PAGE_SIZE bytes as well, holds the
+ * SM_PageSlot of pages k * SM_SLOTS_PER_MAP_BLOCK onwards. Each page is kept
+ * LZ compressed in a slot of its own, SM_SLOT_ALIGN aligned; a page that no
+ * longer fits its slot moves to a new one at the end of the file, and the old
+ * slot is not reused until truncatePageFile compacts the file. A page without
+ * a slot reads as zeros.
+ */
+typedef struct SM_CompressHeader
+{
+	char magic[8];
+	int32_t numPages;     // pages of the file as seen by readBlock
+	int32_t numMapBlocks;
+	int64_t fileEnd;      // where the next slot or map block goes
+} SM_CompressHeader;
+
+typedef struct SM_PageSlot
+{
+	int64_t offset;
+	int32_t length;   // compressed bytes, PAGE_SIZE for a page stored as is
+	int32_t capacity; // bytes of the slot, 0 while the page has none
+} SM_PageSlot;
+
+#define SM_SLOTS_PER_MAP_BLOCK (PAGE_SIZE / (int)sizeof(SM_PageSlot))
+#define SM_MAX_MAP_BLOCKS ((PAGE_SIZE - (int)sizeof(SM_CompressHeader)) / (int)sizeof(int64_t))
+
+// Slots are rounded up to this many bytes, so a page can grow a little in place
+#define SM_SLOT_ALIGN 256
+
+// truncateCompressedFile writes the compacted file under the file name followed by this suffix
+#define SM_COMPACT_SUFFIX ".compact"
+
+extern int lzCompress (const char *src, int srcLen, char *dst, int dstCap);
+extern RC lzDecompress (const char *src, int srcLen, char *dst, int dstLen);
+
+extern bool readCompressedPageCount (FILE *file, int *numPages);
+extern RC readCompressedBlock (int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage);
+extern RC writeCompressedBlock (int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage);
+extern RC ensureCompressedCapacity (int numberOfPages, SM_FileHandle *fHandle);
+extern RC truncateCompressedFile (int numberOfPages, SM_FileHandle *fHandle);
+
+#endif // SM_COMPRESS_H
@@ -9,6 +9,7 @@
 #include "const.h"
 
 #include "storage_mgr.h"
+#include "sm_compress.h"
 
 FILE *file;
 
@@ -82,6 +83,13 @@ RC openPageFile(char *file_name, SM_FileHandle *file_handler)
         file_handler->curPagePos = 0;
         // Set the file name in the file handler
         file_handler->fileName = file_name;
+        // A compressed page file keeps its page count in its header
+        file_handler->compressed = readCompressedPageCount(file, &file_handler->totalNumPages);
+        if (file_handler->compressed)
+        {
+            fclose(file);
+            return RC_OK;
+        }
         if (fstat(fileno(file), &file_information) < 0)
         {
             // Closing the file before returning the error code
@@ -145,6 +153,11 @@ RC destroyPageFile(char *fileName)
 // Function to create read block
 RC readBlock(int pageNum, SM_FileHandle *file_handler, SM_PageHandle pageData)
 {
+    // Pages of a compressed page file are looked up in its page map
+    if (file_handler->compressed)
+    {
+        return readCompressedBlock(pageNum, file_handler, pageData);
+    }
     // Attempting to open the file in read-only mode
     file = fopen(file_handler->fileName, "r");
     // Checking if the file opening was not successful
@@ -336,6 +349,11 @@ RC readLastBlock(SM_FileHandle *file_handler, SM_PageHandle pageData)
 // Function to write block
 RC writeBlock (int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage) {
 
+    // Compressed pages go to slots of their own
+    if (fHandle->compressed) {
+        return writeCompressedBlock(pageNum, fHandle, memPage);
+    }
+
     // Throw error if condition is not satisfied
     if(pageNum > fHandle->totalNumPages){
         return RC_WRITE_FAILED;
@@ -392,6 +410,8 @@ RC writeBlock (int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage) {
         }
 }
 extern RC writeCurrentBlock(SM_FileHandle *fHandle, SM_PageHandle memPage) {
+    if (fHandle->compressed)
+        return writeCompressedBlock(fHandle->curPagePos / PAGE_SIZE, fHandle, memPage);
     if (file == NULL)
         return RC_FILE_NOT_FOUND;
     // Opening file stream in read & write mode. 'r+' mode opens the file for both reading and writing.
@@ -430,6 +450,11 @@ RC appendEmptyBlock(SM_FileHandle *file_handler)
     {
         return RC_FILE_HANDLE_NOT_INIT;
     }
+    // A compressed page file only records the new page in its header
+    if (file_handler->compressed)
+    {
+        return ensureCompressedCapacity(file_handler->totalNumPages + 1, file_handler);
+    }
     // Allocating memory for an empty page
     SM_PageHandle empty_page = (SM_PageHandle)calloc(PAGE_SIZE, csize);
     // Moving the file position indicator to the end of the file
@@ -458,6 +483,11 @@ RC appendEmptyBlock(SM_FileHandle *file_handler)
 // Function to ensure capacity
 RC ensureCapacity(int number_of_pages, SM_FileHandle *file_handler)
 {
+    // A compressed page file grows without writing its new pages
+    if (file_handler->compressed)
+    {
+        return ensureCompressedCapacity(number_of_pages, file_handler);
+    }
     // Open the file in append mode
     file = fopen(file_handler->fileName, "a");
     // Checking if the file handler is properly inttialized
@@ -495,3 +525,35 @@ RC ensureCapacity(int number_of_pages, SM_FileHandle *file_handler)
     fclose(file);
     return RC_OK;
 }
+
+
+// Function to shrink a page file to its first number_of_pages pages
+RC truncatePageFile(int number_of_pages, SM_FileHandle *file_handler)
+{
+    // Checking if the file handler is properly initialized
+    if (!file_handler)
+    {
+        return RC_FILE_HANDLE_NOT_INIT;
+    }
+    // Keeping at least one page, as createPageFile does
+    if (number_of_pages < 1 || number_of_pages > file_handler->totalNumPages)
+    {
+        return RC_INVALID_NUMBER_OF_PAGES;
+    }
+    // A compressed page file drops the slots of the pages from its page map
+    if (file_handler->compressed)
+    {
+        return truncateCompressedFile(number_of_pages, file_handler);
+    }
+    // Cutting the file right after the last page kept
+    if (truncate(file_handler->fileName, (off_t)number_of_pages * PAGE_SIZE) != 0)
+    {
+        return RC_WRITE_FAILED;
+    }
+    file_handler->totalNumPages = number_of_pages;
+    if (file_handler->curPagePos > number_of_pages * PAGE_SIZE)
+    {
+        file_handler->curPagePos = number_of_pages * PAGE_SIZE;
+    }
+    return RC_OK;
+}
@@ -2,6 +2,7 @@
 #define STORAGE_MGR_H
 
 #include "dberror.h"
+#include "dt.h"
 
 /************************************************************
  *                    handle data structures                *
@@ -11,6 +12,7 @@ typedef struct SM_FileHandle {
 	int totalNumPages;
 	int curPagePos;
 	void *mgmtInfo;
+	bool compressed; // made by createCompressedPageFile, set by openPageFile
 } SM_FileHandle;
 
 typedef char* SM_PageHandle;
@@ -21,6 +23,7 @@ typedef char* SM_PageHandle;
 /* manipulating page files */
 extern void initStorageManager (void);
 extern RC createPageFile (char *fileName);
+extern RC createCompressedPageFile (char *fileName);
 extern RC openPageFile (char *fileName, SM_FileHandle *fHandle);
 extern RC closePageFile (SM_FileHandle *fHandle);
 extern RC destroyPageFile (char *fileName);
@@ -39,5 +42,6 @@ extern RC writeBlock (int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage
 extern RC writeCurrentBlock (SM_FileHandle *fHandle, SM_PageHandle memPage);
 extern RC appendEmptyBlock (SM_FileHandle *fHandle);
 extern RC ensureCapacity (int numberOfPages, SM_FileHandle *fHandle);
+extern RC truncatePageFile (int numberOfPages, SM_FileHandle *fHandle);
 
 #endif
@@ -32,6 +32,18 @@ typedef struct Record
 	char *data;
 } Record;
 
+// Byte layout of the records of a schema, computed once when the schema is created. Records
+// are packed: an attribute starts right after the previous one.
+typedef struct SchemaLayout
+{
+	int recordSize; // bytes of the attributes, the marker byte of Record->data not counted
+	int *offsets;   // of each attribute from the first one
+	int *sizes;     // bytes of each attribute
+	int *codeBytes; // width of the dictionary code of each attribute, 0 if it is stored as is
+	struct RM_AttrCodec *codecs; // reads and writes each attribute, see rm_codec.h
+	bool allInts;   // every attribute is a DT_INT, the attributes of a record are an int array
+} SchemaLayout;
+
 // information of a table schema: its attributes, datatypes, 
 typedef struct Schema
 {
@@ -41,6 +53,7 @@ typedef struct Schema
 	int *typeLength;
 	int *keyAttrs;
 	int keySize;
+	SchemaLayout *layout;
 } Schema;
 
 // TableData: Management Structure for a Record Manager to handle one relation
@@ -0,0 +1,2802 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "dberror.h"
+#include "storage_mgr.h"
+#include "sm_compress.h"
+#include "buffer_mgr.h"
+#include "btree_mgr.h"
+#include "record_mgr.h"
+#include "expr.h"
+#include "tables.h"
+#include "rm_catalog.h"
+#include "rm_dict.h"
+#include "rm_fsm.h"
+#include "rm_page.h"
+#include "rm_pax.h"
+#include "rm_simd.h"
+#include "test_helper.h"
+
+#define ASSERT_EQUALS_RID(_l,_r, message)				\
+  do {									\
+    ASSERT_TRUE((_l).page == (_r).page && (_l).slot == (_r).slot, message); \
+  } while(0)
+
+// test methods
+static void testSnapshotEviction (void);
+static void testSimdLevels (void);
+static void testDeepTree (void);
+static void testIndexMaintenance (void);
+static void testLzCodec (void);
+static void testVacuum (void);
+static void testMultiGet (void);
+static void testCustomPolicy (void);
+static void testVictimOrder (void);
+static void testAdaptiveSwitch (void);
+static void testMemoryGovernor (void);
+static void testSlottedPage (void);
+static void testFreeSpaceMap (void);
+static void testBulkInsert (void);
+static void testCatalog (void);
+static void testPaxTable (void);
+static void testBatchScan (void);
+static void testCompiledExpr (void);
+static void testZoneMapPruning (void);
+static void testProjectedScan (void);
+static void testRecordRef (void);
+static void testParallelScan (void);
+static void testRecordLayout (void);
+static void testAttrCodecs (void);
+static void testDictionaryEncoding (void);
+
+// helper methods
+static bool sameBits (uint64_t *bits, bool *expected, int n);
+static int *shuffledInts (int size);
+static RID keyRid (int key);
+static Schema *testSchema (void);
+static Record *testRecord (Schema *schema, int a, char *b, int c);
+static int indexKeyOf (int i, int *keys);
+static void fillPage (char *page, int kind);
+static int scanTable (RM_TableData *table, long *sum);
+static int scanWhere (RM_TableData *table, Expr *sel, long *sum);
+static long fileSize (char *fileName);
+static int compareRids (const void *a, const void *b);
+static Expr *attrCompare (int attrNum, OpType op, char *constant);
+static void checkTestRecord (Record *r, Schema *schema, int a, char *b, int c);
+static Schema *typesSchema (void);
+static Schema *intSchema (void);
+static Record *dictRecord (Schema *schema, int key, int string);
+static void checkDictRecords (RM_TableData *table, RID *rids, int numRecords, int numDistinct);
+static Record *typesRecord (Schema *schema, int key);
+static int mixedScanKeys (RM_TableData *table, Expr *sel, int *keys);
+static Expr *zoneRange (int low, int high);
+static void collectRids (RM_Batch *batch, int worker, void *ctx);
+static void touchPage (BM_BufferPool *bm, PageNumber pageNum);
+static bool sameFrames (BM_BufferPool *bm, PageNumber *expected);
+static void countingOnHit (BM_BufferPool *const bm, int frame);
+static void countingOnLoad (BM_BufferPool *const bm, int frame);
+static int fixedVictim (BM_BufferPool *const bm);
+static void countingOnEvict (BM_BufferPool *const bm, int frame);
+static void countingOnUnpin (BM_BufferPool *const bm, int frame);
+
+// state of the RS_CUSTOM policy of testCustomPolicy
+typedef struct CountingPolicy {
+  int victim; // frame chooseVictim returns
+  int hits, loads, evictions, unpins;
+} CountingPolicy;
+
+// matching rows parallelScan hands to collectRids in testParallelScan
+typedef struct RidCollector {
+  pthread_mutex_t lock;
+  RID *rids;
+  int numRids;
+  int maxWorker; // highest worker id seen
+} RidCollector;
+
+// test name
+char *testName;
+
+// main method
+int
+main (void)
+{
+  testName = "";
+
+  testSnapshotEviction();
+  testSimdLevels();
+  testDeepTree();
+  testIndexMaintenance();
+  testLzCodec();
+  testVacuum();
+  testMultiGet();
+  testCustomPolicy();
+  testVictimOrder();
+  testAdaptiveSwitch();
+  testMemoryGovernor();
+  testSlottedPage();
+  testFreeSpaceMap();
+  testBulkInsert();
+  testCatalog();
+  testPaxTable();
+  testBatchScan();
+  testCompiledExpr();
+  testZoneMapPruning();
+  testProjectedScan();
+  testRecordRef();
+  testParallelScan();
+  testRecordLayout();
+  testAttrCodecs();
+  testDictionaryEncoding();
+
+  return 0;
+}
+
+// ************************************************************
+void
+testSnapshotEviction (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *reader = MAKE_PAGE_HANDLE();
+  BM_PageHandle *writer = MAKE_PAGE_HANDLE();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  int *fixCounts;
+  int i;
+
+  testName = "snapshot reader keeps its image while the page is rewritten and evicted";
+
+  TEST_CHECK(createPageFile("testsnap.bin"));
+  TEST_CHECK(initBufferPool(bm, "testsnap.bin", 3, RS_LRU, NULL));
+
+  TEST_CHECK(pinPage(bm, writer, 0));
+  strcpy(writer->data, "before");
+  TEST_CHECK(markDirty(bm, writer));
+  TEST_CHECK(unpinPage(bm, writer));
+
+  // a writer pinning the page after the reader works on a copy
+  TEST_CHECK(pinPageSnapshot(bm, reader, 0));
+  TEST_CHECK(pinPage(bm, writer, 0));
+  ASSERT_TRUE(writer->data != reader->data, "writer gets its own copy");
+  strcpy(writer->data, "after");
+  TEST_CHECK(markDirty(bm, writer));
+  TEST_CHECK(unpinPage(bm, writer));
+  ASSERT_EQUALS_STRING("before", reader->data, "reader still sees the old image");
+
+  // cycle more pages than the pool has frames, so page 0 is written back and evicted
+  for(i = 1; i <= 6; i++)
+    {
+      TEST_CHECK(pinPage(bm, h, i));
+      sprintf(h->data, "page-%i", i);
+      TEST_CHECK(markDirty(bm, h));
+      TEST_CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_STRING("before", reader->data, "reader image survives the eviction");
+  TEST_CHECK(unpinPage(bm, reader));
+
+  // the writer's version is the one on disk
+  TEST_CHECK(pinPage(bm, h, 0));
+  ASSERT_EQUALS_STRING("after", h->data, "writer's version was written back");
+  TEST_CHECK(unpinPage(bm, h));
+  fixCounts = getFixCounts(bm);
+  for(i = 0; i < 3; i++)
+    ASSERT_EQUALS_INT(0, fixCounts[i], "no pins left");
+  free(fixCounts);
+
+  TEST_CHECK(shutdownBufferPool(bm));
+  TEST_CHECK(destroyPageFile("testsnap.bin"));
+  free(bm);
+  free(reader);
+  free(writer);
+  free(h);
+
+  TEST_DONE();
+}
+
+// ************************************************************
+void
+testSimdLevels (void)
+{
+  SimdLevel levels[] = { SIMD_SCALAR, SIMD_SSE4, SIMD_AVX2 };
+  SimdCmp cmps[] = { SIMD_EQ, SIMD_LT, SIMD_GT };
+  // not a multiple of the vector width, so every kernel runs its scalar tail
+  int n = 1037;
+  int *ints = (int *) malloc(sizeof(int) * n);
+  int *otherInts = (int *) malloc(sizeof(int) * n);
+  float *floats = (float *) malloc(sizeof(float) * n);
+  float *otherFloats = (float *) malloc(sizeof(float) * n);
+  uint64_t *bits = (uint64_t *) malloc(sizeof(uint64_t) * ((n + 63) / 64));
+  bool *expected = (bool *) malloc(sizeof(bool) * n);
+  int i, l, c;
+
+  testName = "SIMD comparison kernels match the scalar results at every level";
+
+  for(i = 0; i < n; i++)
+    {
+      ints[i] = (i % 5 == 0) ? 7 : rand() % 21 - 10;
+      otherInts[i] = (i % 3 == 0) ? ints[i] : rand() % 21 - 10;
+      floats[i] = ints[i] * 0.5f;
+      otherFloats[i] = otherInts[i] * 0.5f;
+    }
+  ints[0] = -2147483647 - 1;
+  ints[1] = 2147483647;
+  floats[2] = -0.0f;
+
+  for(l = 0; l < 3; l++)
+    {
+      setSimdLevel(levels[l]);
+      for(c = 0; c < 3; c++)
+        {
+          SimdCmp cmp = cmps[c];
+
+          for(i = 0; i < n; i++)
+            expected[i] = cmp == SIMD_EQ ? ints[i] == 7 : cmp == SIMD_LT ? ints[i] < 7 : ints[i] > 7;
+          simdCompareIntConst(ints, n, cmp, 7, bits);
+          ASSERT_TRUE(sameBits(bits, expected, n), "int column against a constant");
+
+          for(i = 0; i < n; i++)
+            expected[i] = cmp == SIMD_EQ ? floats[i] == 0.0f : cmp == SIMD_LT ? floats[i] < 0.0f : floats[i] > 0.0f;
+          simdCompareFloatConst(floats, n, cmp, 0.0f, bits);
+          ASSERT_TRUE(sameBits(bits, expected, n), "float column against a constant");
+
+          for(i = 0; i < n; i++)
+            expected[i] = cmp == SIMD_EQ ? ints[i] == otherInts[i] : cmp == SIMD_LT ? ints[i] < otherInts[i] : ints[i] > otherInts[i];
+          simdCompareInts(ints, otherInts, n, cmp, bits);
+          ASSERT_TRUE(sameBits(bits, expected, n), "two int columns");
+
+          for(i = 0; i < n; i++)
+            expected[i] = cmp == SIMD_EQ ? floats[i] == otherFloats[i] : cmp == SIMD_LT ? floats[i] < otherFloats[i] : floats[i] > otherFloats[i];
+          simdCompareFloats(floats, otherFloats, n, cmp, bits);
+          ASSERT_TRUE(sameBits(bits, expected, n), "two float columns");
+        }
+    }
+  // back to the best level the CPU supports
+  setSimdLevel(SIMD_AVX2);
+
+  free(ints);
+  free(otherInts);
+  free(floats);
+  free(otherFloats);
+  free(bits);
+  free(expected);
+
+  TEST_DONE();
+}
+
+// ************************************************************
+void
+testDeepTree (void)
+{
+  // two keys per node, so the tree grows well past two levels
+  int numKeys = 400;
+  int *permute = shuffledInts(numKeys);
+  BTreeHandle *tree = NULL;
+  BT_ScanHandle *sc = NULL;
+  Value key, scanKey;
+  RID rid;
+  int i, testint, rc;
+
+  testName = "B+ tree deeper than two levels: find, ordered scans and deletes";
+  key.dt = DT_INT;
+
+  TEST_CHECK(initIndexManager(NULL));
+  TEST_CHECK(createBtree("testdeep", DT_INT, 2));
+  TEST_CHECK(openBtree(&tree, "testdeep"));
+
+  // keys are 0, 3, 6, ... inserted in random order
+  for(i = 0; i < numKeys; i++)
+    {
+      key.v.intV = permute[i] * 3;
+      TEST_CHECK(insertKey(tree, &key, keyRid(key.v.intV)));
+    }
+  TEST_CHECK(getNumEntries(tree, &testint));
+  ASSERT_EQUALS_INT(numKeys, testint, "number of entries in btree");
+
+  // a child moved by an inner split must report its own splits to its new parent
+  for(i = 0; i < numKeys; i++)
+    {
+      key.v.intV = i * 3;
+      TEST_CHECK(findKey(tree, &key, &rid));
+      ASSERT_EQUALS_RID(keyRid(key.v.intV), rid, "find every key");
+    }
+  key.v.intV = 4;
+  ASSERT_EQUALS_INT(RC_IM_KEY_NOT_FOUND, findKey(tree, &key, &rid), "missing key");
+
+  // the leaf chain returns the keys in order
+  TEST_CHECK(openTreeScan(tree, &sc));
+  for(i = 0; (rc = nextEntry(sc, &rid)) == RC_OK; i++)
+    ASSERT_EQUALS_RID(keyRid(i * 3), rid, "scan in key order");
+  ASSERT_EQUALS_INT(RC_IM_NO_MORE_ENTRIES, rc, "scan ends");
+  ASSERT_EQUALS_INT(numKeys, i, "scan saw every entry");
+  TEST_CHECK(closeTreeScan(sc));
+
+  // a scan positioned between two keys starts at the larger one
+  key.v.intV = 301;
+  TEST_CHECK(openTreeScanFrom(tree, &key, &sc));
+  TEST_CHECK(nextEntry(sc, &rid));
+  ASSERT_EQUALS_RID(keyRid(303), rid, "first entry of a positioned scan");
+  TEST_CHECK(getScanKey(sc, &scanKey));
+  ASSERT_EQUALS_INT(303, scanKey.v.intV, "key of the entry returned");
+  TEST_CHECK(closeTreeScan(sc));
+
+  // delete the even positions; the RIDs of the keys left must still match
+  for(i = 0; i < numKeys; i += 2)
+    {
+      key.v.intV = i * 3;
+      TEST_CHECK(deleteKey(tree, &key));
+    }
+  key.v.intV = 0;
+  ASSERT_EQUALS_INT(RC_IM_KEY_NOT_FOUND, deleteKey(tree, &key), "delete a deleted key");
+  TEST_CHECK(getNumEntries(tree, &testint));
+  ASSERT_EQUALS_INT(numKeys / 2, testint, "entries after deletes");
+  TEST_CHECK(openTreeScan(tree, &sc));
+  for(i = 1; (rc = nextEntry(sc, &rid)) == RC_OK; i += 2)
+    ASSERT_EQUALS_RID(keyRid(i * 3), rid, "scan skips the deleted keys");
+  ASSERT_EQUALS_INT(RC_IM_NO_MORE_ENTRIES, rc, "scan ends");
+  ASSERT_EQUALS_INT(numKeys + 1, i, "scan saw every entry left");
+  TEST_CHECK(closeTreeScan(sc));
+
+  // new keys are paired with their own RIDs after the deletes
+  for(i = 0; i < numKeys; i += 2)
+    {
+      key.v.intV = i * 3;
+      TEST_CHECK(insertKey(tree, &key, keyRid(key.v.intV)));
+    }
+  for(i = 0; i < numKeys; i++)
+    {
+      key.v.intV = i * 3;
+      TEST_CHECK(findKey(tree, &key, &rid));
+      ASSERT_EQUALS_RID(keyRid(key.v.intV), rid, "find every key after reinserting");
+    }
+
+  TEST_CHECK(closeBtree(tree));
+  TEST_CHECK(deleteBtree("testdeep"));
+
+  // an empty tree has nothing to scan
+  TEST_CHECK(createBtree("testdeep", DT_INT, 2));
+  TEST_CHECK(openBtree(&tree, "testdeep"));
+  TEST_CHECK(openTreeScan(tree, &sc));
+  ASSERT_EQUALS_INT(RC_IM_NO_MORE_ENTRIES, nextEntry(sc, &rid), "scan of an empty tree");
+  TEST_CHECK(closeTreeScan(sc));
+  key.v.intV = 3;
+  ASSERT_EQUALS_INT(RC_IM_KEY_NOT_FOUND, deleteKey(tree, &key), "delete from an empty tree");
+  TEST_CHECK(closeBtree(tree));
+  TEST_CHECK(deleteBtree("testdeep"));
+  TEST_CHECK(shutdownIndexManager());
+  free(permute);
+
+  TEST_DONE();
+}
+
+// ************************************************************
+void
+testIndexMaintenance (void)
+{
+  RM_TableData *table = (RM_TableData *) malloc(sizeof(RM_TableData));
+  int numInserts = 300, numBatch = 100, numRows = numInserts + numBatch;
+  int *keys = (int *) malloc(sizeof(int) * numRows);
+  RID *rids = (RID *) malloc(sizeof(RID) * numRows);
+  Record *batch[100];
+  Record *r;
+  Schema *schema;
+  BTreeHandle *tree = NULL;
+  RM_ScanHandle sc;
+  Value key, *lowKey, *highKey, *value;
+  RID rid;
+  int i, testint, tuples, live, last, rc;
+
+  testName = "attached B+ tree index follows inserts, updates and deletes";
+  schema = testSchema();
+  key.dt = DT_INT;
+
+  TEST_CHECK(initRecordManager(NULL));
+  TEST_CHECK(initIndexManager(NULL));
+  TEST_CHECK(createBtree("test_idx_a", DT_INT, 2));
+  TEST_CHECK(openBtree(&tree, "test_idx_a"));
+  TEST_CHECK(createTable("test_idx_t", schema));
+  TEST_CHECK(openTable(table, "test_idx_t"));
+  TEST_CHECK(attachIndex(table, 0, tree));
+
+  // single inserts, then one batch
+  for(i = 0; i < numInserts; i++)
+    {
+      keys[i] = i * 2;
+      r = testRecord(table->schema, keys[i], "aaaa", i);
+      TEST_CHECK(insertRecord(table, r));
+      rids[i] = r->id;
+      freeRecord(r);
+    }
+  for(i = 0; i < numBatch; i++)
+    {
+      keys[numInserts + i] = 2 * numInserts + i * 2;
+      batch[i] = testRecord(table->schema, keys[numInserts + i], "bbbb", i);
+    }
+  TEST_CHECK(insertRecords(table, batch, numBatch, rids + numInserts));
+  for(i = 0; i < numBatch; i++)
+    freeRecord(batch[i]);
+  TEST_CHECK(getNumEntries(tree, &testint));
+  ASSERT_EQUALS_INT(numRows, testint, "one entry per record");
+
+  // a duplicate key leaves both the table and the index as they were
+  tuples = getNumTuples(table);
+  r = testRecord(table->schema, 10, "cccc", 0);
+  ASSERT_ERROR(insertRecord(table, r), "insert a duplicate key");
+  freeRecord(r);
+  batch[0] = testRecord(table->schema, -1, "cccc", 0);
+  batch[1] = testRecord(table->schema, -1, "dddd", 0);
+  ASSERT_ERROR(insertRecords(table, batch, 2, NULL), "insert a batch with a duplicate key");
+  freeRecord(batch[0]);
+  freeRecord(batch[1]);
+  ASSERT_EQUALS_INT(tuples, getNumTuples(table), "no record was added");
+  TEST_CHECK(getNumEntries(tree, &testint));
+  ASSERT_EQUALS_INT(numRows, testint, "no entry was added");
+  key.v.intV = -1;
+  ASSERT_EQUALS_INT(RC_IM_KEY_NOT_FOUND, findKey(tree, &key, &rid), "key of the failed batch");
+
+  // delete every third record and move the key of the next one
+  for(i = 0; i < numRows; i++)
+    {
+      if (i % 3 == 0)
+        {
+          TEST_CHECK(deleteRecord(table, rids[i]));
+        }
+      else if (i % 3 == 1)
+        {
+          r = testRecord(table->schema, keys[i] + 1001, "eeee", i);
+          r->id = rids[i];
+          TEST_CHECK(updateRecord(table, r));
+          freeRecord(r);
+        }
+    }
+  r = testRecord(table->schema, keys[2], "ffff", 0);
+  r->id = rids[5];
+  ASSERT_ERROR(updateRecord(table, r), "update to a key another record has");
+  TEST_CHECK(getRecord(table, rids[5], r));
+  TEST_CHECK(getAttr(r, table->schema, 0, &value));
+  ASSERT_EQUALS_INT(keys[5], value->v.intV, "record keeps its key");
+  freeVal(value);
+  freeRecord(r);
+
+  // every record left is found under its current key, nothing else is
+  live = 0;
+  for(i = 0; i < numRows; i++)
+    {
+      key.v.intV = keys[i];
+      if (i % 3 == 2)
+        {
+          TEST_CHECK(findKey(tree, &key, &rid));
+          ASSERT_EQUALS_RID(rids[i], rid, "unchanged record");
+          live++;
+        }
+      else
+        ASSERT_EQUALS_INT(RC_IM_KEY_NOT_FOUND, findKey(tree, &key, &rid), "key of a deleted or moved record");
+      if (i % 3 == 1)
+        {
+          key.v.intV = keys[i] + 1001;
+          TEST_CHECK(findKey(tree, &key, &rid));
+          ASSERT_EQUALS_RID(rids[i], rid, "updated record under its new key");
+          live++;
+        }
+    }
+  TEST_CHECK(getNumEntries(tree, &testint));
+  ASSERT_EQUALS_INT(live, testint, "one entry per record left");
+  ASSERT_EQUALS_INT(live, getNumTuples(table), "records left");
+
+  // an index scan over the moved keys returns them in key order
+  lowKey = stringToValue("i1000");
+  highKey = stringToValue("i2000");
+  TEST_CHECK(startIndexScan(table, &sc, tree, lowKey, highKey, NULL));
+  TEST_CHECK(createRecord(&r, table->schema));
+  last = -1;
+  for(testint = 0; (rc = next(&sc, r)) == RC_OK; testint++)
+    {
+      TEST_CHECK(getAttr(r, table->schema, 0, &value));
+      ASSERT_TRUE(value->v.intV > last && value->v.intV % 2 == 1, "moved keys in ascending order");
+      last = value->v.intV;
+      freeVal(value);
+    }
+  ASSERT_EQUALS_INT(RC_RM_NO_MORE_TUPLES, rc, "index scan ends");
+  for(i = 0, live = 0; i < numRows; i++)
+    live += (indexKeyOf(i, keys) >= 1000 && indexKeyOf(i, keys) <= 2000);
+  ASSERT_EQUALS_INT(live, testint, "records in the key range");
+  TEST_CHECK(closeScan(&sc));
+  freeRecord(r);
+  freeVal(lowKey);
+  freeVal(highKey);
+
+  TEST_CHECK(closeTable(table));
+  TEST_CHECK(deleteTable("test_idx_t"));
+  TEST_CHECK(shutdownRecordManager());
+  TEST_CHECK(closeBtree(tree));
+  TEST_CHECK(deleteBtree("test_idx_a"));
+  TEST_CHECK(shutdownIndexManager());
+  freeSchema(schema);
+  free(table);
+  free(keys);
+  free(rids);
+
+  TEST_DONE();
+}
+
+// ************************************************************
+void
+testLzCodec (void)
+{
+  char *src = (char *) malloc(PAGE_SIZE);
+  char *packed = (char *) malloc(PAGE_SIZE);
+  char *damaged = (char *) malloc(PAGE_SIZE);
+  char *out = (char *) malloc(PAGE_SIZE);
+  SM_FileHandle fh;
+  int kind, len, k, wrong, rc;
+
+  testName = "LZ page codec: round trips, truncated and damaged input";
+
+  // kind 0 is a page of zeros, 1 repeated records, 2 random bytes
+  for(kind = 0; kind < 3; kind++)
+    {
+      fillPage(src, kind);
+      len = lzCompress(src, PAGE_SIZE, packed, PAGE_SIZE - 1);
+      if (kind == 2)
+        {
+          ASSERT_EQUALS_INT(-1, len, "random bytes do not compress");
+          continue;
+        }
+      ASSERT_TRUE(len > 0 && len < PAGE_SIZE / 4, "page shrinks");
+      TEST_CHECK(lzDecompress(packed, len, out, PAGE_SIZE));
+      ASSERT_TRUE(memcmp(src, out, PAGE_SIZE) == 0, "round trip restores the page");
+
+      // a cut off stream may only decode if nothing but an empty last token is missing
+      wrong = 0;
+      for(k = 0; k < len; k++)
+        if (lzDecompress(packed, k, out, PAGE_SIZE) == RC_OK && memcmp(src, out, PAGE_SIZE) != 0)
+          wrong++;
+      ASSERT_EQUALS_INT(0, wrong, "truncated input is rejected");
+      ASSERT_ERROR(lzDecompress(packed, len / 2, out, PAGE_SIZE), "half the input");
+      ASSERT_ERROR(lzDecompress(packed, len, out, PAGE_SIZE - 1), "output buffer too short");
+
+      // damaged input must neither overrun a buffer nor fail with anything else
+      wrong = 0;
+      for(k = 0; k < 500; k++)
+        {
+          memcpy(damaged, packed, len);
+          damaged[rand() % len] ^= (char) (1 + rand() % 255);
+          rc = lzDecompress(damaged, len, out, PAGE_SIZE);
+          if (rc != RC_OK && rc != RC_READING_FAILED)
+            wrong++;
+        }
+      ASSERT_EQUALS_INT(0, wrong, "damaged input fails cleanly");
+    }
+
+  // a compressed page file reads back what was written, also after a page moved to a larger slot
+  TEST_CHECK(createCompressedPageFile("testlz.bin"));
+  TEST_CHECK(openPageFile("testlz.bin", &fh));
+  ASSERT_TRUE(fh.compressed, "compressed file recognized");
+  TEST_CHECK(ensureCapacity(4, &fh));
+  fillPage(src, 1);
+  TEST_CHECK(writeBlock(1, &fh, src));
+  fillPage(src, 2);
+  TEST_CHECK(writeBlock(3, &fh, src));
+  TEST_CHECK(readBlock(3, &fh, out));
+  ASSERT_TRUE(memcmp(src, out, PAGE_SIZE) == 0, "incompressible page stored as is");
+  fillPage(src, 0);
+  TEST_CHECK(readBlock(2, &fh, out));
+  ASSERT_TRUE(memcmp(src, out, PAGE_SIZE) == 0, "unwritten page reads as zeros");
+  fillPage(src, 1);
+  TEST_CHECK(readBlock(1, &fh, out));
+  ASSERT_TRUE(memcmp(src, out, PAGE_SIZE) == 0, "compressed page read back");
+  fillPage(src, 2);
+  TEST_CHECK(writeBlock(1, &fh, src));
+  TEST_CHECK(readBlock(1, &fh, out));
+  ASSERT_TRUE(memcmp(src, out, PAGE_SIZE) == 0, "page grown into a new slot read back");
+  ASSERT_EQUALS_INT(RC_READ_NON_EXISTING_PAGE, readBlock(4, &fh, out), "page past the end");
+  TEST_CHECK(closePageFile(&fh));
+  TEST_CHECK(destroyPageFile("testlz.bin"));
+
+  free(src);
+  free(packed);
+  free(damaged);
+  free(out);
+
+  TEST_DONE();
+}
+
+// ************************************************************
+void
+testVacuum (void)
+{
+  RM_TableData *table = (RM_TableData *) malloc(sizeof(RM_TableData));
+  int numInserts = 3000, numKept = 500, numReinserts = 2000;
+  RID *rids = (RID *) malloc(sizeof(RID) * numInserts);
+  Schema *schema = testSchema();
+  Record *r;
+  Value *value;
+  long sizeBefore, sum, expectedSum;
+  int compressed, i, bad;
+
+  testName = "vacuum after deletes, then reinsert and scan, on plain and compressed tables";
+
+  TEST_CHECK(initRecordManager(NULL));
+  for(compressed = 0; compressed < 2; compressed++)
+    {
+      if (compressed)
+        {
+          TEST_CHECK(createCompressedTable("test_vacuum_t", schema, RM_LAYOUT_ROW));
+        }
+      else
+        {
+          TEST_CHECK(createTable("test_vacuum_t", schema));
+        }
+      TEST_CHECK(openTable(table, "test_vacuum_t"));
+      for(i = 0; i < numInserts; i++)
+        {
+          r = testRecord(table->schema, i, "aaaa", i % 7);
+          TEST_CHECK(insertRecord(table, r));
+          rids[i] = r->id;
+          freeRecord(r);
+        }
+      // closing writes every page back, so the file has its full size
+      TEST_CHECK(closeTable(table));
+      TEST_CHECK(openTable(table, "test_vacuum_t"));
+      sizeBefore = fileSize("test_vacuum_t");
+
+      // keep the even records of the first pages only
+      expectedSum = 0;
+      for(i = 0; i < numInserts; i++)
+        {
+          if (i < 2 * numKept && i % 2 == 0)
+            {
+              expectedSum += i;
+            }
+          else
+            {
+              TEST_CHECK(deleteRecord(table, rids[i]));
+            }
+        }
+      TEST_CHECK(vacuumTable(table));
+      ASSERT_TRUE(fileSize("test_vacuum_t") < sizeBefore, "empty pages at the end are cut off");
+      ASSERT_EQUALS_INT(numKept, getNumTuples(table), "records left after vacuum");
+
+      // records keep their RIDs
+      bad = 0;
+      TEST_CHECK(createRecord(&r, table->schema));
+      for(i = 0; i < 2 * numKept; i += 2)
+        {
+          TEST_CHECK(getRecord(table, rids[i], r));
+          TEST_CHECK(getAttr(r, table->schema, 0, &value));
+          bad += value->v.intV != i;
+          freeVal(value);
+        }
+      freeRecord(r);
+      ASSERT_EQUALS_INT(0, bad, "kept records found under their RIDs");
+      ASSERT_EQUALS_INT(numKept, scanTable(table, &sum), "scan after vacuum");
+      ASSERT_TRUE(sum == expectedSum, "scan returns the kept records");
+
+      // the space given back is used again, also for pages past the old end of the file
+      for(i = 0; i < numReinserts; i++)
+        {
+          r = testRecord(table->schema, numInserts + i, "bbbb", i % 7);
+          TEST_CHECK(insertRecord(table, r));
+          expectedSum += numInserts + i;
+          freeRecord(r);
+        }
+      ASSERT_EQUALS_INT(numKept + numReinserts, scanTable(table, &sum), "scan after reinserting");
+      ASSERT_TRUE(sum == expectedSum, "scan returns old and new records");
+      TEST_CHECK(closeTable(table));
+      TEST_CHECK(openTable(table, "test_vacuum_t"));
+      ASSERT_EQUALS_INT(numKept + numReinserts, scanTable(table, &sum), "scan after reopening");
+      ASSERT_TRUE(sum == expectedSum, "records survive reopening");
+      TEST_CHECK(closeTable(table));
+      TEST_CHECK(deleteTable("test_vacuum_t"));
+    }
+  TEST_CHECK(shutdownRecordManager());
+  freeSchema(schema);
+  free(table);
+  free(rids);
+
+  TEST_DONE();
+}
+
+// ************************************************************
+void
+testMultiGet (void)
+{
+  RM_TableData *table = (RM_TableData *) malloc(sizeof(RM_TableData));
+  int numInserts = 2000, numIds = 9, numShuffled = 300;
+  RID *rids = (RID *) malloc(sizeof(RID) * numInserts);
+  RID ids[300];
+  Record *out[300];
+  int expected[300];
+  int *permute = shuffledInts(numInserts);
+  Schema *schema = testSchema();
+  Record *r;
+  Value *value;
+  int i, bad;
+
+  testName = "getRecords with duplicate, invalid and free-space map RIDs";
+
+  TEST_CHECK(initRecordManager(NULL));
+  TEST_CHECK(createTable("test_multiget_t", schema));
+  TEST_CHECK(openTable(table, "test_multiget_t"));
+  for(i = 0; i < numInserts; i++)
+    {
+      r = testRecord(table->schema, i, "aaaa", i % 7);
+      TEST_CHECK(insertRecord(table, r));
+      rids[i] = r->id;
+      freeRecord(r);
+    }
+  TEST_CHECK(deleteRecord(table, rids[7]));
+
+  // expected[i] is the key of the record of ids[i], -1 for a RID without one
+  ids[0] = rids[1500]; expected[0] = 1500;
+  ids[1] = rids[5]; expected[1] = 5;
+  ids[2] = rids[5]; expected[2] = 5;
+  ids[3].page = FSM_FIRST_PAGE; ids[3].slot = 0; expected[3] = -1;
+  ids[4] = rids[0]; expected[4] = 0;
+  ids[5].page = 99999; ids[5].slot = 0; expected[5] = -1;
+  ids[6].page = rids[1].page; ids[6].slot = 9999; expected[6] = -1;
+  ids[7] = rids[7]; expected[7] = -1;
+  ids[8].page = -1; ids[8].slot = -1; expected[8] = -1;
+  for(i = 0; i < numShuffled; i++)
+    TEST_CHECK(createRecord(&out[i], table->schema));
+
+  ASSERT_EQUALS_INT(RC_RM_NO_TUPLE_WITH_GIVEN_RID, getRecords(table, ids, numIds, out), "some RIDs hold no record");
+  for(i = 0; i < numIds; i++)
+    {
+      if (expected[i] < 0)
+        {
+          ASSERT_TRUE(out[i]->id.page == -1 && out[i]->id.slot == -1, "RID without a record");
+          continue;
+        }
+      ASSERT_EQUALS_RID(ids[i], out[i]->id, "record of the RID at this position");
+      TEST_CHECK(getAttr(out[i], table->schema, 0, &value));
+      ASSERT_EQUALS_INT(expected[i], value->v.intV, "key of the record");
+      freeVal(value);
+    }
+
+  // RIDs in random order come back in the caller's order
+  for(i = 0; i < numShuffled; i++)
+    ids[i] = rids[permute[i] == 7 ? 8 : permute[i]];
+  TEST_CHECK(getRecords(table, ids, numShuffled, out));
+  bad = 0;
+  for(i = 0; i < numShuffled; i++)
+    {
+      TEST_CHECK(getAttr(out[i], table->schema, 0, &value));
+      bad += value->v.intV != (permute[i] == 7 ? 8 : permute[i]);
+      freeVal(value);
+    }
+  ASSERT_EQUALS_INT(0, bad, "records in the order of their RIDs");
+  TEST_CHECK(getRecords(table, ids, 0, out));
+
+  for(i = 0; i < numShuffled; i++)
+    freeRecord(out[i]);
+  TEST_CHECK(closeTable(table));
+  TEST_CHECK(deleteTable("test_multiget_t"));
+  TEST_CHECK(shutdownRecordManager());
+  freeSchema(schema);
+  free(table);
+  free(rids);
+  free(permute);
+
+  TEST_DONE();
+}
+
+// ************************************************************
+void
+testCustomPolicy (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  CountingPolicy state = { 0, 0, 0, 0, 0 };
+  BM_ReplacementPolicy policy = { countingOnHit, countingOnLoad, fixedVictim,
+                                  countingOnEvict, countingOnUnpin, &state };
+  BM_ReplacementPolicy noVictim = { NULL, NULL, NULL, NULL, NULL, NULL };
+  PageNumber loaded[] = { 0, 1, 2 };
+  PageNumber replaced[] = { 0, 3, 2 };
+
+  testName = "RS_CUSTOM policy hooks drive replacement";
+
+  TEST_CHECK(createPageFile("testcustom.bin"));
+  ASSERT_EQUALS_INT(RC_STRATEGY_NOT_SUPPORTED, initBufferPool(bm, "testcustom.bin", 3, RS_CUSTOM, &noVictim), "a policy needs chooseVictim");
+  ASSERT_EQUALS_INT(RC_STRATEGY_NOT_SUPPORTED, initBufferPool(bm, "testcustom.bin", 3, RS_CUSTOM, NULL), "RS_CUSTOM needs a policy");
+  TEST_CHECK(initBufferPool(bm, "testcustom.bin", 3, RS_CUSTOM, &policy));
+
+  touchPage(bm, 0);
+  touchPage(bm, 1);
+  touchPage(bm, 2);
+  touchPage(bm, 0);
+  ASSERT_TRUE(sameFrames(bm, loaded), "empty frames are filled without asking the policy");
+  ASSERT_EQUALS_INT(3, state.loads, "onLoad per page read");
+  ASSERT_EQUALS_INT(1, state.hits, "onHit per resident page pinned again");
+  ASSERT_EQUALS_INT(4, state.unpins, "onUnpin per unpin");
+  ASSERT_EQUALS_INT(0, state.evictions, "nothing evicted yet");
+
+  // the pool evicts whatever frame the policy picks
+  state.victim = 1;
+  touchPage(bm, 3);
+  ASSERT_TRUE(sameFrames(bm, replaced), "page 3 replaces the frame chosen by the policy");
+  ASSERT_EQUALS_INT(1, state.evictions, "onEvict before the frame is reused");
+
+  // no victim means no space, and the frames stay as they are
+  state.victim = -1;
+  ASSERT_EQUALS_INT(RC_NO_SPACE_IN_POOL, pinPage(bm, h, 4), "policy refused to evict");
+  ASSERT_TRUE(sameFrames(bm, replaced), "frames are untouched");
+  ASSERT_EQUALS_INT(1, state.evictions, "no eviction on refusal");
+
+  // a pinned frame is never handed out, even if the policy asks for it
+  state.victim = 0;
+  TEST_CHECK(pinPage(bm, h, 0));
+  ASSERT_EQUALS_INT(RC_NO_SPACE_IN_POOL, pinPage(bm, h, 5), "policy picked a pinned frame");
+  h->pageNum = 0;
+  TEST_CHECK(unpinPage(bm, h));
+
+  TEST_CHECK(shutdownBufferPool(bm));
+  TEST_CHECK(destroyPageFile("testcustom.bin"));
+  free(bm);
+  free(h);
+
+  TEST_DONE();
+}
+
+// ************************************************************
+void
+testVictimOrder (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  PageNumber fifo[] = { 3, 1, 2 };
+  PageNumber lru[] = { 0, 3, 2 };
+  PageNumber clock1[] = { 3, 1, 2 };
+  PageNumber clock2[] = { 3, 1, 4 };
+  PageNumber lfu1[] = { 0, 3, 2 };
+  PageNumber lfu2[] = { 0, 4, 2 };
+
+  testName = "built-in strategies pick their victims in the expected order";
+
+  TEST_CHECK(createPageFile("testvictim.bin"));
+
+  // FIFO ignores the hit on page 0 and evicts the page loaded first
+  TEST_CHECK(initBufferPool(bm, "testvictim.bin", 3, RS_FIFO, NULL));
+  touchPage(bm, 0);
+  touchPage(bm, 1);
+  touchPage(bm, 2);
+  touchPage(bm, 0);
+  touchPage(bm, 3);
+  ASSERT_TRUE(sameFrames(bm, fifo), "FIFO evicts the oldest load");
+  TEST_CHECK(shutdownBufferPool(bm));
+
+  // LRU keeps page 0 because of the hit
+  TEST_CHECK(initBufferPool(bm, "testvictim.bin", 3, RS_LRU, NULL));
+  touchPage(bm, 0);
+  touchPage(bm, 1);
+  touchPage(bm, 2);
+  touchPage(bm, 0);
+  touchPage(bm, 3);
+  ASSERT_TRUE(sameFrames(bm, lru), "LRU evicts the least recently used page");
+  TEST_CHECK(shutdownBufferPool(bm));
+
+  // CLOCK clears every reference bit on the first sweep and takes frame 0,
+  // then the hit on page 1 gives it a second chance over page 2
+  TEST_CHECK(initBufferPool(bm, "testvictim.bin", 3, RS_CLOCK, NULL));
+  touchPage(bm, 0);
+  touchPage(bm, 1);
+  touchPage(bm, 2);
+  touchPage(bm, 3);
+  ASSERT_TRUE(sameFrames(bm, clock1), "CLOCK evicts at the hand once all bits are cleared");
+  touchPage(bm, 1);
+  touchPage(bm, 4);
+  ASSERT_TRUE(sameFrames(bm, clock2), "CLOCK skips the referenced page");
+  TEST_CHECK(shutdownBufferPool(bm));
+
+  // LFU evicts the page never hit, then the fresh page 3 over page 2 hit once
+  TEST_CHECK(initBufferPool(bm, "testvictim.bin", 3, RS_LFU, NULL));
+  touchPage(bm, 0);
+  touchPage(bm, 1);
+  touchPage(bm, 2);
+  touchPage(bm, 0);
+  touchPage(bm, 0);
+  touchPage(bm, 2);
+  touchPage(bm, 3);
+  ASSERT_TRUE(sameFrames(bm, lfu1), "LFU evicts the least used page");
+  touchPage(bm, 4);
+  ASSERT_TRUE(sameFrames(bm, lfu2), "LFU evicts the new page with no hits");
+  TEST_CHECK(shutdownBufferPool(bm));
+
+  TEST_CHECK(destroyPageFile("testvictim.bin"));
+  free(bm);
+
+  TEST_DONE();
+}
+
+// ************************************************************
+void
+testAdaptiveSwitch (void)
+{
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_AdaptiveState *state;
+  int scan = 0;
+  int round, i;
+
+  testName = "RS_ADAPTIVE follows the workload and resizes its shadow caches";
+
+  TEST_CHECK(createPageFile("testadaptive.bin"));
+  TEST_CHECK(initBufferPool(bm, "testadaptive.bin", 16, RS_ADAPTIVE, NULL));
+  ASSERT_EQUALS_INT(RS_LRU, getLiveStrategy(bm), "LRU is live initially");
+
+  // two passes over 8 hot pages, then 16 pages of a long scan: the scan
+  // pushes the hot pages out of LRU, FIFO and CLOCK, LFU keeps them
+  for(round = 0; round < 32; round++)
+    {
+      for(i = 0; i < 16; i++)
+        touchPage(bm, i % 8);
+      for(i = 0; i < 16; i++)
+        touchPage(bm, 100 + scan++ % 400);
+    }
+  ASSERT_EQUALS_INT(RS_LFU, getLiveStrategy(bm), "scan-heavy pattern elects LFU");
+
+  // a loop over 12 pages fits the pool, but LFU still holds the hot pages
+  for(i = 0; i < 1024; i++)
+    touchPage(bm, 500 + i % 12);
+  ASSERT_TRUE(getLiveStrategy(bm) != RS_LFU, "loop pattern moves away from LFU");
+  ASSERT_EQUALS_INT(RS_FIFO, getLiveStrategy(bm), "first of the equally good strategies wins");
+
+  // the shadow caches follow the pool size
+  state = (BM_AdaptiveState *) bm->policy->data;
+  TEST_CHECK(resizeBufferPool(bm, 64));
+  ASSERT_EQUALS_INT(4, state->sampleRate, "64 frames are simulated on a quarter of the pages");
+  ASSERT_EQUALS_INT(16, state->shadows[0].numFrames, "shadow size of the grown pool");
+  TEST_CHECK(resizeBufferPool(bm, 8));
+  ASSERT_EQUALS_INT(1, state->sampleRate, "a small pool is simulated on every page");
+  for(i = 0; i < ADAPTIVE_NUM_SHADOWS; i++)
+    ASSERT_EQUALS_INT(8, state->shadows[i].numFrames, "shadow size of the shrunk pool");
+  ASSERT_EQUALS_INT(RS_FIFO, getLiveStrategy(bm), "resizing keeps the live strategy");
+  for(i = 0; i < 600; i++)
+    touchPage(bm, 500 + i % 12);
+
+  TEST_CHECK(shutdownBufferPool(bm));
+  TEST_CHECK(destroyPageFile("testadaptive.bin"));
+  free(bm);
+
+  TEST_DONE();
+}
+
+// ************************************************************
+void
+testMemoryGovernor (void)
+{
+  char *files[] = { "testgov_a.bin", "testgov_b.bin", "testgov_c.bin", "testgov_d.bin" };
+  BM_BufferPool *pools = (BM_BufferPool *) malloc(sizeof(BM_BufferPool) * 4);
+  BM_BufferPool *a = &pools[0], *b = &pools[1], *c = &pools[2], *d = &pools[3];
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  int readIO, i;
+
+  testName = "memory governor caps, shrinks and rebalances the buffer pools";
+
+  for(i = 0; i < 4; i++)
+    TEST_CHECK(createPageFile(files[i]));
+  TEST_CHECK(setBufferMemoryBudget(12));
+
+  // the second pool takes what the first can give without going below GOVERNOR_MIN_FRAMES
+  TEST_CHECK(initBufferPool(a, files[0], 10, RS_LRU, NULL));
+  ASSERT_EQUALS_INT(10, a->numPages, "first pool fits the budget");
+  TEST_CHECK(initBufferPool(b, files[1], 10, RS_LRU, NULL));
+  ASSERT_EQUALS_INT(GOVERNOR_MIN_FRAMES, a->numPages, "first pool shrunk to its minimum");
+  ASSERT_EQUALS_INT(8, b->numPages, "second pool got fewer frames than it asked for");
+  ASSERT_EQUALS_INT(12, getBufferMemoryUsage(), "the whole budget is in use");
+  ASSERT_EQUALS_INT(RC_MEMORY_BUDGET_EXCEEDED, resizeBufferPool(a, 6), "no frame left to grow");
+
+  // dirty pages in the frames given up are written back
+  for(i = 0; i < 8; i++)
+    {
+      TEST_CHECK(pinPage(b, h, i));
+      sprintf(h->data, "page-%i", i);
+      TEST_CHECK(markDirty(b, h));
+      TEST_CHECK(unpinPage(b, h));
+    }
+  ASSERT_EQUALS_INT(0, getNumWriteIO(b), "nothing written yet");
+  TEST_CHECK(initBufferPool(c, files[2], 10, RS_LRU, NULL));
+  ASSERT_EQUALS_INT(GOVERNOR_MIN_FRAMES, b->numPages, "second pool shrunk to its minimum");
+  ASSERT_EQUALS_INT(GOVERNOR_MIN_FRAMES, c->numPages, "third pool got the rest");
+  ASSERT_EQUALS_INT(4, getNumWriteIO(b), "the pages of the dropped frames were written");
+  TEST_CHECK(pinPage(b, h, 6));
+  ASSERT_EQUALS_STRING("page-6", h->data, "written page reads back");
+  TEST_CHECK(unpinPage(b, h));
+
+  // every pool is at its minimum, so nothing is left for a fourth
+  ASSERT_EQUALS_INT(RC_MEMORY_BUDGET_EXCEEDED, initBufferPool(d, files[3], 10, RS_LRU, NULL), "budget exhausted");
+  ASSERT_EQUALS_INT(12, getBufferMemoryUsage(), "the failed pool holds no frames");
+
+  // shrinking stops at a pinned frame
+  for(i = 0; i < 4; i++)
+    touchPage(a, i);
+  TEST_CHECK(pinPage(a, h, 3));
+  ASSERT_EQUALS_INT(RC_PINNED_PAGES_IN_BUFFER, resizeBufferPool(a, 2), "frame 3 is pinned");
+  ASSERT_EQUALS_INT(4, a->numPages, "pool kept the pinned frame");
+  TEST_CHECK(unpinPage(a, h));
+  TEST_CHECK(resizeBufferPool(a, 2));
+  ASSERT_EQUALS_INT(2, a->numPages, "pool shrunk once the page was unpinned");
+
+  TEST_CHECK(shutdownBufferPool(a));
+  TEST_CHECK(shutdownBufferPool(b));
+  TEST_CHECK(shutdownBufferPool(c));
+
+  // a loop one page larger than its pool keeps missing on pages it just
+  // evicted, a scan never does, so after GOVERNOR_INTERVAL misses frames move
+  // from the scanning pool to the looping one
+  TEST_CHECK(setBufferMemoryBudget(16));
+  TEST_CHECK(initBufferPool(a, files[0], 8, RS_LRU, NULL));
+  TEST_CHECK(initBufferPool(b, files[1], 8, RS_LRU, NULL));
+  for(i = 0; i < GOVERNOR_INTERVAL / 2; i++)
+    {
+      touchPage(a, i % 9);
+      touchPage(b, 100 + i);
+    }
+  ASSERT_EQUALS_INT(8 + GOVERNOR_MIN_FRAMES, a->numPages, "looping pool grew");
+  ASSERT_EQUALS_INT(GOVERNOR_MIN_FRAMES, b->numPages, "scanning pool shrunk");
+  ASSERT_EQUALS_INT(16, getBufferMemoryUsage(), "rebalancing stays within the budget");
+  touchPage(a, 5);
+  readIO = getNumReadIO(a);
+  for(i = 0; i < 18; i++)
+    touchPage(a, i % 9);
+  ASSERT_EQUALS_INT(readIO, getNumReadIO(a), "the whole loop fits now");
+
+  TEST_CHECK(shutdownBufferPool(a));
+  TEST_CHECK(shutdownBufferPool(b));
+  TEST_CHECK(setBufferMemoryBudget(0));
+  for(i = 0; i < 4; i++)
+    TEST_CHECK(destroyPageFile(files[i]));
+  free(pools);
+  free(h);
+
+  TEST_DONE();
+}
+
+// ************************************************************
+void
+testSlottedPage (void)
+{
+  char *page = (char *) malloc(PAGE_SIZE);
+  char record[64], *stored;
+  int slots[400], lengths[400];
+  int numSlots, slot, length, freeBytes, i;
+
+  testName = "slotted page: free slot reuse, growing updates and stable slots across compaction";
+
+  initSlottedPage(page);
+  ASSERT_EQUALS_INT(PAGE_SIZE - PAGE_HEADER_LEN - SLOT_ENTRY_LEN, getPageFreeBytes(page), "empty page");
+  for(i = 0; i < 3; i++)
+    {
+      memset(record, 'a' + i, 10 * (i + 1));
+      slot = insertSlot(page, record, 10 * (i + 1));
+      ASSERT_EQUALS_INT(i, slot, "new slots are appended");
+    }
+  ASSERT_EQUALS_INT(PAGE_SIZE - PAGE_HEADER_LEN - 4 * SLOT_ENTRY_LEN - 60, getPageFreeBytes(page), "free bytes after three records");
+
+  // tombstones are reused last deleted first, without growing the directory
+  TEST_CHECK(deleteSlot(page, 1));
+  ASSERT_TRUE(getSlot(page, 1, NULL) == NULL, "deleted slot holds no record");
+  ASSERT_ERROR(deleteSlot(page, 1), "slot already deleted");
+  ASSERT_EQUALS_INT(2, getLiveSlots(page), "two records left");
+  TEST_CHECK(deleteSlot(page, 0));
+  memset(record, 'x', 15);
+  slot = insertSlot(page, record, 15);
+  ASSERT_EQUALS_INT(0, slot, "last tombstone reused first");
+  slot = insertSlot(page, record, 5);
+  ASSERT_EQUALS_INT(1, slot, "then the one deleted before");
+  slot = insertSlot(page, record, 5);
+  ASSERT_EQUALS_INT(3, slot, "free slot list is empty again");
+  ASSERT_EQUALS_INT(4, getNumSlots(page), "directory grew once");
+  ASSERT_EQUALS_INT(4, getLiveSlots(page), "four records");
+
+  // an update growing the record keeps its slot and leaves the others alone
+  memset(record, 'g', 50);
+  TEST_CHECK(updateSlot(page, 0, record, 50));
+  stored = getSlot(page, 0, &length);
+  ASSERT_EQUALS_INT(50, length, "grown record length");
+  ASSERT_TRUE(memcmp(stored, record, 50) == 0, "grown record content");
+  stored = getSlot(page, 2, &length);
+  ASSERT_EQUALS_INT(30, length, "neighbour length");
+  ASSERT_TRUE(stored[0] == 'c' && stored[29] == 'c', "neighbour content");
+  TEST_CHECK(updateSlot(page, 0, record, 8));
+  getSlot(page, 0, &length);
+  ASSERT_EQUALS_INT(8, length, "shrunk in place");
+  ASSERT_ERROR(updateSlot(page, 0, page, PAGE_SIZE), "record larger than the page");
+
+  // fill the page, delete every other record and compact
+  initSlottedPage(page);
+  for(numSlots = 0; numSlots < 400; numSlots++)
+    {
+      lengths[numSlots] = 8 + numSlots % 40;
+      memset(record, numSlots % 250 + 1, lengths[numSlots]);
+      slots[numSlots] = insertSlot(page, record, lengths[numSlots]);
+      if (slots[numSlots] < 0)
+        break;
+      ASSERT_EQUALS_INT(numSlots, slots[numSlots], "slot of the next record");
+    }
+  ASSERT_TRUE(numSlots < 400, "page filled up");
+  ASSERT_TRUE(getPageFreeBytes(page) < lengths[numSlots], "free bytes agree with the failed insert");
+  for(i = 0; i < numSlots; i += 2)
+    TEST_CHECK(deleteSlot(page, i));
+  freeBytes = getPageFreeBytes(page);
+  compactPage(page);
+  ASSERT_EQUALS_INT(freeBytes, getPageFreeBytes(page), "compaction only makes free space contiguous");
+  for(i = 0; i < numSlots; i++)
+    {
+      stored = getSlot(page, i, &length);
+      if (i % 2 == 0)
+        {
+          ASSERT_TRUE(stored == NULL, "tombstone survives compaction");
+          continue;
+        }
+      ASSERT_EQUALS_INT(lengths[i], length, "record length after compaction");
+      ASSERT_TRUE(stored[0] == (char) (i % 250 + 1) && stored[length - 1] == (char) (i % 250 + 1), "record under the same slot after compaction");
+    }
+
+  // deleted space is found again through compaction inside insertSlot, and
+  // the tombstones are reused instead of growing the directory
+  for(i = 1; i < numSlots; i += 2)
+    TEST_CHECK(deleteSlot(page, i));
+  memset(record, 'z', 60);
+  for(i = 0; insertSlot(page, record, 60) >= 0; i++)
+    ;
+  ASSERT_EQUALS_INT((PAGE_SIZE - PAGE_HEADER_LEN - numSlots * SLOT_ENTRY_LEN) / 60, i, "every byte outside the directory is usable again");
+  ASSERT_EQUALS_INT(numSlots, getNumSlots(page), "directory did not grow");
+
+  free(page);
+
+  TEST_DONE();
+}
+
+// ************************************************************
+void
+testFreeSpaceMap (void)
+{
+  RM_TableData *table = (RM_TableData *) malloc(sizeof(RM_TableData));
+  Schema *schema = testSchema();
+  RID rids[1000];
+  Record *r;
+  int firstPage, numRecords, i;
+
+  testName = "free-space map sends inserts back to a page with room for one record";
+
+  TEST_CHECK(initRecordManager(NULL));
+  TEST_CHECK(createTable("test_fsm_t", schema));
+  TEST_CHECK(openTable(table, "test_fsm_t"));
+
+  // fill the first data page; the record spilling over starts the next one
+  for(numRecords = 0; numRecords < 1000; numRecords++)
+    {
+      r = testRecord(table->schema, numRecords, "aaaa", 0);
+      TEST_CHECK(insertRecord(table, r));
+      rids[numRecords] = r->id;
+      freeRecord(r);
+      if (rids[numRecords].page != rids[0].page)
+        break;
+    }
+  firstPage = rids[0].page;
+  ASSERT_EQUALS_INT(FSM_FIRST_PAGE + 1, firstPage, "records start after the free-space map");
+  ASSERT_EQUALS_INT((PAGE_SIZE - PAGE_HEADER_LEN) / (getRecordSize(schema) + SLOT_ENTRY_LEN), numRecords, "every record that fits went into the first page");
+
+  // the room of one deleted record is found again, not a new page
+  TEST_CHECK(deleteRecord(table, rids[numRecords / 2]));
+  r = testRecord(table->schema, -1, "bbbb", 0);
+  TEST_CHECK(insertRecord(table, r));
+  ASSERT_EQUALS_RID(rids[numRecords / 2], r->id, "insert went back into the freed slot");
+  freeRecord(r);
+
+  // the first page is full again, so the next insert goes to the second one
+  r = testRecord(table->schema, -2, "cccc", 0);
+  TEST_CHECK(insertRecord(table, r));
+  ASSERT_EQUALS_INT(rids[numRecords].page, r->id.page, "full page skipped");
+  freeRecord(r);
+
+  // the same holds after reopening, with the map read from disk
+  TEST_CHECK(closeTable(table));
+  TEST_CHECK(openTable(table, "test_fsm_t"));
+  for(i = 0; i < 3; i++)
+    TEST_CHECK(deleteRecord(table, rids[i * 7]));
+  for(i = 0; i < 3; i++)
+    {
+      r = testRecord(table->schema, -3 - i, "dddd", 0);
+      TEST_CHECK(insertRecord(table, r));
+      ASSERT_EQUALS_INT(firstPage, r->id.page, "reopened table refills the first page");
+      freeRecord(r);
+    }
+  ASSERT_EQUALS_INT(numRecords + 2, getNumTuples(table), "number of records");
+
+  TEST_CHECK(closeTable(table));
+  TEST_CHECK(deleteTable("test_fsm_t"));
+  TEST_CHECK(shutdownRecordManager());
+  freeSchema(schema);
+  free(table);
+
+  TEST_DONE();
+}
+
+// ************************************************************
+void
+testBulkInsert (void)
+{
+  RM_TableData *table = (RM_TableData *) malloc(sizeof(RM_TableData));
+  Schema *schema = testSchema();
+  // enough records for a few RM_EXTENT_PAGES extents of data pages
+  int numInserts = 3 * RM_EXTENT_PAGES * (PAGE_SIZE / 16);
+  int numRefill = 0;
+  Record **records = (Record **) malloc(sizeof(Record *) * numInserts);
+  RID *ids = (RID *) malloc(sizeof(RID) * numInserts);
+  RID *holes = (RID *) malloc(sizeof(RID) * numInserts);
+  RecordManager *mgr;
+  Record *r;
+  Value *value;
+  int numPages, ordered, lastPage, i;
+  long sum;
+
+  testName = "insertRecords packs a batch spanning several extents and refills freed slots";
+
+  TEST_CHECK(initRecordManager(NULL));
+  TEST_CHECK(createTable("test_bulk_t", schema));
+  TEST_CHECK(openTable(table, "test_bulk_t"));
+  for(i = 0; i < numInserts; i++)
+    records[i] = testRecord(table->schema, i, "bulk", i % 5);
+  TEST_CHECK(insertRecords(table, records, numInserts, ids));
+
+  // RIDs follow the batch order, page after page, and never name a map page
+  ordered = 1;
+  for(i = 0; i < numInserts; i++)
+    {
+      ordered &= ids[i].page == records[i]->id.page && ids[i].slot == records[i]->id.slot;
+      ordered &= ids[i].page > FSM_FIRST_PAGE && !isFsmPage(ids[i].page);
+      if (i > 0)
+        ordered &= (ids[i].page == ids[i - 1].page) ? ids[i].slot == ids[i - 1].slot + 1 : ids[i].page > ids[i - 1].page && ids[i].slot == 0;
+    }
+  ASSERT_TRUE(ordered, "outIds are the records' ids in page and slot order");
+  mgr = (RecordManager *) table->mgmtData;
+  numPages = mgr->numPages;
+  lastPage = ids[numInserts - 1].page;
+  ASSERT_EQUALS_INT(lastPage + 1, numPages, "table ends at the last page used");
+  ASSERT_TRUE(lastPage - FSM_FIRST_PAGE > 2 * RM_EXTENT_PAGES, "batch spans more than two extents");
+  ASSERT_TRUE(fileSize("test_bulk_t") / PAGE_SIZE >= numPages, "file holds every page");
+  ASSERT_TRUE(fileSize("test_bulk_t") / PAGE_SIZE <= numPages + RM_EXTENT_PAGES, "file grew by at most one extent ahead");
+  ASSERT_EQUALS_INT(numInserts, getNumTuples(table), "every record counted");
+
+  // the counters come back from the header page
+  TEST_CHECK(closeTable(table));
+  TEST_CHECK(openTable(table, "test_bulk_t"));
+  mgr = (RecordManager *) table->mgmtData;
+  ASSERT_EQUALS_INT(numInserts, getNumTuples(table), "tuple count after reopen");
+  ASSERT_EQUALS_INT(numPages, mgr->numPages, "number of pages after reopen");
+  ASSERT_EQUALS_INT(numInserts, scanTable(table, &sum), "scan finds every record");
+  ASSERT_TRUE(sum == (long) numInserts * (numInserts - 1) / 2, "scan sees every key once");
+  TEST_CHECK(createRecord(&r, table->schema));
+  for(i = 0; i < numInserts; i += 997)
+    {
+      TEST_CHECK(getRecord(table, ids[i], r));
+      TEST_CHECK(getAttr(r, table->schema, 0, &value));
+      ASSERT_EQUALS_INT(i, value->v.intV, "record under its RID");
+      freeVal(value);
+    }
+
+  // the next batch fills the slots freed in the first pages before appending
+  for(i = 0; i < numInserts && ids[i].page < ids[0].page + 3; i += 9)
+    {
+      TEST_CHECK(deleteRecord(table, ids[i]));
+      holes[numRefill++] = ids[i];
+    }
+  for(i = 0; i < numRefill + 3; i++)
+    {
+      freeRecord(records[i]);
+      records[i] = testRecord(table->schema, numInserts + i, "more", 0);
+    }
+  TEST_CHECK(insertRecords(table, records, numRefill + 3, ids));
+  // pages are refilled in order, the slots of a page last freed first
+  qsort(ids, numRefill, sizeof(RID), compareRids);
+  ordered = 1;
+  for(i = 0; i < numRefill; i++)
+    ordered &= ids[i].page == holes[i].page && ids[i].slot == holes[i].slot;
+  ASSERT_TRUE(ordered, "every freed slot reused");
+  for(i = numRefill; i < numRefill + 3; i++)
+    ASSERT_TRUE(ids[i].page >= lastPage, "the rest goes to the end of the table");
+  ASSERT_EQUALS_INT(numInserts + 3, getNumTuples(table), "tuple count after the second batch");
+  TEST_CHECK(closeTable(table));
+  TEST_CHECK(openTable(table, "test_bulk_t"));
+  ASSERT_EQUALS_INT(numInserts + 3, scanTable(table, &sum), "scan after the second batch");
+  ASSERT_EQUALS_INT(numInserts + 3, getNumTuples(table), "tuple count matches the scan");
+
+  freeRecord(r);
+  for(i = 0; i < numInserts; i++)
+    freeRecord(records[i]);
+  TEST_CHECK(closeTable(table));
+  TEST_CHECK(deleteTable("test_bulk_t"));
+  TEST_CHECK(shutdownRecordManager());
+  freeSchema(schema);
+  free(table);
+  free(records);
+  free(ids);
+  free(holes);
+
+  TEST_DONE();
+}
+
+// ************************************************************
+void
+testCatalog (void)
+{
+  char *names[] = { "test_cat_row", "test_cat_pax", "test_cat_dict" };
+  RM_TableData *tables = (RM_TableData *) malloc(sizeof(RM_TableData) * 3);
+  RM_TableData *again = (RM_TableData *) malloc(sizeof(RM_TableData));
+  Schema *schema = testSchema();
+  Schema *dictSchema = testSchema();
+  Schema *restored;
+  Record *r;
+  Value *value;
+  RID rid;
+  long sum;
+  int t, i;
+
+  testName = "catalog serves several open tables and restores them after a restart";
+
+  TEST_CHECK(initRecordManager(NULL));
+  TEST_CHECK(setDictionaryEncoding(dictSchema, 1, 2));
+  TEST_CHECK(createTable(names[0], schema));
+  TEST_CHECK(createTableWithLayout(names[1], schema, RM_LAYOUT_PAX));
+  TEST_CHECK(createTableWithLayout(names[2], dictSchema, RM_LAYOUT_ROW));
+
+  // all three open at once, each with its own records
+  for(t = 0; t < 3; t++)
+    TEST_CHECK(openTable(&tables[t], names[t]));
+  for(i = 0; i < 300; i++)
+    for(t = 0; t < 3; t++)
+      {
+        r = testRecord(tables[t].schema, t * 1000 + i, t == 2 ? (i % 2 ? "odd" : "even") : "abcd", i);
+        TEST_CHECK(insertRecord(&tables[t], r));
+        freeRecord(r);
+      }
+  for(t = 0; t < 3; t++)
+    {
+      ASSERT_EQUALS_INT(300, scanTable(&tables[t], &sum), "records of the table");
+      ASSERT_TRUE(sum == 300L * t * 1000 + 299L * 300 / 2, "keys of the table");
+    }
+
+  // a second open shares the handle, and the table stays open until both close
+  TEST_CHECK(openTable(again, names[0]));
+  ASSERT_TRUE(again->mgmtData == tables[0].mgmtData, "open handle is shared");
+  TEST_CHECK(closeTable(again));
+  ASSERT_EQUALS_INT(300, getNumTuples(&tables[0]), "table still open after one close");
+
+  // an open table can not be deleted or replaced, nor the manager shut down
+  ASSERT_ERROR(deleteTable(names[0]), "deleteTable refuses an open table");
+  ASSERT_ERROR(createTable(names[0], schema), "createTable refuses to replace an open table");
+  ASSERT_ERROR(shutdownRecordManager(), "shutdown refuses while a table is open");
+  ASSERT_EQUALS_INT(300, scanTable(&tables[0], &sum), "refused calls left the table alone");
+  for(t = 0; t < 3; t++)
+    TEST_CHECK(closeTable(&tables[t]));
+  TEST_CHECK(deleteTable(names[0]));
+  ASSERT_EQUALS_INT(RC_FILE_NOT_FOUND, openTable(again, names[0]), "deleted table left the catalog");
+  TEST_CHECK(shutdownRecordManager());
+
+  // schema, layout and code widths come back from the catalog file
+  TEST_CHECK(initRecordManager(NULL));
+  for(t = 1; t < 3; t++)
+    {
+      RM_CatalogEntry *entry = findCatalogEntry(names[t]);
+      ASSERT_TRUE(entry != NULL, "table is in the catalog");
+      ASSERT_EQUALS_INT(t == 1 ? RM_LAYOUT_PAX : RM_LAYOUT_ROW, entry->layout, "layout restored");
+      TEST_CHECK(openTable(&tables[t], names[t]));
+      restored = tables[t].schema;
+      ASSERT_EQUALS_INT(3, restored->numAttr, "number of attributes");
+      ASSERT_EQUALS_STRING("b", restored->attrNames[1], "attribute name");
+      ASSERT_EQUALS_INT(DT_STRING, restored->dataTypes[1], "data type");
+      ASSERT_EQUALS_INT(4, restored->typeLength[1], "type length");
+      ASSERT_EQUALS_INT(1, restored->keySize, "key size");
+      ASSERT_EQUALS_INT(0, restored->keyAttrs[0], "key attribute");
+      ASSERT_EQUALS_INT(t == 2 ? 2 : 0, restored->layout->codeBytes[1], "dictionary code width");
+      ASSERT_EQUALS_INT(getRecordSize(t == 2 ? dictSchema : schema), getRecordSize(restored), "record size");
+      ASSERT_EQUALS_INT(300, scanTable(&tables[t], &sum), "records after the restart");
+      ASSERT_TRUE(sum == 300L * t * 1000 + 299L * 300 / 2, "keys after the restart");
+    }
+  TEST_CHECK(createRecord(&r, tables[2].schema));
+  // record 3 is the fourth of the first data page
+  rid.page = FSM_FIRST_PAGE + 1;
+  rid.slot = 3;
+  TEST_CHECK(getRecord(&tables[2], rid, r));
+  TEST_CHECK(getAttr(r, tables[2].schema, 1, &value));
+  ASSERT_EQUALS_STRING("odd", value->v.stringV, "dictionary encoded string after the restart");
+  freeVal(value);
+  freeRecord(r);
+
+  for(t = 1; t < 3; t++)
+    {
+      TEST_CHECK(closeTable(&tables[t]));
+      TEST_CHECK(deleteTable(names[t]));
+    }
+  TEST_CHECK(shutdownRecordManager());
+  freeSchema(schema);
+  freeSchema(dictSchema);
+  free(tables);
+  free(again);
+
+  TEST_DONE();
+}
+
+// ************************************************************
+void
+testPaxTable (void)
+{
+  RM_TableData *table = (RM_TableData *) malloc(sizeof(RM_TableData));
+  Schema *schema = testSchema();
+  int capacity = getPaxCapacity(schema);
+  int numInserts = capacity + 50;
+  RID *rids = (RID *) malloc(sizeof(RID) * numInserts);
+  BM_PageHandle page;
+  RM_ScanHandle sc;
+  RecordManager *mgr;
+  Record *r;
+  Expr *sel;
+  char b[5];
+  int value, matches, pass, bad, i;
+
+  testName = "PAX table: record access, minipages and condition-only gathering";
+
+  TEST_CHECK(initRecordManager(NULL));
+  TEST_CHECK(createTableWithLayout("test_pax_t", schema, RM_LAYOUT_PAX));
+  TEST_CHECK(openTable(table, "test_pax_t"));
+  for(i = 0; i < numInserts; i++)
+    {
+      sprintf(b, "p%03i", i % 1000);
+      r = testRecord(table->schema, i, b, i % 7);
+      TEST_CHECK(insertRecord(table, r));
+      rids[i] = r->id;
+      freeRecord(r);
+    }
+  ASSERT_EQUALS_INT(FSM_FIRST_PAGE + 1, rids[capacity - 1].page, "every slot of the first page used");
+  ASSERT_EQUALS_INT(capacity - 1, rids[capacity - 1].slot, "slots fill in order");
+  ASSERT_EQUALS_INT(FSM_FIRST_PAGE + 2, rids[capacity].page, "next record starts the second page");
+
+  // one free slot is enough for the map to send an insert back to the page
+  TEST_CHECK(deleteRecord(table, rids[17]));
+  r = testRecord(table->schema, 17, "p017", 17 % 7);
+  TEST_CHECK(insertRecord(table, r));
+  ASSERT_EQUALS_RID(rids[17], r->id, "freed slot of the full page reused");
+  freeRecord(r);
+
+  // the values of an attribute are packed in its minipage, slot after slot
+  mgr = (RecordManager *) table->mgmtData;
+  TEST_CHECK(pinPage(&mgr->bufferPool, &page, rids[0].page));
+  bad = 0;
+  for(i = 0; i < capacity; i++)
+    {
+      memcpy(&value, getPaxColumn(page.data, table->schema, 2) + i * sizeof(int), sizeof(int));
+      bad += !isPaxSlotUsed(page.data, i) || value != i % 7;
+      memcpy(&value, getPaxColumn(page.data, table->schema, 0) + i * sizeof(int), sizeof(int));
+      bad += value != i;
+    }
+  bad += memcmp(getPaxColumn(page.data, table->schema, 1) + 5 * 4, "p005", 4) != 0;
+  ASSERT_EQUALS_INT(0, bad, "minipage values");
+  ASSERT_TRUE(!isPaxSlotUsed(page.data, capacity), "no slot past the capacity");
+  TEST_CHECK(unpinPage(&mgr->bufferPool, &page));
+
+  // update and delete through the minipages
+  r = testRecord(table->schema, 5, "upd5", 99);
+  r->id = rids[5];
+  TEST_CHECK(updateRecord(table, r));
+  freeRecord(r);
+  TEST_CHECK(deleteRecord(table, rids[capacity + 1]));
+
+  for(pass = 0; pass < 2; pass++)
+    {
+      TEST_CHECK(createRecord(&r, table->schema));
+      for(i = 0; i < numInserts; i += 41)
+        {
+          TEST_CHECK(getRecord(table, rids[i], r));
+          sprintf(b, "p%03i", i % 1000);
+          checkTestRecord(r, table->schema, i, b, i % 7);
+        }
+      TEST_CHECK(getRecord(table, rids[5], r));
+      checkTestRecord(r, table->schema, 5, "upd5", 99);
+      TEST_CHECK(getRecord(table, rids[6], r));
+      checkTestRecord(r, table->schema, 6, "p006", 6);
+      ASSERT_ERROR(getRecord(table, rids[capacity + 1], r), "deleted record is gone");
+
+      // the condition reads c only, the other minipages are gathered for matches
+      sel = attrCompare(2, OP_COMP_EQUAL, "i3");
+      TEST_CHECK(startScan(table, &sc, sel));
+      matches = 0;
+      bad = 0;
+      while(next(&sc, r) == RC_OK)
+        {
+          Value *a;
+          TEST_CHECK(getAttr(r, table->schema, 0, &a));
+          sprintf(b, "p%03i", a->v.intV % 1000);
+          bad += a->v.intV % 7 != 3;
+          bad += rids[a->v.intV].page != r->id.page || rids[a->v.intV].slot != r->id.slot;
+          checkTestRecord(r, table->schema, a->v.intV, b, 3);
+          freeVal(a);
+          matches++;
+        }
+      TEST_CHECK(closeScan(&sc));
+      freeExpr(sel);
+      ASSERT_EQUALS_INT(0, bad, "matching records are whole and under their RID");
+      ASSERT_EQUALS_INT((numInserts + 3) / 7 - ((capacity + 1) % 7 == 3), matches, "every record with c = 3");
+      freeRecord(r);
+
+      TEST_CHECK(closeTable(table));
+      TEST_CHECK(openTable(table, "test_pax_t"));
+    }
+
+  TEST_CHECK(closeTable(table));
+  TEST_CHECK(deleteTable("test_pax_t"));
+  TEST_CHECK(shutdownRecordManager());
+  freeSchema(schema);
+  free(table);
+  free(rids);
+
+  TEST_DONE();
+}
+
+// ************************************************************
+void
+testBatchScan (void)
+{
+  RM_TableData *table = (RM_TableData *) malloc(sizeof(RM_TableData));
+  Schema *schema = typesSchema();
+  // three full batches and a partial one
+  int numInserts = 3 * RM_BATCH_SIZE + 300;
+  int *expected = (int *) malloc(sizeof(int) * numInserts);
+  int *keys = (int *) malloc(sizeof(int) * numInserts);
+  RID *rids = (RID *) malloc(sizeof(RID) * numInserts);
+  Expr *conds[6], *left, *right;
+  RM_ScanHandle sc;
+  Record *r;
+  Value *value;
+  int numExpected, numKeys, c, i;
+
+  testName = "nextBatch and next mixed on one scan return the rows of a next-only scan";
+
+  TEST_CHECK(initRecordManager(NULL));
+  TEST_CHECK(createTable("test_batch_t", schema));
+  TEST_CHECK(openTable(table, "test_batch_t"));
+  for(i = 0; i < numInserts; i++)
+    {
+      r = typesRecord(table->schema, i);
+      TEST_CHECK(insertRecord(table, r));
+      rids[i] = r->id;
+      freeRecord(r);
+    }
+  // delete some rows so batches and pages do not line up
+  for(i = 0; i < 2 * RM_BATCH_SIZE; i += 13)
+    TEST_CHECK(deleteRecord(table, rids[i]));
+
+  // int range across the first batch boundary, float, bool, string, and a mix
+  conds[0] = attrCompare(0, OP_COMP_SMALLER, "i1500");
+  conds[1] = attrCompare(1, OP_COMP_SMALLER, "f1.5");
+  conds[2] = attrCompare(2, OP_COMP_EQUAL, "btrue");
+  conds[3] = attrCompare(3, OP_COMP_EQUAL, "sv2");
+  left = attrCompare(3, OP_COMP_EQUAL, "sv4");
+  MAKE_UNOP_EXPR(right, attrCompare(2, OP_COMP_EQUAL, "bfalse"), OP_BOOL_NOT);
+  MAKE_BINOP_EXPR(conds[4], left, right, OP_BOOL_AND);
+  MAKE_CONS(conds[5], stringToValue("btrue"));
+
+  TEST_CHECK(createRecord(&r, table->schema));
+  for(c = 0; c < 6; c++)
+    {
+      numExpected = 0;
+      TEST_CHECK(startScan(table, &sc, conds[c]));
+      while(next(&sc, r) == RC_OK)
+        {
+          TEST_CHECK(getAttr(r, table->schema, 0, &value));
+          expected[numExpected++] = value->v.intV;
+          freeVal(value);
+        }
+      TEST_CHECK(closeScan(&sc));
+      ASSERT_TRUE(numExpected > 0, "condition matches some rows");
+
+      numKeys = mixedScanKeys(table, conds[c], keys);
+      ASSERT_EQUALS_INT(numExpected, numKeys, "same number of rows");
+      ASSERT_TRUE(memcmp(expected, keys, sizeof(int) * numKeys) == 0, "same rows in the same order");
+      freeExpr(conds[c]);
+    }
+  freeRecord(r);
+
+  TEST_CHECK(closeTable(table));
+  TEST_CHECK(deleteTable("test_batch_t"));
+  TEST_CHECK(shutdownRecordManager());
+  freeSchema(schema);
+  free(table);
+  free(expected);
+  free(keys);
+  free(rids);
+
+  TEST_DONE();
+}
+
+// ************************************************************
+void
+testCompiledExpr (void)
+{
+  RM_TableData *table = (RM_TableData *) malloc(sizeof(RM_TableData));
+  Schema *schema = typesSchema();
+  int numRecords = 100;
+  Expr *conds[12], *deep, *nested, *left, *right;
+  ExprProgram *program;
+  RM_ScanHandle sc;
+  Record *r;
+  Value *value;
+  RC rc;
+  int numMatches, numScanned, c, i;
+  bool compiled;
+
+  testName = "compiled conditions agree with evalExpr, rejected ones fall back to it";
+
+  // comparisons of every type, string constants that are prefixes of values or longer than the
+  // attribute, and the boolean operators
+  conds[0] = attrCompare(0, OP_COMP_SMALLER, "i37");
+  conds[1] = attrCompare(0, OP_COMP_EQUAL, "i12");
+  conds[2] = attrCompare(1, OP_COMP_SMALLER, "f2.0");
+  conds[3] = attrCompare(2, OP_COMP_EQUAL, "btrue");
+  conds[4] = attrCompare(3, OP_COMP_EQUAL, "sv3");
+  conds[5] = attrCompare(3, OP_COMP_SMALLER, "sv2");
+  conds[6] = attrCompare(3, OP_COMP_SMALLER, "sv20");
+  conds[7] = attrCompare(3, OP_COMP_EQUAL, "sv3xxxxx");
+  MAKE_UNOP_EXPR(conds[8], attrCompare(0, OP_COMP_SMALLER, "i50"), OP_BOOL_NOT);
+  MAKE_BINOP_EXPR(conds[9], attrCompare(0, OP_COMP_SMALLER, "i50"), attrCompare(3, OP_COMP_EQUAL, "sv1"), OP_BOOL_AND);
+  MAKE_BINOP_EXPR(conds[10], attrCompare(2, OP_COMP_EQUAL, "btrue"), attrCompare(1, OP_COMP_SMALLER, "f1.0"), OP_BOOL_OR);
+  MAKE_ATTRREF(conds[11], 2);
+
+  for(c = 0; c < 12; c++)
+    {
+      TEST_CHECK(compileExpr(conds[c], schema, &program));
+      numMatches = 0;
+      for(i = 0; i < numRecords; i++)
+        {
+          r = typesRecord(schema, i);
+          TEST_CHECK(evalExpr(r, schema, conds[c], &value));
+          compiled = runExprProgram(program, r->data + 1);
+          ASSERT_TRUE(compiled == value->v.boolV, "program and evalExpr agree");
+          numMatches += compiled;
+          freeVal(value);
+          freeRecord(r);
+        }
+      // no record has a string longer than the attribute
+      ASSERT_TRUE(numMatches > 0 || c == 7, "condition matches some records");
+      freeExprProgram(program);
+    }
+
+  // too deep for the program's stack: a < 60 under EXPR_STACK_SIZE ANDs nested to the right
+  deep = attrCompare(0, OP_COMP_SMALLER, "i60");
+  for(i = 0; i < EXPR_STACK_SIZE; i++)
+    {
+      char constant[8];
+      sprintf(constant, "i%i", 61 + i);
+      left = attrCompare(0, OP_COMP_SMALLER, constant);
+      right = deep;
+      MAKE_BINOP_EXPR(deep, left, right, OP_BOOL_AND);
+    }
+  rc = compileExpr(deep, schema, &program);
+  ASSERT_TRUE(rc != RC_OK, "condition deeper than the stack is rejected");
+  // a comparison of a comparison: (a < 20) = true
+  right = attrCompare(0, OP_COMP_SMALLER, "i20");
+  MAKE_CONS(left, stringToValue("btrue"));
+  MAKE_BINOP_EXPR(nested, right, left, OP_COMP_EQUAL);
+  rc = compileExpr(nested, schema, &program);
+  ASSERT_TRUE(rc != RC_OK, "comparison of an operator is rejected");
+
+  // scans with the rejected conditions still match evalExpr
+  TEST_CHECK(initRecordManager(NULL));
+  TEST_CHECK(createTable("test_compiled_t", schema));
+  TEST_CHECK(openTable(table, "test_compiled_t"));
+  for(i = 0; i < numRecords; i++)
+    {
+      r = typesRecord(table->schema, i);
+      TEST_CHECK(insertRecord(table, r));
+      freeRecord(r);
+    }
+  TEST_CHECK(createRecord(&r, table->schema));
+  numScanned = 0;
+  TEST_CHECK(startScan(table, &sc, deep));
+  while(next(&sc, r) == RC_OK)
+    {
+      TEST_CHECK(getAttr(r, table->schema, 0, &value));
+      ASSERT_TRUE(value->v.intV < 60, "deep condition holds");
+      freeVal(value);
+      numScanned++;
+    }
+  TEST_CHECK(closeScan(&sc));
+  ASSERT_EQUALS_INT(60, numScanned, "deep condition returns every matching row");
+  numScanned = 0;
+  TEST_CHECK(startScan(table, &sc, nested));
+  while(next(&sc, r) == RC_OK)
+    {
+      TEST_CHECK(getAttr(r, table->schema, 0, &value));
+      ASSERT_TRUE(value->v.intV < 20, "nested comparison holds");
+      freeVal(value);
+      numScanned++;
+    }
+  TEST_CHECK(closeScan(&sc));
+  ASSERT_EQUALS_INT(20, numScanned, "nested comparison returns every matching row");
+  freeRecord(r);
+
+  TEST_CHECK(closeTable(table));
+  TEST_CHECK(deleteTable("test_compiled_t"));
+  TEST_CHECK(shutdownRecordManager());
+  for(c = 0; c < 12; c++)
+    freeExpr(conds[c]);
+  freeExpr(deep);
+  freeExpr(nested);
+  freeSchema(schema);
+  free(table);
+
+  TEST_DONE();
+}
+
+// ************************************************************
+void
+testZoneMapPruning (void)
+{
+  RM_TableData *table = (RM_TableData *) malloc(sizeof(RM_TableData));
+  Schema *schema = testSchema();
+  RecordManager *mgr;
+  // twice as many data pages as the table's buffer pool holds
+  int numInserts = 2 * PER_TBL_BUF_SIZE * 511;
+  int prunedCount, fullCount, prunedReads, fullReads, count, i;
+  long prunedSum, fullSum, sum;
+  Expr *range, *unpruned, *never;
+  Record *r;
+
+  testName = "zone maps skip pages of a time-ordered table and survive a lost sidecar";
+
+  TEST_CHECK(initRecordManager(NULL));
+  TEST_CHECK(createTable("test_zone_t", schema));
+  TEST_CHECK(openTable(table, "test_zone_t"));
+  for(i = 0; i < numInserts; i++)
+    {
+      r = testRecord(table->schema, i, "ts", i % 7);
+      TEST_CHECK(insertRecord(table, r));
+      freeRecord(r);
+    }
+  TEST_CHECK(closeTable(table));
+
+  // 3000 <= a < 4000 lies on three data pages; ORed with false the zone map can not use it
+  range = zoneRange(3000, 4000);
+  MAKE_CONS(never, stringToValue("bfalse"));
+  MAKE_BINOP_EXPR(unpruned, zoneRange(3000, 4000), never, OP_BOOL_OR);
+
+  TEST_CHECK(openTable(table, "test_zone_t"));
+  mgr = (RecordManager *) table->mgmtData;
+  prunedReads = getNumReadIO(&mgr->bufferPool);
+  prunedCount = scanWhere(table, range, &prunedSum);
+  prunedReads = getNumReadIO(&mgr->bufferPool) - prunedReads;
+  TEST_CHECK(closeTable(table));
+
+  TEST_CHECK(openTable(table, "test_zone_t"));
+  mgr = (RecordManager *) table->mgmtData;
+  fullReads = getNumReadIO(&mgr->bufferPool);
+  fullCount = scanWhere(table, unpruned, &fullSum);
+  fullReads = getNumReadIO(&mgr->bufferPool) - fullReads;
+  TEST_CHECK(closeTable(table));
+
+  ASSERT_EQUALS_INT(1000, fullCount, "unpruned scan returns the range");
+  ASSERT_EQUALS_INT(fullCount, prunedCount, "pruned scan returns as many rows");
+  ASSERT_TRUE(fullSum == prunedSum && fullSum == 3499500L, "pruned scan returns the same rows");
+  ASSERT_TRUE(fullReads >= numInserts / 511, "unpruned scan reads every data page");
+  ASSERT_TRUE(prunedReads <= 3, "pruned scan reads only the pages of the range");
+
+  // without its sidecar the zone map is rebuilt from the data pages
+  TEST_CHECK(destroyPageFile("test_zone_t" ZONEMAP_SUFFIX));
+  TEST_CHECK(openTable(table, "test_zone_t"));
+  count = scanWhere(table, range, &sum);
+  ASSERT_EQUALS_INT(fullCount, count, "rebuilt zone map returns as many rows");
+  ASSERT_TRUE(sum == fullSum, "rebuilt zone map returns the same rows");
+  TEST_CHECK(closeTable(table));
+
+  TEST_CHECK(deleteTable("test_zone_t"));
+  TEST_CHECK(shutdownRecordManager());
+  freeExpr(range);
+  freeExpr(unpruned);
+  freeSchema(schema);
+  free(table);
+
+  TEST_DONE();
+}
+
+// ************************************************************
+void
+testProjectedScan (void)
+{
+  RM_TableData *table = (RM_TableData *) malloc(sizeof(RM_TableData));
+  Schema *schema = typesSchema();
+  RM_PageLayout layouts[] = { RM_LAYOUT_ROW, RM_LAYOUT_PAX };
+  int attrNums[] = { 3, 0 };
+  int numInserts = 2000;
+  unsigned char *bytes;
+  Schema *projSchema;
+  RM_ScanHandle sc;
+  RM_Batch *batch;
+  Expr *sel;
+  Record *r;
+  Value *value;
+  char s[7];
+  int key, numRows, row, i, l;
+  bool untouched;
+
+  testName = "projected scans return the chosen attributes and fill only the needed vectors";
+
+  TEST_CHECK(initRecordManager(NULL));
+  for(l = 0; l < 2; l++)
+    {
+      TEST_CHECK(createTableWithLayout("test_proj_t", schema, layouts[l]));
+      TEST_CHECK(openTable(table, "test_proj_t"));
+      for(i = 0; i < numInserts; i++)
+        {
+          r = typesRecord(table->schema, i);
+          TEST_CHECK(insertRecord(table, r));
+          freeRecord(r);
+        }
+      // the condition is on f, which is not projected: keys ending in 0, 1 or 2
+      sel = attrCompare(1, OP_COMP_SMALLER, "f1.5");
+
+      // next() returns s then a, as listed
+      TEST_CHECK(startProjectedScan(table, &sc, sel, 2, attrNums));
+      projSchema = getScanSchema(&sc);
+      ASSERT_EQUALS_INT(2, projSchema->numAttr, "projected schema has two attributes");
+      ASSERT_EQUALS_STRING("s", projSchema->attrNames[0], "first attribute is s");
+      ASSERT_EQUALS_STRING("a", projSchema->attrNames[1], "second attribute is a");
+      ASSERT_TRUE(projSchema->dataTypes[0] == DT_STRING && projSchema->typeLength[0] == 6, "s keeps its type");
+      ASSERT_TRUE(projSchema->dataTypes[1] == DT_INT, "a keeps its type");
+      TEST_CHECK(createRecord(&r, projSchema));
+      numRows = 0;
+      for(key = 0; key < numInserts; key++)
+        {
+          if (key % 10 >= 3)
+            continue;
+          TEST_CHECK(next(&sc, r));
+          sprintf(s, "v%i", key % 5);
+          TEST_CHECK(getAttr(r, projSchema, 0, &value));
+          ASSERT_EQUALS_STRING(s, value->v.stringV, "projected s");
+          freeVal(value);
+          TEST_CHECK(getAttr(r, projSchema, 1, &value));
+          ASSERT_EQUALS_INT(key, value->v.intV, "projected a");
+          freeVal(value);
+          numRows++;
+        }
+      ASSERT_ERROR(next(&sc, r), "no more matching rows");
+      ASSERT_EQUALS_INT(numInserts / 10 * 3, numRows, "every matching row");
+      freeRecord(r);
+      TEST_CHECK(closeScan(&sc));
+
+      // nextBatch() fills the vectors of a, f and s, but leaves t alone
+      TEST_CHECK(createBatch(&batch, table->schema));
+      for(i = 0; i < table->schema->numAttr; i++)
+        memset(batch->columns[i].v.stringV, 0xA5, RM_BATCH_SIZE * batch->columns[i].width);
+      TEST_CHECK(startProjectedScan(table, &sc, sel, 2, attrNums));
+      numRows = 0;
+      while(nextBatch(&sc, batch) == RC_OK)
+        for(i = 0; i < batch->numSelected; i++)
+          {
+            row = batch->sel[i];
+            key = batch->columns[0].v.intV[row];
+            sprintf(s, "v%i", key % 5);
+            ASSERT_TRUE(key % 10 < 3 && batch->columns[1].v.floatV[row] < 1.5f, "batch row matches");
+            ASSERT_EQUALS_STRING(s, batch->columns[3].v.stringV + row * batch->columns[3].width, "batch s");
+            numRows++;
+          }
+      ASSERT_EQUALS_INT(numInserts / 10 * 3, numRows, "every matching row in batches");
+      bytes = (unsigned char *) batch->columns[2].v.boolV;
+      untouched = TRUE;
+      for(i = 0; i < RM_BATCH_SIZE * batch->columns[2].width; i++)
+        untouched = untouched && bytes[i] == 0xA5;
+      ASSERT_TRUE(untouched, "vector of t is not filled");
+      TEST_CHECK(closeScan(&sc));
+      TEST_CHECK(freeBatch(batch));
+      freeExpr(sel);
+
+      TEST_CHECK(closeTable(table));
+      TEST_CHECK(deleteTable("test_proj_t"));
+    }
+  TEST_CHECK(shutdownRecordManager());
+  freeSchema(schema);
+  free(table);
+
+  TEST_DONE();
+}
+
+// ************************************************************
+void
+testRecordRef (void)
+{
+  RM_TableData *table = (RM_TableData *) malloc(sizeof(RM_TableData));
+  Schema *schema = typesSchema();
+  RM_PageLayout layouts[] = { RM_LAYOUT_ROW, RM_LAYOUT_PAX };
+  int numInserts = 100;
+  RID rids[100];
+  RecordRef ref;
+  AttrRef attr;
+  Record *r;
+  Value *value;
+  int i, l;
+
+  testName = "record refs read records in place and keep their snapshot while the page is written";
+
+  TEST_CHECK(initRecordManager(NULL));
+  for(l = 0; l < 2; l++)
+    {
+      TEST_CHECK(createTableWithLayout("test_ref_t", schema, layouts[l]));
+      TEST_CHECK(openTable(table, "test_ref_t"));
+      for(i = 0; i < numInserts; i++)
+        {
+          r = typesRecord(table->schema, i);
+          TEST_CHECK(insertRecord(table, r));
+          rids[i] = r->id;
+          freeRecord(r);
+        }
+      ASSERT_TRUE(rids[7].page == rids[8].page, "records 7 and 8 share a page");
+
+      TEST_CHECK(getRecordRef(table, rids[7], &ref));
+      if (layouts[l] == RM_LAYOUT_PAX)
+        {
+          ASSERT_TRUE(ref.data == NULL, "PAX ref has no record bytes");
+        }
+      else
+        ASSERT_TRUE(ref.data != NULL, "row ref points at the record");
+
+      // rewrite record 7 and its neighbour while the ref is held
+      r = typesRecord(table->schema, 1008);
+      r->id = rids[7];
+      TEST_CHECK(updateRecord(table, r));
+      freeRecord(r);
+      r = typesRecord(table->schema, 1009);
+      r->id = rids[8];
+      TEST_CHECK(updateRecord(table, r));
+      freeRecord(r);
+
+      TEST_CHECK(getAttrRef(&ref, 0, &attr));
+      ASSERT_TRUE(attr.dt == DT_INT && attr.v.intV == 7, "ref keeps a");
+      TEST_CHECK(getAttrRef(&ref, 1, &attr));
+      ASSERT_TRUE(attr.dt == DT_FLOAT && attr.v.floatV == 3.5f, "ref keeps f");
+      TEST_CHECK(getAttrRef(&ref, 2, &attr));
+      ASSERT_TRUE(attr.dt == DT_BOOL && !attr.v.boolV, "ref keeps t");
+      TEST_CHECK(getAttrRef(&ref, 3, &attr));
+      ASSERT_TRUE(attr.dt == DT_STRING, "s is a string");
+      ASSERT_EQUALS_INT(6, attr.length, "string view has the attribute length");
+      ASSERT_TRUE(strncmp(attr.v.stringV, "v2", attr.length) == 0, "ref keeps s");
+      ASSERT_ERROR(getAttrRef(&ref, 4, &attr), "no attribute 4");
+      TEST_CHECK(releaseRecordRef(&ref));
+
+      // the updates are in the table
+      TEST_CHECK(createRecord(&r, table->schema));
+      TEST_CHECK(getRecord(table, rids[7], r));
+      TEST_CHECK(getAttr(r, table->schema, 0, &value));
+      ASSERT_EQUALS_INT(1008, value->v.intV, "record 7 is updated");
+      freeVal(value);
+      freeRecord(r);
+      TEST_CHECK(getRecordRef(table, rids[8], &ref));
+      TEST_CHECK(getAttrRef(&ref, 3, &attr));
+      ASSERT_TRUE(strncmp(attr.v.stringV, "v4", attr.length) == 0, "new ref sees the update");
+      TEST_CHECK(releaseRecordRef(&ref));
+
+      TEST_CHECK(deleteRecord(table, rids[9]));
+      ASSERT_ERROR(getRecordRef(table, rids[9], &ref), "no ref to a deleted record");
+
+      TEST_CHECK(closeTable(table));
+      TEST_CHECK(deleteTable("test_ref_t"));
+    }
+  TEST_CHECK(shutdownRecordManager());
+  freeSchema(schema);
+  free(table);
+
+  TEST_DONE();
+}
+
+// ************************************************************
+void
+testParallelScan (void)
+{
+  RM_TableData *table = (RM_TableData *) malloc(sizeof(RM_TableData));
+  Schema *schema = typesSchema();
+  RM_PageLayout layouts[] = { RM_LAYOUT_ROW, RM_LAYOUT_PAX };
+  int threads[] = { 1, 2, 8 };
+  // several morsels of pages for the workers to claim
+  int numInserts = 3 * RM_MORSEL_PAGES * 511;
+  RID *expected = (RID *) malloc(sizeof(RID) * numInserts);
+  RidCollector collector;
+  RM_ScanHandle sc;
+  RM_Batch *batch;
+  Expr *sel;
+  Record *r;
+  int numExpected, i, l, t;
+
+  testName = "parallel scans match the rows of nextBatch for any number of threads";
+
+  collector.rids = (RID *) malloc(sizeof(RID) * numInserts);
+  pthread_mutex_init(&collector.lock, NULL);
+  TEST_CHECK(initRecordManager(NULL));
+  for(l = 0; l < 2; l++)
+    {
+      TEST_CHECK(createTableWithLayout("test_parallel_t", schema, layouts[l]));
+      TEST_CHECK(openTable(table, "test_parallel_t"));
+      for(i = 0; i < numInserts; i++)
+        {
+          r = typesRecord(table->schema, i);
+          TEST_CHECK(insertRecord(table, r));
+          freeRecord(r);
+        }
+      // the key range lets the zone map skip the pages outside it
+      MAKE_BINOP_EXPR(sel, zoneRange(numInserts / 4, numInserts / 2), attrCompare(2, OP_COMP_EQUAL, "btrue"), OP_BOOL_AND);
+
+      numExpected = 0;
+      TEST_CHECK(createBatch(&batch, table->schema));
+      TEST_CHECK(startScan(table, &sc, sel));
+      while(nextBatch(&sc, batch) == RC_OK)
+        for(i = 0; i < batch->numSelected; i++)
+          expected[numExpected++] = batch->ids[batch->sel[i]];
+      TEST_CHECK(closeScan(&sc));
+      TEST_CHECK(freeBatch(batch));
+      ASSERT_TRUE(numExpected > 0, "condition matches some rows");
+      qsort(expected, numExpected, sizeof(RID), compareRids);
+
+      for(t = 0; t < 3; t++)
+        {
+          collector.numRids = 0;
+          collector.maxWorker = -1;
+          TEST_CHECK(parallelScan(table, sel, threads[t], collectRids, &collector));
+          ASSERT_EQUALS_INT(numExpected, collector.numRids, "same number of rows");
+          qsort(collector.rids, collector.numRids, sizeof(RID), compareRids);
+          ASSERT_TRUE(memcmp(expected, collector.rids, sizeof(RID) * numExpected) == 0, "same rows");
+          ASSERT_TRUE(collector.maxWorker < threads[t], "batches come from the requested workers");
+        }
+      freeExpr(sel);
+
+      TEST_CHECK(closeTable(table));
+      TEST_CHECK(deleteTable("test_parallel_t"));
+    }
+  TEST_CHECK(shutdownRecordManager());
+  pthread_mutex_destroy(&collector.lock);
+  freeSchema(schema);
+  free(collector.rids);
+  free(expected);
+  free(table);
+
+  TEST_DONE();
+}
+
+// ************************************************************
+void
+testRecordLayout (void)
+{
+  Schema *schema = typesSchema();
+  int offsets[] = { 0, sizeof(int), 2 * sizeof(int), 2 * sizeof(int) + sizeof(bool) };
+  Record *r;
+  Value *value;
+  float f;
+  int a, i;
+
+  testName = "attributes are read and written at their cached offsets";
+
+  ASSERT_EQUALS_INT(offsets[3] + 6, getRecordSize(schema), "record size");
+  for(i = 0; i < 4; i++)
+    ASSERT_EQUALS_INT(offsets[i], getAttrOffset(schema, i), "attribute offset");
+
+  // every attribute lands at its offset after the marker byte, whatever the order of the writes
+  TEST_CHECK(createRecord(&r, schema));
+  MAKE_STRING_VALUE(value, "xyz");
+  TEST_CHECK(setAttr(r, schema, 3, value));
+  freeVal(value);
+  MAKE_VALUE(value, DT_BOOL, TRUE);
+  TEST_CHECK(setAttr(r, schema, 2, value));
+  freeVal(value);
+  MAKE_VALUE(value, DT_FLOAT, 2.25f);
+  TEST_CHECK(setAttr(r, schema, 1, value));
+  freeVal(value);
+  MAKE_VALUE(value, DT_INT, -17);
+  TEST_CHECK(setAttr(r, schema, 0, value));
+  freeVal(value);
+
+  memcpy(&a, r->data + 1 + offsets[0], sizeof(int));
+  ASSERT_EQUALS_INT(-17, a, "a at offset 0");
+  memcpy(&f, r->data + 1 + offsets[1], sizeof(float));
+  ASSERT_TRUE(f == 2.25f, "f at its offset");
+  ASSERT_TRUE(r->data[1 + offsets[2]] == TRUE, "t at its offset");
+  ASSERT_TRUE(strcmp(r->data + 1 + offsets[3], "xyz") == 0, "s at its offset");
+
+  TEST_CHECK(getAttr(r, schema, 1, &value));
+  ASSERT_TRUE(value->dt == DT_FLOAT && value->v.floatV == 2.25f, "f round-trips");
+  freeVal(value);
+  ASSERT_TRUE(schema->dataTypes[1] == DT_FLOAT, "getAttr leaves the type of attribute 1 alone");
+  TEST_CHECK(getAttr(r, schema, 2, &value));
+  ASSERT_TRUE(value->dt == DT_BOOL && value->v.boolV, "t round-trips");
+  freeVal(value);
+  TEST_CHECK(getAttr(r, schema, 3, &value));
+  ASSERT_EQUALS_STRING("xyz", value->v.stringV, "s round-trips");
+  freeVal(value);
+  TEST_CHECK(getAttr(r, schema, 0, &value));
+  ASSERT_EQUALS_INT(-17, value->v.intV, "a round-trips");
+  freeVal(value);
+
+  // a string of the full attribute length does not run into the next record
+  MAKE_STRING_VALUE(value, "abcdef");
+  TEST_CHECK(setAttr(r, schema, 3, value));
+  freeVal(value);
+  TEST_CHECK(getAttr(r, schema, 3, &value));
+  ASSERT_EQUALS_STRING("abcdef", value->v.stringV, "full length string round-trips");
+  freeVal(value);
+  TEST_CHECK(getAttr(r, schema, 2, &value));
+  ASSERT_TRUE(value->v.boolV, "t is not overwritten by s");
+  freeVal(value);
+
+  freeRecord(r);
+  freeSchema(schema);
+
+  TEST_DONE();
+}
+
+// ************************************************************
+void
+testAttrCodecs (void)
+{
+  Schema *ints = intSchema();
+  Schema *types = typesSchema();
+  Schema *schema = testSchema();
+  Value values[4], read[4];
+  int expected[] = { 5, -6, 7 };
+  Record *r;
+  Value *value;
+  char *str;
+  int i;
+
+  testName = "codecs read and write whole records and serialize them";
+
+  // an all-int schema is copied as an int array
+  ASSERT_TRUE(ints->layout->allInts, "int schema takes the int array path");
+  ASSERT_TRUE(!types->layout->allInts, "mixed schema takes the codec path");
+  TEST_CHECK(createRecord(&r, ints));
+  for(i = 0; i < 3; i++)
+    {
+      values[i].dt = DT_INT;
+      values[i].v.intV = expected[i];
+    }
+  TEST_CHECK(setAttrs(r, ints, values));
+  ASSERT_TRUE(memcmp(r->data + 1, expected, sizeof(expected)) == 0, "attributes are the int array");
+  TEST_CHECK(getAttrs(r, ints, read));
+  for(i = 0; i < 3; i++)
+    {
+      ASSERT_TRUE(read[i].dt == DT_INT, "int attribute");
+      ASSERT_EQUALS_INT(expected[i], read[i].v.intV, "getAttrs round-trips");
+      TEST_CHECK(getAttr(r, ints, i, &value));
+      ASSERT_EQUALS_INT(expected[i], value->v.intV, "getAttr agrees");
+      freeVal(value);
+    }
+  freeRecord(r);
+
+  // a mixed schema through its codecs
+  TEST_CHECK(createRecord(&r, types));
+  values[0].dt = DT_INT;
+  values[0].v.intV = 42;
+  values[1].dt = DT_FLOAT;
+  values[1].v.floatV = 2.25f;
+  values[2].dt = DT_BOOL;
+  values[2].v.boolV = TRUE;
+  values[3].dt = DT_STRING;
+  values[3].v.stringV = "v7";
+  TEST_CHECK(setAttrs(r, types, values));
+  TEST_CHECK(getAttrs(r, types, read));
+  ASSERT_TRUE(read[0].dt == DT_INT && read[0].v.intV == 42, "int round-trips");
+  ASSERT_TRUE(read[1].dt == DT_FLOAT && read[1].v.floatV == 2.25f, "float round-trips");
+  ASSERT_TRUE(read[2].dt == DT_BOOL && read[2].v.boolV, "bool round-trips");
+  ASSERT_TRUE(read[3].dt == DT_STRING && strcmp(read[3].v.stringV, "v7") == 0, "string round-trips");
+  free(read[3].v.stringV);
+  r->id.page = 3;
+  r->id.slot = 9;
+  str = serializeRecord(r, types);
+  ASSERT_EQUALS_STRING("[3-9] (a:42f:2.250000,t:TRUE,s:v7,)", str, "serialized mixed record");
+  free(str);
+  freeRecord(r);
+
+  // the serializer reads past the marker byte
+  r = testRecord(schema, 1, "aaaa", 3);
+  r->id.page = 2;
+  r->id.slot = 5;
+  str = serializeRecord(r, schema);
+  ASSERT_EQUALS_STRING("[2-5] (a:1b:aaaa,c:3,)", str, "serialized record");
+  free(str);
+  freeRecord(r);
+
+  freeSchema(ints);
+  freeSchema(types);
+  freeSchema(schema);
+
+  TEST_DONE();
+}
+
+// ************************************************************
+void
+testDictionaryEncoding (void)
+{
+  RM_TableData *table = (RM_TableData *) malloc(sizeof(RM_TableData));
+  Schema *schema = typesSchema();
+  // more distinct strings than a dictionary page of 6 byte entries holds
+  int numDistinct = (PAGE_SIZE - DICT_PAGE_HEADER) / 6 + 100;
+  int numInserts = 2 * numDistinct;
+  RID *rids = (RID *) malloc(sizeof(RID) * (numInserts + 1));
+  Expr *present, *absent, *compare, *nested;
+  ExprProgram *program;
+  Record *r;
+  Value *value;
+  char s[7];
+  long sum, nestedSum;
+  int count, nestedCount, i;
+  RC rc;
+
+  testName = "dictionary encoded strings round-trip, grow past a page and compare by code";
+
+  TEST_CHECK(setDictionaryEncoding(schema, 3, 2));
+  TEST_CHECK(initRecordManager(NULL));
+  TEST_CHECK(createTable("test_dict_t", schema));
+  TEST_CHECK(openTable(table, "test_dict_t"));
+  ASSERT_EQUALS_INT(2 * sizeof(int) + sizeof(bool) + 2, getRecordSize(table->schema), "s is stored as a 2 byte code");
+  for(i = 0; i < numInserts; i++)
+    {
+      r = dictRecord(table->schema, i, i % numDistinct);
+      TEST_CHECK(insertRecord(table, r));
+      rids[i] = r->id;
+      freeRecord(r);
+    }
+  checkDictRecords(table, rids, numInserts, numDistinct);
+
+  // the dictionary is read back from its sidecar
+  TEST_CHECK(closeTable(table));
+  TEST_CHECK(shutdownRecordManager());
+  TEST_CHECK(initRecordManager(NULL));
+  TEST_CHECK(openTable(table, "test_dict_t"));
+  checkDictRecords(table, rids, numInserts, numDistinct);
+
+  // equality with a constant in the dictionary compares codes
+  present = attrCompare(3, OP_COMP_EQUAL, "s00042");
+  TEST_CHECK(compileExpr(present, table->schema, &program));
+  ASSERT_TRUE(program->numInstrs == 1 && program->instrs[0].opcode == PROG_EQUAL_CODE, "equality compiles to a code comparison");
+  freeExprProgram(program);
+  // comparing the comparison with true is left to evalExpr
+  MAKE_CONS(compare, stringToValue("btrue"));
+  MAKE_BINOP_EXPR(nested, attrCompare(3, OP_COMP_EQUAL, "s00042"), compare, OP_COMP_EQUAL);
+  count = scanWhere(table, present, &sum);
+  nestedCount = scanWhere(table, nested, &nestedSum);
+  ASSERT_EQUALS_INT(2, count, "code comparison finds both rows");
+  ASSERT_EQUALS_INT(nestedCount, count, "evalExpr finds as many rows");
+  ASSERT_TRUE(sum == nestedSum && sum == 42 + 42 + numDistinct, "evalExpr finds the same rows");
+  freeExpr(nested);
+
+  // a constant the dictionary does not have is not compiled, and matches once it is inserted
+  absent = attrCompare(3, OP_COMP_EQUAL, "szzzzz");
+  rc = compileExpr(absent, table->schema, &program);
+  ASSERT_TRUE(rc != RC_OK, "constant outside the dictionary is not compiled");
+  MAKE_CONS(compare, stringToValue("btrue"));
+  MAKE_BINOP_EXPR(nested, attrCompare(3, OP_COMP_EQUAL, "szzzzz"), compare, OP_COMP_EQUAL);
+  count = scanWhere(table, absent, &sum);
+  nestedCount = scanWhere(table, nested, &nestedSum);
+  ASSERT_TRUE(count == 0 && nestedCount == 0, "no row has the constant");
+  TEST_CHECK(createRecord(&r, table->schema));
+  MAKE_VALUE(value, DT_INT, numInserts);
+  TEST_CHECK(setAttr(r, table->schema, 0, value));
+  freeVal(value);
+  MAKE_STRING_VALUE(value, "zzzzz");
+  TEST_CHECK(setAttr(r, table->schema, 3, value));
+  freeVal(value);
+  TEST_CHECK(insertRecord(table, r));
+  freeRecord(r);
+  count = scanWhere(table, absent, &sum);
+  nestedCount = scanWhere(table, nested, &nestedSum);
+  ASSERT_TRUE(count == 1 && sum == numInserts, "code comparison finds the new row");
+  ASSERT_TRUE(nestedCount == 1 && nestedSum == numInserts, "evalExpr finds the new row");
+  freeExpr(present);
+  freeExpr(absent);
+  freeExpr(nested);
+  TEST_CHECK(closeTable(table));
+  TEST_CHECK(deleteTable("test_dict_t"));
+
+  // one byte codes run out after 256 distinct values
+  TEST_CHECK(setDictionaryEncoding(schema, 3, 1));
+  TEST_CHECK(createTable("test_dict_t", schema));
+  TEST_CHECK(openTable(table, "test_dict_t"));
+  TEST_CHECK(createRecord(&r, table->schema));
+  for(i = 0; i < 256; i++)
+    {
+      sprintf(s, "%05i", i);
+      MAKE_STRING_VALUE(value, s);
+      TEST_CHECK(setAttr(r, table->schema, 3, value));
+      freeVal(value);
+      TEST_CHECK(insertRecord(table, r));
+    }
+  MAKE_STRING_VALUE(value, "00256");
+  rc = setAttr(r, table->schema, 3, value);
+  freeVal(value);
+  ASSERT_EQUALS_INT(RC_RM_LIMIT_EXCEEDED, rc, "257th distinct value has no code");
+  MAKE_STRING_VALUE(value, "00255");
+  TEST_CHECK(setAttr(r, table->schema, 3, value));
+  freeVal(value);
+  freeRecord(r);
+  TEST_CHECK(closeTable(table));
+  TEST_CHECK(deleteTable("test_dict_t"));
+
+  TEST_CHECK(shutdownRecordManager());
+  freeSchema(schema);
+  free(rids);
+  free(table);
+
+  TEST_DONE();
+}
+
+// ************************************************************
+bool
+sameBits (uint64_t *bits, bool *expected, int n)
+{
+  int i;
+
+  for(i = 0; i < (n + 63) / 64 * 64; i++)
+    {
+      bool bit = (bits[i / 64] >> (i % 64)) & 1;
+      if (bit != (i < n && expected[i]))
+        return FALSE;
+    }
+  return TRUE;
+}
+
+// ************************************************************
+int *
+shuffledInts (int size)
+{
+  int *result = (int *) malloc(size * sizeof(int));
+  int i;
+
+  for(i = 0; i < size; i++)
+    result[i] = i;
+  for(i = size - 1; i > 0; i--)
+    {
+      int j = rand() % (i + 1);
+      int temp = result[i];
+      result[i] = result[j];
+      result[j] = temp;
+    }
+  return result;
+}
+
+// ************************************************************
+RID
+keyRid (int key)
+{
+  RID rid;
+
+  rid.page = key / 10 + 1;
+  rid.slot = key % 10;
+  return rid;
+}
+
+// ************************************************************
+Schema *
+testSchema (void)
+{
+  char *names[] = { "a", "b", "c" };
+  DataType dt[] = { DT_INT, DT_STRING, DT_INT };
+  int sizes[] = { 0, 4, 0 };
+  char **cpNames = (char **) malloc(sizeof(char*) * 3);
+  DataType *cpDt = (DataType *) malloc(sizeof(DataType) * 3);
+  int *cpSizes = (int *) malloc(sizeof(int) * 3);
+  int *cpKeys = (int *) malloc(sizeof(int));
+  int i;
+
+  for(i = 0; i < 3; i++)
+    {
+      cpNames[i] = (char *) malloc(2);
+      strcpy(cpNames[i], names[i]);
+    }
+  memcpy(cpDt, dt, sizeof(DataType) * 3);
+  memcpy(cpSizes, sizes, sizeof(int) * 3);
+  cpKeys[0] = 0;
+
+  return createSchema(3, cpNames, cpDt, cpSizes, 1, cpKeys);
+}
+
+// ************************************************************
+Record *
+testRecord (Schema *schema, int a, char *b, int c)
+{
+  Record *result;
+  Value *value;
+
+  TEST_CHECK(createRecord(&result, schema));
+
+  MAKE_VALUE(value, DT_INT, a);
+  TEST_CHECK(setAttr(result, schema, 0, value));
+  freeVal(value);
+
+  MAKE_STRING_VALUE(value, b);
+  TEST_CHECK(setAttr(result, schema, 1, value));
+  freeVal(value);
+
+  MAKE_VALUE(value, DT_INT, c);
+  TEST_CHECK(setAttr(result, schema, 2, value));
+  freeVal(value);
+
+  return result;
+}
+
+// ************************************************************
+// key record i of testIndexMaintenance has in the index, -1 once it is deleted
+int
+indexKeyOf (int i, int *keys)
+{
+  if (i % 3 == 0)
+    return -1;
+  return (i % 3 == 1) ? keys[i] + 1001 : keys[i];
+}
+
+// ************************************************************
+// kind 0 is a page of zeros, 1 repeated records, 2 random bytes
+void
+fillPage (char *page, int kind)
+{
+  char record[17];
+  int i;
+
+  memset(page, 0, PAGE_SIZE);
+  for(i = 0; kind == 1 && i + 16 <= PAGE_SIZE; i += 16)
+    {
+      sprintf(record, "rec-%04i-abcdef|", i % 97);
+      memcpy(page + i, record, 16);
+    }
+  for(i = 0; kind == 2 && i < PAGE_SIZE; i++)
+    page[i] = (char) rand();
+}
+
+// ************************************************************
+// number of records of a table and the sum of their first attribute
+int
+scanTable (RM_TableData *table, long *sum)
+{
+  Expr *sel;
+  int count;
+
+  MAKE_CONS(sel, stringToValue("btrue"));
+  count = scanWhere(table, sel, sum);
+  freeExpr(sel);
+  return count;
+}
+
+// ************************************************************
+// number of records of a table matching sel and the sum of their first attribute
+int
+scanWhere (RM_TableData *table, Expr *sel, long *sum)
+{
+  RM_ScanHandle sc;
+  Record *r;
+  Value *value;
+  int count = 0;
+
+  TEST_CHECK(createRecord(&r, table->schema));
+  TEST_CHECK(startScan(table, &sc, sel));
+  *sum = 0;
+  while(next(&sc, r) == RC_OK)
+    {
+      TEST_CHECK(getAttr(r, table->schema, 0, &value));
+      *sum += value->v.intV;
+      freeVal(value);
+      count++;
+    }
+  TEST_CHECK(closeScan(&sc));
+  freeRecord(r);
+  return count;
+}
+
+// ************************************************************
+long
+fileSize (char *fileName)
+{
+  struct stat info;
+
+  return stat(fileName, &info) == 0 ? (long) info.st_size : -1;
+}
+
+// ************************************************************
+// pins and unpins a page, so it is in the pool but not pinned
+void
+touchPage (BM_BufferPool *bm, PageNumber pageNum)
+{
+  BM_PageHandle h;
+
+  TEST_CHECK(pinPage(bm, &h, pageNum));
+  TEST_CHECK(unpinPage(bm, &h));
+}
+
+// ************************************************************
+bool
+sameFrames (BM_BufferPool *bm, PageNumber *expected)
+{
+  PageNumber *frames = getFrameContents(bm);
+  bool same = TRUE;
+  int i;
+
+  for(i = 0; i < bm->numPages; i++)
+    same = same && frames[i] == expected[i];
+  free(frames);
+  return same;
+}
+
+// ************************************************************
+// hooks of the RS_CUSTOM policy of testCustomPolicy
+void
+countingOnHit (BM_BufferPool *const bm, int frame)
+{
+  ((CountingPolicy *) bm->policy->data)->hits++;
+}
+
+void
+countingOnLoad (BM_BufferPool *const bm, int frame)
+{
+  ((CountingPolicy *) bm->policy->data)->loads++;
+}
+
+int
+fixedVictim (BM_BufferPool *const bm)
+{
+  return ((CountingPolicy *) bm->policy->data)->victim;
+}
+
+void
+countingOnEvict (BM_BufferPool *const bm, int frame)
+{
+  ((CountingPolicy *) bm->policy->data)->evictions++;
+}
+
+void
+countingOnUnpin (BM_BufferPool *const bm, int frame)
+{
+  ((CountingPolicy *) bm->policy->data)->unpins++;
+}
+
+// ************************************************************
+int
+compareRids (const void *a, const void *b)
+{
+  const RID *l = (const RID *) a;
+  const RID *r = (const RID *) b;
+
+  return l->page != r->page ? l->page - r->page : l->slot - r->slot;
+}
+
+// ************************************************************
+// condition attr <op> constant, the constant in stringToValue format
+Expr *
+attrCompare (int attrNum, OpType op, char *constant)
+{
+  Expr *left, *right, *result;
+
+  MAKE_ATTRREF(left, attrNum);
+  MAKE_CONS(right, stringToValue(constant));
+  MAKE_BINOP_EXPR(result, left, right, op);
+  return result;
+}
+
+// ************************************************************
+// asserts the attributes of a record of testSchema
+void
+checkTestRecord (Record *r, Schema *schema, int a, char *b, int c)
+{
+  Value *value;
+
+  TEST_CHECK(getAttr(r, schema, 0, &value));
+  ASSERT_EQUALS_INT(a, value->v.intV, "attribute a");
+  freeVal(value);
+  TEST_CHECK(getAttr(r, schema, 1, &value));
+  ASSERT_EQUALS_STRING(b, value->v.stringV, "attribute b");
+  freeVal(value);
+  TEST_CHECK(getAttr(r, schema, 2, &value));
+  ASSERT_EQUALS_INT(c, value->v.intV, "attribute c");
+  freeVal(value);
+}
+
+// ************************************************************
+Schema *
+typesSchema (void)
+{
+  char *names[] = { "a", "f", "t", "s" };
+  DataType dt[] = { DT_INT, DT_FLOAT, DT_BOOL, DT_STRING };
+  int sizes[] = { 0, 0, 0, 6 };
+  char **cpNames = (char **) malloc(sizeof(char*) * 4);
+  DataType *cpDt = (DataType *) malloc(sizeof(DataType) * 4);
+  int *cpSizes = (int *) malloc(sizeof(int) * 4);
+  int *cpKeys = (int *) malloc(sizeof(int));
+  int i;
+
+  for(i = 0; i < 4; i++)
+    {
+      cpNames[i] = (char *) malloc(2);
+      strcpy(cpNames[i], names[i]);
+    }
+  memcpy(cpDt, dt, sizeof(DataType) * 4);
+  memcpy(cpSizes, sizes, sizeof(int) * 4);
+  cpKeys[0] = 0;
+
+  return createSchema(4, cpNames, cpDt, cpSizes, 1, cpKeys);
+}
+
+// ************************************************************
+// record of typesSchema with every value derived from the key
+Record *
+typesRecord (Schema *schema, int key)
+{
+  Record *result;
+  Value *value;
+  char s[7];
+
+  TEST_CHECK(createRecord(&result, schema));
+
+  MAKE_VALUE(value, DT_INT, key);
+  TEST_CHECK(setAttr(result, schema, 0, value));
+  freeVal(value);
+
+  MAKE_VALUE(value, DT_FLOAT, (key % 10) * 0.5f);
+  TEST_CHECK(setAttr(result, schema, 1, value));
+  freeVal(value);
+
+  MAKE_VALUE(value, DT_BOOL, key % 3 == 0);
+  TEST_CHECK(setAttr(result, schema, 2, value));
+  freeVal(value);
+
+  sprintf(s, "v%i", key % 5);
+  MAKE_STRING_VALUE(value, s);
+  TEST_CHECK(setAttr(result, schema, 3, value));
+  freeVal(value);
+
+  return result;
+}
+
+// ************************************************************
+// keys of the rows a scan returns when next and nextBatch take turns;
+// checks every selected row of a batch against its key
+int
+mixedScanKeys (RM_TableData *table, Expr *sel, int *keys)
+{
+  RM_ScanHandle sc;
+  RM_Batch *batch;
+  Record *r;
+  Value *value;
+  char s[7];
+  int numKeys = 0, bad = 0, round = 0;
+  int i;
+
+  TEST_CHECK(createRecord(&r, table->schema));
+  TEST_CHECK(createBatch(&batch, table->schema));
+  TEST_CHECK(startScan(table, &sc, sel));
+  for(;;)
+    {
+      // a few rows one by one, then a batch
+      for(i = 0; i < round % 4; i++)
+        {
+          if (next(&sc, r) != RC_OK)
+            break;
+          TEST_CHECK(getAttr(r, table->schema, 0, &value));
+          keys[numKeys++] = value->v.intV;
+          freeVal(value);
+        }
+      if (i < round % 4 || nextBatch(&sc, batch) != RC_OK)
+        break;
+      bad += batch->numSelected < 1 || batch->numSelected > batch->numRows || batch->numRows > RM_BATCH_SIZE;
+      for(i = 0; i < batch->numSelected; i++)
+        {
+          int row = batch->sel[i];
+          int key = batch->columns[0].v.intV[row];
+
+          bad += i > 0 && row <= batch->sel[i - 1];
+          bad += batch->columns[1].v.floatV[row] != (key % 10) * 0.5f;
+          bad += batch->columns[2].v.boolV[row] != (key % 3 == 0);
+          sprintf(s, "v%i", key % 5);
+          bad += strcmp(batch->columns[3].v.stringV + row * batch->columns[3].width, s) != 0;
+          keys[numKeys++] = key;
+        }
+      round++;
+    }
+  ASSERT_EQUALS_INT(0, bad, "selection vector and column vectors agree with the rows");
+  ASSERT_TRUE(round > 1, "more than one batch");
+  TEST_CHECK(closeScan(&sc));
+  TEST_CHECK(freeBatch(batch));
+  freeRecord(r);
+  return numKeys;
+}
+
+// ************************************************************
+// condition low <= a < high on attribute 0, as NOT(a < low) AND a < high
+Expr *
+zoneRange (int low, int high)
+{
+  Expr *left, *right, *result;
+  char constant[16];
+
+  sprintf(constant, "i%i", low);
+  MAKE_UNOP_EXPR(left, attrCompare(0, OP_COMP_SMALLER, constant), OP_BOOL_NOT);
+  sprintf(constant, "i%i", high);
+  right = attrCompare(0, OP_COMP_SMALLER, constant);
+  MAKE_BINOP_EXPR(result, left, right, OP_BOOL_AND);
+  return result;
+}
+
+// ************************************************************
+// consumer of parallelScan appending the RIDs of the selected rows to a RidCollector
+void
+collectRids (RM_Batch *batch, int worker, void *ctx)
+{
+  RidCollector *collector = (RidCollector *) ctx;
+  int i;
+
+  pthread_mutex_lock(&collector->lock);
+  for(i = 0; i < batch->numSelected; i++)
+    collector->rids[collector->numRids++] = batch->ids[batch->sel[i]];
+  if (worker > collector->maxWorker)
+    collector->maxWorker = worker;
+  pthread_mutex_unlock(&collector->lock);
+}
+
+// ************************************************************
+// schema of three DT_INT attributes a, b and c
+Schema *
+intSchema (void)
+{
+  char **cpNames = (char **) malloc(sizeof(char*) * 3);
+  DataType *cpDt = (DataType *) malloc(sizeof(DataType) * 3);
+  int *cpSizes = (int *) calloc(3, sizeof(int));
+  int *cpKeys = (int *) malloc(sizeof(int));
+  int i;
+
+  for(i = 0; i < 3; i++)
+    {
+      cpNames[i] = (char *) malloc(2);
+      cpNames[i][0] = 'a' + i;
+      cpNames[i][1] = '\0';
+      cpDt[i] = DT_INT;
+    }
+  cpKeys[0] = 0;
+
+  return createSchema(3, cpNames, cpDt, cpSizes, 1, cpKeys);
+}
+
+// ************************************************************
+// record of typesSchema with a set to key and s to string printed as five digits
+Record *
+dictRecord (Schema *schema, int key, int string)
+{
+  Record *result;
+  Value *value;
+  char s[7];
+
+  TEST_CHECK(createRecord(&result, schema));
+
+  MAKE_VALUE(value, DT_INT, key);
+  TEST_CHECK(setAttr(result, schema, 0, value));
+  freeVal(value);
+
+  sprintf(s, "%05i", string);
+  MAKE_STRING_VALUE(value, s);
+  TEST_CHECK(setAttr(result, schema, 3, value));
+  freeVal(value);
+
+  return result;
+}
+
+// ************************************************************
+// asserts that every record of dictRecord reads back with its key and string
+void
+checkDictRecords (RM_TableData *table, RID *rids, int numRecords, int numDistinct)
+{
+  Record *r;
+  Value *value;
+  char s[7];
+  int i;
+
+  TEST_CHECK(createRecord(&r, table->schema));
+  for(i = 0; i < numRecords; i++)
+    {
+      TEST_CHECK(getRecord(table, rids[i], r));
+      TEST_CHECK(getAttr(r, table->schema, 0, &value));
+      ASSERT_EQUALS_INT(i, value->v.intV, "key round-trips");
+      freeVal(value);
+      sprintf(s, "%05i", i % numDistinct);
+      TEST_CHECK(getAttr(r, table->schema, 3, &value));
+      ASSERT_EQUALS_STRING(s, value->v.stringV, "encoded string round-trips");
+      freeVal(value);
+    }
+  freeRecord(r);
+}